@@ -4,6 +4,15 @@
  * @details Thư viện các hàm để điều khiển cảm biến siêu âm HCSR05,
  *          bao gồm việc khởi tạo, kích hoạt cảm biến,
  *          tính toán khoảng cách và trả về hoặc hiển thị kết quả trên LCD.
+ *          Hỗ trợ nhiều cảm biến (HCSR05_MAX_SENSORS), mỗi cảm biến là 1 đối tượng gồm
+ *          1 kênh Input Capture đo xung Echo và 1 kênh PWM của TIM_HCSR05 phát xung Trigger 10 us.
+ *          Các cảm biến dùng chung kênh Trigger tạo thành 1 nhóm và được kích cùng lúc
+ *          (chỉ nên ghép các cảm biến quay về các hướng không nghe thấy nhau, ví dụ trước - sau);
+ *          các nhóm được kích lần lượt, mỗi chu kỳ của TIM_HCSR05 một nhóm, để tránh nhiễu chéo.
+ *          Khi mọi cảm biến trong nhóm đã nhận Echo, chu kỳ được rút ngắn còn HCSR05_GUARD_US
+ *          để chuyển sang nhóm tiếp theo sớm, tăng tổng tần số cập nhật khi vật cản ở gần.
+ *          Chương trình đọc mẫu mới nhất, mảng khoảng cách của mọi cảm biến,
+ *          hoặc đăng ký callback nhận mẫu mới mà không bao giờ bị chặn.
  * @version 2.0
  * @date    2024-11-25
  * @author  LongTruong
@@ -19,25 +28,112 @@
 
 /* ==========================================[ MACRO DEFINITIONS ]==========================================*/
 #define	TIM_HCSR05			TIM2                //**< Timer sử dụng cho cảm biến HCSR05         >**/
-#define	TIM_HCSR05_CHANNEL	TIM_CHANNEL_1       //**< Kênh sử dụng cho cảm biến HCSR05          >**/
-#define TIM_HANDLE_HCSR05	htim2               //**< Handle Timer sử dụng cho cảm biến HCSR05  >**/
+#define TIM_HANDLE_HCSR05	htim2               //**< Timer lập lịch, chứa các kênh PWM Trigger  >**/
+#define TIM_HANDLE_HCSR05_ECHO	htim4           //**< Timer Input Capture của các cảm biến phụ  >**/
 #define TIM_HANDLE_COUNTER 	htim12              //**< Handle Timer sử dụng cho cảm biến HCSR05  >**/
 
+#define HCSR05_FRONT_ECHO_CHANNEL   TIM_CHANNEL_1   //**< Trước: Echo TIM2_CH1                  >**/
+#define HCSR05_FRONT_TRIG_CHANNEL   TIM_CHANNEL_2   //**< Trước: Trigger TIM2_CH2 (nhóm 0)      >**/
+#define HCSR05_REAR_ECHO_CHANNEL    TIM_CHANNEL_1   //**< Sau: Echo TIM4_CH1                    >**/
+#define HCSR05_REAR_TRIG_CHANNEL    TIM_CHANNEL_2   //**< Sau: chung Trigger với cảm biến trước >**/
+#define HCSR05_LEFT_ECHO_CHANNEL    TIM_CHANNEL_2   //**< Trái: Echo TIM4_CH2                   >**/
+#define HCSR05_LEFT_TRIG_CHANNEL    TIM_CHANNEL_3   //**< Trái: Trigger TIM2_CH3 (nhóm 1)       >**/
+#define HCSR05_RIGHT_ECHO_CHANNEL   TIM_CHANNEL_3   //**< Phải: Echo TIM4_CH3                   >**/
+#define HCSR05_RIGHT_TRIG_CHANNEL   TIM_CHANNEL_3   //**< Phải: chung Trigger với cảm biến trái >**/
+
+#define HCSR05_TRIG_PULSE_US    10              //**< Độ rộng xung Trigger (us)                 >**/
+#define HCSR05_RATE_HZ          15              //**< Tần số kích nhóm mặc định (Hz)            >**/
+#define HCSR05_MIN_PERIOD_US    60000           //**< Chu kỳ đo tối thiểu theo datasheet (us)   >**/
+#define HCSR05_GUARD_US         10000           //**< Chờ dư âm sau Echo cuối của nhóm (us)     >**/
+#define HCSR05_MAX_SENSORS      4               //**< Số cảm biến tối đa                        >**/
+#define HCSR05_MAX_SLOTS        4               //**< Số nhóm Trigger tối đa (kênh của TIM2)    >**/
+#define HCSR05_MAX_SUBSCRIBERS  4               //**< Số callback nhận mẫu tối đa               >**/
+
+#define HCSR05_ECHO_QUEUE       8               //**< Số xung Echo thô chờ xử lý (lũy thừa 2)   >**/
+#define HCSR05_MIN_ECHO_US      116             //**< Echo ngắn nhất hợp lệ (~2 cm)             >**/
+#define HCSR05_MAX_ECHO_US      23300           //**< Echo dài nhất hợp lệ (~4 m)               >**/
+#define HCSR05_MAX_RANGE_MM     4000            //**< Khoảng cách báo khi không có vật cản (mm) >**/
+#define HCSR05_MEDIAN_N         5               //**< Số mẫu của bộ lọc trung vị                >**/
+#define HCSR05_EMA_SHIFT        2               //**< Hệ số EMA = 1 / 2^HCSR05_EMA_SHIFT        >**/
+#define HCSR05_INVALID_LIMIT    3               //**< Số Echo lỗi liên tiếp thì coi là ngoài tầm >**/
+
+/**
+ * @brief   Quy đổi độ rộng Echo (us) sang mm: v = 343 m/s, quãng đường đi và về
+ **/
+#define HCSR05_US_TO_MM(us)     ((uint32_t)(us) * 343U / 2000U)
+
 /* ===========================================[ TYPE DEFINITIONS ]==========================================*/
 extern TIM_HandleTypeDef TIM_HANDLE_HCSR05;     //**< Handle Timer sử dụng cho cảm biến HCSR05  >**/
+extern TIM_HandleTypeDef TIM_HANDLE_HCSR05_ECHO;    //**< Handle Timer Echo của các cảm biến phụ >**/
 extern TIM_HandleTypeDef TIM_HANDLE_COUNTER;    //**< Handle Timer sử dụng cho cảm biến HCSR05  >**/
 
-volatile uint32_t   rising_edge = 0;            //**< Thời gian rising edge         >**/
-volatile uint32_t   falling_edge = 0;           //**< Thời gian falling edge        >**/
-volatile uint32_t   pulse_width = 0;            //**< Thời gian xung                >**/
-volatile uint32_t   distance_measure = 0;       //**< Khoảng cách đo được           >**/
-volatile uint8_t    capture_flag = 0;           //**< Cờ để xác định trạng thái đo  >**/
+/**
+ * @brief   Một xung Echo thô do ngắt ghi lại
+ **/
+typedef struct {
+    uint32_t pulseUs;                           //**< Độ rộng xung Echo (us), 0: mất Echo   >**/
+    uint32_t timestampUs;                       //**< Thời điểm kết thúc xung Echo (us)     >**/
+    uint8_t  sensor;                            //**< Chỉ số cảm biến                       >**/
+} HCSR05_Echo;
+
+/**
+ * @brief   Một mẫu đo khoảng cách đã lọc
+ **/
+typedef struct {
+    uint32_t pulseUs;                           //**< Độ rộng xung Echo gần nhất (us)       >**/
+    uint16_t rawMm;                             //**< Khoảng cách chưa lọc (mm)             >**/
+    uint16_t distanceMm;                        //**< Khoảng cách sau trung vị + EMA (mm)   >**/
+    uint8_t  valid;                             //**< 1: có vật cản trong tầm, 0: ngoài tầm >**/
+    uint32_t timestampUs;                       //**< Thời điểm kết thúc xung Echo (us)     >**/
+    uint32_t sequence;                          //**< Số thứ tự mẫu (0: chưa có mẫu)        >**/
+    uint8_t  sensor;                            //**< Chỉ số cảm biến (thứ tự khởi tạo)     >**/
+} HCSR05_Sample;
+
+/**
+ * @brief   Trạng thái bộ lọc trung vị + EMA và bộ đếm chất lượng
+ **/
+typedef struct {
+    uint16_t window[HCSR05_MEDIAN_N];           //**< Các mẫu hợp lệ gần nhất (mm)          >**/
+    uint8_t  windowCount;                       //**< Số mẫu trong cửa sổ                   >**/
+    uint8_t  windowIndex;                       //**< Vị trí ghi tiếp theo                  >**/
+    int32_t  emaScaled;                         //**< Giá trị EMA x 16 (mm)                 >**/
+    uint8_t  invalidRun;                        //**< Số Echo lỗi liên tiếp                 >**/
+    uint32_t validCount;                        //**< Số Echo hợp lệ                        >**/
+    uint32_t missingCount;                      //**< Số lần mất Echo                       >**/
+    uint32_t rangeCount;                        //**< Số Echo ngoài [MIN, MAX]_ECHO_US      >**/
+    uint32_t overruns;                          //**< Số Echo bị mất do hàng đợi đầy        >**/
+} HCSR05_Filter;
+
+/**
+ * @brief   Đối tượng 1 cảm biến HCSR05 (cấp phát tĩnh bởi chương trình)
+ **/
+typedef struct {
+    TIM_HandleTypeDef  *echoTim;                //**< Timer Input Capture của chân Echo (tick 1 us) >**/
+    uint32_t            echoChannel;            //**< Kênh Input Capture (TIM_CHANNEL_x)    >**/
+    uint32_t            trigChannel;            //**< Kênh PWM Trigger của TIM_HCSR05       >**/
+    uint8_t             activeChannel;          //**< HAL_TIM_ACTIVE_CHANNEL_x của echoChannel >**/
+    uint8_t             index;                  //**< Chỉ số cảm biến                       >**/
+    uint8_t             slot;                   //**< Nhóm Trigger                          >**/
+    volatile uint8_t    capturing;              //**< Đã nhận rising edge, chờ falling edge >**/
+    volatile uint8_t    echoDone;               //**< Đã nhận Echo trong chu kỳ của nhóm    >**/
+    volatile uint32_t   risingEdge;             //**< Thời điểm rising edge                 >**/
+    volatile uint32_t   timeouts;               //**< Số lần mất xung Echo                  >**/
+    HCSR05_Filter       filter;                 //**< Bộ lọc trung vị + EMA                 >**/
+    HCSR05_Sample       sample;                 //**< Mẫu đã lọc mới nhất                   >**/
+} HCSR05_Sensor;
+
+/**
+ * @brief   Hàm callback nhận mẫu mới
+ * @note    Được gọi trong vòng lặp chính (HCSR05_update), không phải trong ngắt.
+ **/
+typedef void (*HCSR05_Callback)(const HCSR05_Sample *sample);
 
 /* ============================================[ FUNCTION PROTOTYPES ]========================================*/
 /**
  * @brief   Hàm sử dụng để xử lý ngắt khi có sự kiện capture từ Timer
  * @details Hàm này sẽ được gọi khi có sự kiện capture từ Timer HCSR05.
- *          Nó sẽ đọc giá trị thời gian từ Timer và tính toán khoảng cách dựa trên thời gian xung.
+ *          Ngắt chỉ ghi lại độ rộng xung Echo (số nguyên) vào hàng đợi,
+ *          việc quy đổi và lọc được thực hiện trong vòng lặp chính.
  * @note    Hàm này sẽ được gọi tự động khi có sự kiện capture từ Timer.  
  * @param   htim    Handle của Timer HCSR05
  * @return  void
@@ -53,52 +149,144 @@ extern void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim);
 extern void delay_us(uint16_t us);
 
 /**
- * @brief   Hàm khởi tạo cảm biến HCSR05   
- * @details Hàm này sẽ khởi tạo Timer và cấu hình các thông số cần thiết cho cảm biến HCSR05. 
- * @param   void   
+ * @brief   Hàm khởi tạo 1 cảm biến HCSR05   
+ * @details Hàm này đăng ký cảm biến vào bộ lập lịch và bật Input Capture kênh Echo.
+ *          Cảm biến dùng kênh Trigger mới sẽ tạo nhóm mới, theo thứ tự khởi tạo.
+ * @note    Gọi trước HCSR05_Start. Cấu hình trong CubeMX: TIM2 tick 1 us, tắt Auto-Reload Preload,
+ *          CH1 Input Capture (Echo trước), CH2 - CH3 PWM Generation (Trigger), bật ngắt TIM2;
+ *          TIM4 tick 1 us, ARR = 0xFFFF, CH1 - CH3 Input Capture (Echo sau, trái, phải), bật ngắt TIM4.
+ * @param   sensor      Đối tượng cảm biến (cấp phát tĩnh)
+ * @param   echoTim     Timer Input Capture của chân Echo
+ * @param   echoChannel Kênh Input Capture (TIM_CHANNEL_x)
+ * @param   trigChannel Kênh PWM Trigger của TIM_HCSR05 (TIM_CHANNEL_x)
+ * @return  HAL_StatusTypeDef   HAL_OK, HAL_ERROR nếu đã đủ HCSR05_MAX_SENSORS cảm biến
+ *                              hoặc HCSR05_MAX_SLOTS nhóm
+ **/
+HAL_StatusTypeDef HCSR05_Init(HCSR05_Sensor *sensor, TIM_HandleTypeDef *echoTim, uint32_t echoChannel, uint32_t trigChannel);
+
+/**
+ * @brief   Hàm bắt đầu đo liên tục các cảm biến đã khởi tạo
+ * @details Nhóm 0 được kích ngay, các nhóm tiếp theo lần lượt ở mỗi chu kỳ của TIM_HCSR05.
+ *          Mỗi cảm biến được cập nhật với tần số rateHz / số nhóm (cao hơn khi chuyển nhóm sớm).
+ * @param   rateHz  Tần số kích nhóm (Hz), bị giới hạn bởi HCSR05_MIN_PERIOD_US
  * @return  void
  **/
-void HCSR05_Init(void);
+void HCSR05_Start(uint16_t rateHz);
+
+/**
+ * @brief   Hàm thay đổi tần số kích nhóm
+ * @param   rateHz  Tần số kích nhóm (Hz), bị giới hạn bởi HCSR05_MIN_PERIOD_US
+ * @return  void
+ **/
+void HCSR05_SetRate(uint16_t rateHz);
 
 /**
  * @brief   Hàm kích hoạt cảm biến HCSR05 để bắt đầu quá trình đo khoảng cách   
- * @details Hàm này sẽ gửi tín hiệu kích hoạt đến chân Trigger của cảm biến HCSR05 
- *          để bắt đầu quá trình đo khoảng cách. 
- *          Sau khi kích hoạt, cảm biến sẽ gửi sóng siêu âm và chờ phản hồi từ vật thể.
+ * @details Hàm này kết thúc nhóm hiện tại và khởi động lại chu kỳ Timer để kích nhóm tiếp theo
+ *          ngay lập tức, không chờ bận. Chu kỳ đo liên tục tiếp tục từ thời điểm này.
  * @note    Hàm này sẽ được gọi để bắt đầu quá trình đo khoảng cách. 
- * @param   htim   
+ * @param   void   
  * @return  void
  **/
 void HCSR05_Trigger(void);
 
+/**
+ * @brief   Hàm xử lý ngắt update của Timer HCSR05
+ * @details Gọi trong HAL_TIM_PeriodElapsedCallback; bỏ qua nếu htim không phải Timer HCSR05.
+ *          Mỗi chu kỳ mới kích 1 nhóm; cảm biến nào của nhóm trước không có Echo hoàn chỉnh
+ *          thì bị hủy đo và đưa Echo rỗng (pulseUs = 0) vào hàng đợi để bộ lọc đếm lần mất.
+ *          Kênh Trigger của nhóm kế tiếp được nạp trước (preload CCR) để xung bắt đầu đúng tại update.
+ * @param   htim    Handle Timer phát sinh ngắt
+ * @return  void
+ **/
+void HCSR05_TimerHandler(TIM_HandleTypeDef *htim);
+
+/**
+ * @brief   Hàm đọc mẫu đo mới nhất của 1 cảm biến (đã lọc, cập nhật bởi HCSR05_update)
+ * @param   sensor  Đối tượng cảm biến
+ * @param   sample  Nơi lưu mẫu
+ * @return  uint8_t     1 nếu đã có ít nhất 1 mẫu, 0 nếu chưa
+ **/
+uint8_t HCSR05_Read(const HCSR05_Sensor *sensor, HCSR05_Sample *sample);
+
+/**
+ * @brief   Hàm đọc mảng khoảng cách mới nhất của mọi cảm biến
+ * @details Phần tử i là distanceMm của cảm biến khởi tạo thứ i,
+ *          HCSR05_MAX_RANGE_MM nếu chưa có mẫu hoặc ngoài tầm.
+ * @param   count   Nơi lưu số cảm biến, NULL nếu không cần
+ * @return  const uint16_t*     Mảng khoảng cách (mm)
+ **/
+const uint16_t *HCSR05_Distances(uint8_t *count);
+
+/**
+ * @brief   Hàm đăng ký callback nhận mẫu mới
+ * @param   callback    Hàm được gọi với mỗi mẫu mới
+ * @return  uint8_t     1 nếu thành công, 0 nếu đã đủ HCSR05_MAX_SUBSCRIBERS
+ **/
+uint8_t HCSR05_Subscribe(HCSR05_Callback callback);
+
+/**
+ * @brief   Hàm đọc số lần mất xung Echo (quá 1 chu kỳ của nhóm)
+ * @param   sensor  Đối tượng cảm biến
+ * @return  uint32_t    Số lần mất Echo
+ **/
+uint32_t HCSR05_Timeouts(const HCSR05_Sensor *sensor);
+
+/**
+ * @brief   Hàm khởi tạo bộ lọc khoảng cách
+ * @param   filter  Bộ lọc
+ * @return  void
+ **/
+void HCSR05_Filter_Init(HCSR05_Filter *filter);
+
+/**
+ * @brief   Hàm xử lý 1 xung Echo thô: quy đổi mm, loại bỏ Echo lỗi, lọc trung vị + EMA
+ * @details Echo mất hoặc ngoài [HCSR05_MIN_ECHO_US, HCSR05_MAX_ECHO_US] không đi vào bộ lọc;
+ *          sau HCSR05_INVALID_LIMIT Echo lỗi liên tiếp, bộ lọc được xóa và mẫu báo ngoài tầm
+ *          (HCSR05_MAX_RANGE_MM, valid = 0). Chỉ dùng số nguyên.
+ * @param   filter  Bộ lọc
+ * @param   echo    Xung Echo thô
+ * @param   sample  Mẫu kết quả (sequence không thay đổi)
+ * @return  uint8_t     1 nếu sample được cập nhật, 0 nếu Echo bị loại
+ **/
+uint8_t HCSR05_Filter_Process(HCSR05_Filter *filter, const HCSR05_Echo *echo, HCSR05_Sample *sample);
+
+/**
+ * @brief   Hàm đọc bộ đếm chất lượng của bộ lọc
+ * @param   sensor  Đối tượng cảm biến
+ * @return  const HCSR05_Filter*    Bộ lọc của cảm biến
+ **/
+const HCSR05_Filter *HCSR05_GetStats(const HCSR05_Sensor *sensor);
+
 /**
  * @brief   Hàm tính toán khoảng cách dựa trên thời gian xung đã đo được từ cảm biến HCSR05  
  * @details Hàm này sẽ tính toán khoảng cách dựa trên thời gian xung đã đo được từ cảm biến HCSR05.
- *          Công thức tính khoảng cách là: distance = (pulse_width * 0.0343) / 2.0 (đơn vị: cm).
+ *          Khoảng cách lấy từ mẫu đã lọc: distance = distanceMm / 10 (đơn vị: cm).
  * @note    Hàm này sẽ được gọi để tính toán khoảng cách sau khi đã kích hoạt cảm biến.
- *          Kết quả sẽ được lưu trữ trong biến distance_measure.    
- * @param   void   
+ *          Kết quả được tính từ mẫu mới nhất.    
+ * @param   sensor  Đối tượng cảm biến
  * @return  float   Khoảng cách đã tính toán (đơn vị: cm)
  **/
-float Calculate_Distance(void);
+float Calculate_Distance(const HCSR05_Sensor *sensor);
 
 /**
  * @brief   Hàm hiển thị khoảng cách đo được trên LCD  
  * @details Hàm này sẽ hiển thị khoảng cách đo được trên LCD.
  *          Nó sẽ sử dụng hàm sprintf để định dạng chuỗi và gửi đến LCD.
  * @note    Hàm này sẽ được gọi để hiển thị kết quả đo được trên LCD.    
- * @param   void   
+ * @param   sensor  Đối tượng cảm biến
  * @return  void
  **/
-void HCSR05_LCD(void);
+void HCSR05_LCD(const HCSR05_Sensor *sensor);
 
 
 /**
  * @brief   Hàm cập nhật khoảng cách đo được từ cảm biến HCSR05   
- * @details Hàm này sẽ kích hoạt cảm biến HCSR05 và chờ đợi kết quả đo được.
- *          Sau khi đo xong, nó sẽ trả về khoảng cách đã đo được.
+ * @details Hàm này không chặn: xử lý các xung Echo đang chờ của mọi cảm biến qua bộ lọc riêng,
+ *          cập nhật mảng khoảng cách, gọi các callback đã đăng ký với mỗi mẫu mới,
+ *          sau đó trả về khoảng cách mới nhất của cảm biến khởi tạo đầu tiên (cảm biến trước).
  * @param   void   
- * @return  void
+ * @return  float   Khoảng cách đo được gần nhất của cảm biến đầu tiên (đơn vị: cm)
  **/
 float HCSR05_update(void);
 
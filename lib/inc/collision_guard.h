@@ -0,0 +1,106 @@
+/*********************************************************************************************************************
+ * @file    collision_guard.h
+ * @brief   Thư viện giới hạn tốc độ theo quãng đường phanh và thời gian va chạm
+ * @details Mỗi hướng (trước, sau, trái, phải) giữ khoảng cách gần nhất và vận tốc tiếp cận.
+ *          Khoảng cách lấy từ mẫu siêu âm đã lọc của hướng đó (nếu còn mới) và khoảng trống của bản đồ;
+ *          vận tốc tiếp cận lấy từ hiệu 2 mẫu liên tiếp (lọc EMA) và thành phần vận tốc đã ra lệnh
+ *          theo hướng đó, chọn giá trị lớn hơn (vật cản có thể tự tiến lại gần).
+ *          Quãng đường phanh = v x trễ + v^2 / (2a), trễ = tuổi thực của mẫu (từ lúc đo đến lúc giới hạn)
+ *          cộng trễ phản ứng GUARD_LATENCY_MS; khoảng cách chỉ có từ bản đồ dùng tuổi lớn nhất. Thành phần vận tốc về phía mỗi hướng bị giới hạn
+ *          để quãng đường phanh không vượt quá khoảng trống trừ lề an toàn, và bị đặt về 0 khi thời gian
+ *          va chạm nhỏ hơn GUARD_TTC_STOP_MS. Mỗi trục được giới hạn riêng nên xe Mecanum vẫn đi ngang
+ *          dọc theo vật cản phía trước. Vận tốc quay không bị giới hạn.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __COLLISION_GUARD_H__
+#define __COLLISION_GUARD_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "HCSR05.h"                     //**< Thư viện cảm biến siêu âm HCSR05 >**/
+#include "occupancy_grid.h"             //**< Thư viện bản đồ chiếm chỗ >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define GUARD_DECEL_MM_S2       1500    //**< Gia tốc phanh (mm/s^2), cần hiệu chỉnh        >**/
+#define GUARD_LATENCY_MS        100     //**< Trễ từ lúc ra lệnh đến lúc bắt đầu phanh (ms), chưa gồm tuổi mẫu >**/
+#define GUARD_TTC_STOP_MS       300     //**< Thời gian va chạm nhỏ hơn giá trị này: dừng   >**/
+#define GUARD_SAMPLE_MAX_AGE_US 250000  //**< Mẫu cũ hơn giá trị này không được dùng (us)   >**/
+/*
+ * Cảm biến phía trước gắn trên Servo: trong AUTO Servo quét qua lại {135, 90, 45} nên bước SCAN_ANGLE_FRONT
+ * lặp lại sau mỗi 2 bước, mỗi bước ~200 - 300 ms (quay 45 độ + SERVO_SETTLE_MARGIN_MS + chờ 1 mẫu đo),
+ * tức mẫu phía trước đến cách nhau ~0.4 - 0.6 s. Giới hạn tuổi riêng cho hướng này lớn hơn chu kỳ đó;
+ * tuổi mẫu vẫn được cộng vào trễ nên mẫu càng cũ thì quãng đường phanh tính càng dài.
+ */
+#define GUARD_FRONT_MAX_AGE_US  700000  //**< Tuổi lớn nhất của mẫu phía trước (us)        >**/
+#define GUARD_CLOSING_SHIFT     1       //**< Hệ số EMA vận tốc tiếp cận = 1 / 2^SHIFT      >**/
+#define GUARD_CLOSING_MAX_MM_S  2000    //**< Giới hạn vận tốc tiếp cận đo được (mm/s)      >**/
+#define GUARD_MARGIN_MM         200     //**< Lề an toàn mặc định (mm)                      >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Các hướng được giám sát
+ **/
+typedef enum {
+    GUARD_FRONT = 0,                    //**< Phía trước, ứng với vy > 0    >**/
+    GUARD_REAR  = 1,                    //**< Phía sau, ứng với vy < 0      >**/
+    GUARD_LEFT  = 2,                    //**< Bên trái, ứng với vx < 0      >**/
+    GUARD_RIGHT = 3,                    //**< Bên phải, ứng với vx > 0      >**/
+    GUARD_AXES  = 4
+} Guard_Axis;
+
+/**
+ * @brief   Trạng thái của 1 hướng sau lần giới hạn gần nhất
+ **/
+typedef struct {
+    uint16_t rangeMm;                   //**< Khoảng cách đến vật cản (mm)                  >**/
+    int16_t  closingMmS;                //**< Vận tốc tiếp cận đã dùng (mm/s, > 0: lại gần) >**/
+    uint16_t stoppingMm;                //**< Quãng đường phanh tại vận tốc đã ra lệnh (mm) >**/
+    uint16_t ttcMs;                     //**< Thời gian va chạm (ms), 0xFFFF nếu không tiến lại gần >**/
+    uint16_t allowedMmS;                //**< Vận tốc lớn nhất cho phép về hướng này (mm/s) >**/
+    uint8_t  limited;                   //**< 1: lệnh về hướng này đã bị giảm               >**/
+} Guard_State;
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm khởi tạo bộ giới hạn
+ * @param   void
+ * @return  void
+ **/
+void Guard_Init(void);
+
+/**
+ * @brief   Hàm đặt lề an toàn (khoảng cách luôn giữ với vật cản)
+ * @param   marginMm    Lề an toàn (mm)
+ * @return  void
+ **/
+void Guard_SetMargin(uint16_t marginMm);
+
+/**
+ * @brief   Hàm đưa 1 mẫu siêu âm đã lọc của 1 hướng vào bộ giới hạn (gọi trong callback HCSR05)
+ * @details Cảm biến phía trước gắn trên Servo: chỉ đưa mẫu đo khi Servo đã ổn định ở SCAN_ANGLE_FRONT.
+ * @param   axis    Hướng của cảm biến
+ * @param   sample  Mẫu mới
+ * @return  void
+ **/
+void Guard_AddRange(Guard_Axis axis, const HCSR05_Sample *sample);
+
+/**
+ * @brief   Hàm giới hạn lệnh vận tốc theo quãng đường phanh và thời gian va chạm
+ * @param   vx      Vận tốc sang ngang (%, sang phải dương), được sửa tại chỗ
+ * @param   vy      Vận tốc tiến lùi (%, tiến lên dương), được sửa tại chỗ
+ * @return  uint8_t     1 nếu lệnh đã bị giảm, 0 nếu giữ nguyên
+ **/
+uint8_t Guard_Limit(int16_t *vx, int16_t *vy);
+
+/**
+ * @brief   Hàm đọc trạng thái của 1 hướng
+ * @param   axis    Hướng cần đọc
+ * @param   state   Nơi lưu trạng thái
+ * @return  void
+ **/
+void Guard_GetState(Guard_Axis axis, Guard_State *state);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
@@ -18,33 +18,37 @@
  *  [3]-------[2]
  */
 
-#define LINE_GO_HEAD1				0x19		// 11001
-#define LINE_GO_HEAD2				0x13		// 10011
-#define LINE_GO_HEAD3				0x11		// 10001
-#define LINE_GO_HEAD4				0x00		// 00000
-#define LINE_GO_HEAD5				0x1b		// 11011
-
-
-#define LINE_GO_LEFT_SLOW1	0x0f		// 01111
-#define LINE_GO_LEFT_SLOW2	0x07		// 00111
-#define LINE_GO_LEFT_SLOW3	0x03		// 00011
-#define LINE_GO_LEFT_SLOW4	0x01		// 00001
-#define LINE_GO_LEFT_SLOW5	0x17		// 10111
-
-#define LINE_GO_RIGHT_SLOW1	0x1c		// 11110
-#define LINE_GO_RIGHT_SLOW2	0x1e		// 11100
-#define LINE_GO_RIGHT_SLOW3	0x18		// 11000
-#define LINE_GO_RIGHT_SLOW4	0x10		// 10000
-#define LINE_GO_RIGHT_SLOW5	0x1d		// 11101
-
-#define	LINE_GO_TURN				0x1f		// 11111
+// bang chan LINE1 ... LINE5 cua tung mang cam bien (moi port chi doc IDR 1 lan)
+#define LINE_ARRAY_SENSORS	5
+#define LINE_FRONT_PORTS		{GPIOB, GPIOB, GPIOB, GPIOB, GPIOC}
+#define LINE_FRONT_PINS			{GPIO_PIN_12, GPIO_PIN_14, GPIO_PIN_13, GPIO_PIN_15, GPIO_PIN_7}
+// mang sau: dau cung chieu mang truoc (LINE1 ben trai xe), cau hinh input trong CubeMX
+#define LINE_REAR_PORTS			{GPIOE, GPIOE, GPIOE, GPIOE, GPIOE}
+#define LINE_REAR_PINS			{GPIO_PIN_7, GPIO_PIN_8, GPIO_PIN_9, GPIO_PIN_10, GPIO_PIN_11}
+// giai ma: moi mang toi da 2 port, cac chan tren 1 port nam trong 5 chan lien tiep
+#define LINE_READ_PORTS			2
+#define LINE_REMAP_BITS			5
+#define LINE_REMAP_SIZE			(1U << LINE_REMAP_BITS)
+#define LINE_REMAP_MASK			(LINE_REMAP_SIZE - 1U)
+
+// mang cam bien line, chon theo chieu di cua xe
+typedef enum {
+	LINE_ARRAY_FRONT = 0,				// dung khi tien
+	LINE_ARRAY_REAR = 1,				// dung khi lui
+	LINE_ARRAY_COUNT = 2
+} Line_ArrayId;
 
+// huong lap cua mang so voi chieu di ma mang do phuc vu
+typedef enum {
+	LINE_ORIENT_NORMAL = 0,				// LINE1 ben trai khi nhin theo chieu di
+	LINE_ORIENT_MIRROR = 1				// LINE1 ben phai khi nhin theo chieu di: dao mau
+} Line_Orientation;
 
-#define READ_LINE1	HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_12)
-#define READ_LINE2	HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_14)
-#define READ_LINE3	HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_13)
-#define READ_LINE4	HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_15)
-#define READ_LINE5	HAL_GPIO_ReadPin(GPIOC, GPIO_PIN_7)
+typedef struct {
+	GPIO_TypeDef *port[LINE_ARRAY_SENSORS];	// port cua LINE1 ... LINE5
+	uint16_t pin[LINE_ARRAY_SENSORS];		// chan cua LINE1 ... LINE5
+	uint8_t orientation;					// Line_Orientation
+} Line_Array;
 
 typedef enum {
 	STATE_HEAD = 0,
@@ -52,7 +56,22 @@ typedef enum {
 	STATE_RIGHT = 2
 } State_Line;
 
-
+// chi so ham xu ly trong mang handleLine[]
+typedef enum {
+	LINE_ACTION_HEAD = 0,
+	LINE_ACTION_LEFT = 1,
+	LINE_ACTION_RIGHT = 2,
+	LINE_ACTION_TURN_LEFT = 3,
+	LINE_ACTION_TURN_RIGHT = 4,
+	LINE_ACTION_TURN = 5				// quay dau theo huong lech truoc do
+} Line_Action;
+
+
+void detect_Line_Init(void);
+void detect_Line_Select(Line_ArrayId array);
+Line_ArrayId detect_Line_Selected(void);
+uint8_t detect_Line_Read(void);
+void detect_Line_Dispatch(uint8_t pattern, void (* handleLine[])(void));
 void detect_Line(void (* handleLine[])(void));
 
 #endif
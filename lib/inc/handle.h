@@ -2,18 +2,27 @@
 #define __HANDLE_H__
 
 #include "74HC595.h"
-#include "ps2x.h"
+#include "ps2.h"
+#include "ps2_event.h"
+#include "ps2_stick.h"
+#include "latency_probe.h"
 #include "HCSR05.h"
 #include "servo.h"
+#include "sonar_scan.h"
+#include "occupancy_grid.h"
+#include "vfh_avoid.h"
+#include "collision_guard.h"
 #include "interrrupt.h"
 #include "ledmatrix.h"
 #include "i2c-lcd.h"
 
 #include "handle_mecanum.h"    
 #include "detectline.h" 
+#include "line_follow.h"
 
 
 
+void initAll(void);
 void updateAll(void);
 void display_LCD(void);
 
@@ -22,6 +31,7 @@ void control_PS2(void);
 
 
 void update_status_car(void);
+void rumble_Obstacle(float dis);
 void update_Detect_Line(void);
 
 #endif
@@ -17,9 +17,15 @@
 #define SLAVE_ADDRESS_LCD   0x4E        //**< Địa chỉ I2C của LCD I2C >**/
 #define LCD_COLUMS			16          //**< Số cột của LCD >**/
 #define LCD_ROWS		    2           //**< Số hàng của LCD >**/
+#define LCD_TX_BUFFER_SIZE  512         //**< Kích thước bộ đệm vòng dữ liệu gửi LCD (byte) >**/
+#define LCD_I2C_CHUNK       16          //**< Số byte tối đa của 1 giao dịch I2C (4 ký tự) >**/
+#define LCD_I2C_DEADLINE_US 20000       //**< Deadline của 1 giao dịch LCD trên bus (us) >**/
+#define LCD_CLEAR_HOLD_US   2000        //**< Thời gian chờ sau lệnh Clear display 0x01 (> 1.52 ms) >**/
 
 /* ============================================[ INCLUDE FILE ]============================================*/
 #include "main.h"                       //**< Thư viện chứa các định nghĩa GPIO và hàm HAL >**/
+#include "i2c_manager.h"                //**< Thư viện quản lý bus I2C dùng chung >**/
+#include "timebase.h"                   //**< Thư viện nguồn thời gian micro giây >**/
 
 /* ==========================================[ TYPE DEFINITIONS ]==========================================*/
 extern I2C_HandleTypeDef hi2c1;         //**< Handle I2C sử dụng cho LCD I2C >**/
@@ -30,6 +36,7 @@ extern I2C_HandleTypeDef hi2c1;         //**< Handle I2C sử dụng cho LCD I2C
  * @brief   Hàm khởi tạo LCD I2C
  * @details Hàm này sẽ khởi tạo LCD I2C bằng cách gửi các lệnh cấu hình ban đầu đến LCD.
  *          Nó sẽ thiết lập chế độ 4 bit, số dòng và kiểu ký tự. 
+ * @note    Cần gọi I2C_Mgr_Init trước; LCD được đăng ký là client ưu tiên thấp.
  * @param   void    
  * @return  void
  **/
@@ -81,13 +88,40 @@ void lcd_set_cursor(uint8_t Xpos, uint8_t Ypos); //poiter to X,Y
 
 /**
  * @brief   Hàm xóa màn hình LCD I2C
- * @details Hàm này sẽ gửi dữ liệu đến LCD I2C bằng cách sử dụng giao thức I2C.
- * 		 	Nó sẽ gửi dữ liệu toàn bộ là khoảng trống
+ * @details Hàm này gửi lệnh Clear display 0x01 (4 byte) thay vì ghi khoảng trống lên toàn màn hình;
+ *          dữ liệu sau lệnh được giữ lại LCD_CLEAR_HOLD_US trong lúc LCD xóa (xem lcd_service).
  * @note    Hàm này sẽ được gọi để xóa dữ liệu trên LCD.
+ *          Mỗi lần xóa bắt đầu một khung hình mới và xóa cờ bỏ khung hình.
  * @param   void
  * @return  void
  **/
 void lcd_clear (void);  
 
+
+/**
+ * @brief   Hàm kiểm tra khung hình hiện tại có bị bỏ hay không
+ * @details Khi một giao dịch I2C lỗi, hết deadline hoặc bộ đệm gửi bị đầy, phần còn lại của
+ *          khung hình sẽ bị bỏ qua để không làm chậm vòng điều khiển động cơ.
+ *          Khung hình sẽ được vẽ lại đầy đủ ở lần gọi lcd_clear tiếp theo.
+ * @param   void
+ * @return  uint8_t     1 nếu khung hình hiện tại đã bị bỏ
+ **/
+uint8_t lcd_frame_dropped (void);
+
+/**
+ * @brief   Hàm tiếp tục gửi dữ liệu sau thời gian chờ lệnh xóa màn hình
+ * @details Gọi thường xuyên trong vòng lặp chính (sau I2C_Mgr_Service), không chặn.
+ * @param   void
+ * @return  void
+ **/
+void lcd_service (void);
+
+/**
+ * @brief   Hàm đọc số khung hình LCD đã bị bỏ
+ * @param   void
+ * @return  uint32_t    Số khung hình đã bị bỏ kể từ khi khởi động
+ **/
+uint32_t lcd_dropped_frames (void);
+
 /* =====================================================[ Guard ]====================================================*/
 #endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+/*********************************************************************************************************************
+ * @file    i2c_bus.h
+ * @brief   Thư viện truy cập bus I2C với thời gian chặn giới hạn
+ * @details Thư viện các hàm truyền dữ liệu I2C với deadline tính bằng micro giây, thử lại khi lỗi,
+ *          bộ đếm lỗi và tự động giải phóng bus (đảo chân SCL) khi bus bị treo.
+ *          Thời gian chặn lớn nhất được ghi lại để kiểm chứng trên phần cứng hoặc trên mô phỏng.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __I2C_BUS_H__
+#define __I2C_BUS_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include <stdint.h>                     //**< Thư viện sử dụng kiểu dữ liệu uint >**/
+#include "main.h"                       //**< Thư viện chứa các định nghĩa GPIO và hàm HAL >**/
+#include "timebase.h"                   //**< Thư viện nguồn thời gian micro giây >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define I2C_BUS_HANDLE          hi2c1           //**< Handle I2C sử dụng cho bus            >**/
+
+#define I2C_BUS_SCL_PORT        GPIOB           //**< GPIO - SCL - I2C1 - PORT              >**/
+#define I2C_BUS_SCL_PIN         GPIO_PIN_6      //**< GPIO - SCL - I2C1 - PIN               >**/
+#define I2C_BUS_SDA_PORT        GPIOB           //**< GPIO - SDA - I2C1 - PORT              >**/
+#define I2C_BUS_SDA_PIN         GPIO_PIN_7      //**< GPIO - SDA - I2C1 - PIN               >**/
+
+#define I2C_BUS_RETRIES         2               //**< Số lần thử lại tối đa trong 1 deadline >**/
+#define I2C_BUS_RECOVERY_CLOCKS 9               //**< Số xung SCL tối đa khi giải phóng bus  >**/
+#define I2C_BUS_HALF_PERIOD_US  5               //**< Nửa chu kỳ SCL khi giải phóng (100kHz) >**/
+#define I2C_BUS_BACKOFF_US      50000           //**< Thời gian tạm ngưng bus sau khi giải phóng thất bại >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Kết quả của một lần truyền I2C
+ **/
+typedef enum {
+    I2C_BUS_OK      = 0,                //**< Truyền thành công                     >**/
+    I2C_BUS_NACK    = 1,                //**< Thiết bị không phản hồi (NACK)        >**/
+    I2C_BUS_ERROR   = 2,                //**< Lỗi bus / mất quyền điều khiển bus    >**/
+    I2C_BUS_TIMEOUT = 3,                //**< Hết deadline                          >**/
+    I2C_BUS_DROPPED = 4                 //**< Bus đang tạm ngưng, bỏ qua giao dịch  >**/
+} I2C_Bus_Status;
+
+/**
+ * @brief   Bộ đếm thống kê của bus I2C
+ **/
+typedef struct {
+    uint32_t transfers;                 //**< Số giao dịch thành công               >**/
+    uint32_t retries;                   //**< Số lần thử lại                        >**/
+    uint32_t nacks;                     //**< Số lần NACK                           >**/
+    uint32_t arbitrationLost;           //**< Số lần mất quyền điều khiển bus       >**/
+    uint32_t busErrors;                 //**< Số lần lỗi bus (BERR, OVR)            >**/
+    uint32_t timeouts;                  //**< Số lần hết deadline                   >**/
+    uint32_t recoveries;                //**< Số lần giải phóng bus                 >**/
+    uint32_t dropped;                   //**< Số giao dịch bị bỏ qua                >**/
+    uint32_t lastBlockUs;               //**< Thời gian chặn của giao dịch gần nhất >**/
+    uint32_t maxBlockUs;                //**< Thời gian chặn lớn nhất               >**/
+} I2C_Bus_Stats;
+
+extern I2C_HandleTypeDef I2C_BUS_HANDLE;        //**< Handle I2C sử dụng cho bus >**/
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm truyền dữ liệu I2C với deadline micro giây
+ * @details Hàm này khởi động truyền bằng ngắt (HAL_I2C_Master_Transmit_IT) và chờ tối đa deadlineUs.
+ *          Khi NACK sẽ thử lại trong phạm vi deadline; khi mất quyền điều khiển bus, lỗi bus
+ *          hoặc hết deadline sẽ hủy giao dịch và giải phóng bus.
+ * @note    Cần bật ngắt I2C1_EV và I2C1_ER trong CubeMX.
+ *          Tổng thời gian chặn không vượt quá deadlineUs cộng thời gian giải phóng bus.
+ * @param   address     Địa chỉ I2C 8 bit của thiết bị
+ * @param   data        Dữ liệu cần truyền
+ * @param   length      Số byte cần truyền
+ * @param   deadlineUs  Thời gian chặn tối đa (us)
+ * @return  I2C_Bus_Status  Kết quả truyền
+ **/
+I2C_Bus_Status I2C_Bus_Transmit(uint16_t address, uint8_t *data, uint16_t length, uint32_t deadlineUs);
+
+/**
+ * @brief   Hàm giải phóng bus I2C bị treo
+ * @details Hàm này tắt ngoại vi I2C, đảo chân SCL tối đa I2C_BUS_RECOVERY_CLOCKS lần
+ *          cho đến khi thiết bị slave nhả SDA, tạo điều kiện STOP rồi khởi tạo lại ngoại vi.
+ * @param   void
+ * @return  uint8_t     1 nếu SDA đã được nhả, 0 nếu bus vẫn bị giữ
+ **/
+uint8_t I2C_Bus_Recover(void);
+
+/**
+ * @brief   Hàm kiểm tra bus có sẵn sàng nhận giao dịch hay không
+ * @details Sau khi giải phóng bus thất bại, bus tạm ngưng trong I2C_BUS_BACKOFF_US
+ *          để không làm chậm vòng điều khiển.
+ * @param   void
+ * @return  uint8_t     1 nếu bus sẵn sàng, 0 nếu đang tạm ngưng
+ **/
+uint8_t I2C_Bus_IsAvailable(void);
+
+/**
+ * @brief   Hàm đọc bộ đếm thống kê của bus I2C
+ * @param   void
+ * @return  const I2C_Bus_Stats*    Con trỏ đến bộ đếm thống kê
+ **/
+const I2C_Bus_Stats *I2C_Bus_GetStats(void);
+
+/**
+ * @brief   Hàm xóa bộ đếm thống kê của bus I2C
+ * @param   void
+ * @return  void
+ **/
+void I2C_Bus_ResetStats(void);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
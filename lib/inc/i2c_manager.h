@@ -0,0 +1,139 @@
+/*********************************************************************************************************************
+ * @file    i2c_manager.h
+ * @brief   Thư viện quản lý giao dịch trên bus I2C1 dùng chung
+ * @details Thư viện cho phép nhiều thiết bị (LCD, IMU, EEPROM, ...) dùng chung bus I2C1.
+ *          Mỗi thiết bị đăng ký một client có độ ưu tiên; các giao dịch được xếp hàng với deadline
+ *          và được thực hiện lần lượt bằng một kênh DMA duy nhất.
+ *          Sau mỗi giao dịch, bộ lập lịch chọn giao dịch có độ ưu tiên cao nhất (cùng độ ưu tiên thì
+ *          deadline sớm nhất), nên lệnh đọc cảm biến được chen lên trước dữ liệu hiển thị đang chờ.
+ *          Thống kê độ trễ được ghi riêng cho từng client.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __I2C_MANAGER_H__
+#define __I2C_MANAGER_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include <stdint.h>                     //**< Thư viện sử dụng kiểu dữ liệu uint >**/
+#include "main.h"                       //**< Thư viện chứa các định nghĩa GPIO và hàm HAL >**/
+#include "i2c_bus.h"                    //**< Thư viện truy cập bus I2C (giải phóng bus, trạng thái) >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define I2C_MGR_MAX_CLIENTS         4           //**< Số client tối đa                          >**/
+#define I2C_MGR_QUEUE_SIZE          8           //**< Số giao dịch chờ tối đa trên toàn bus      >**/
+#define I2C_MGR_TRANSFER_TIMEOUT_US 5000        //**< Thời gian tối đa của 1 giao dịch DMA (us)  >**/
+#define I2C_MGR_INVALID_CLIENT      0xFF        //**< Mã client không hợp lệ                     >**/
+
+#define I2C_MGR_PRIORITY_HIGH       0           //**< Độ ưu tiên cao (cảm biến)                  >**/
+#define I2C_MGR_PRIORITY_NORMAL     1           //**< Độ ưu tiên trung bình (EEPROM)             >**/
+#define I2C_MGR_PRIORITY_LOW        2           //**< Độ ưu tiên thấp (hiển thị)                 >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Loại giao dịch I2C
+ **/
+typedef enum {
+    I2C_MGR_WRITE       = 0,            //**< Ghi dữ liệu                           >**/
+    I2C_MGR_READ        = 1,            //**< Đọc dữ liệu                           >**/
+    I2C_MGR_MEM_WRITE   = 2,            //**< Ghi vào thanh ghi / địa chỉ nhớ       >**/
+    I2C_MGR_MEM_READ    = 3             //**< Đọc từ thanh ghi / địa chỉ nhớ        >**/
+} I2C_Mgr_Op;
+
+/**
+ * @brief   Hàm callback khi giao dịch kết thúc
+ * @note    Được gọi trong ngắt DMA/I2C (hoặc trong I2C_Mgr_Service khi hết deadline).
+ **/
+typedef void (*I2C_Mgr_Callback)(uint8_t client, I2C_Bus_Status status, void *context);
+
+/**
+ * @brief   Thông tin một giao dịch gửi vào hàng đợi
+ * @note    Bộ đệm data phải tồn tại đến khi callback được gọi (DMA đọc/ghi trực tiếp).
+ **/
+typedef struct {
+    I2C_Mgr_Op       op;                //**< Loại giao dịch                        >**/
+    uint16_t         address;           //**< Địa chỉ I2C 8 bit của thiết bị        >**/
+    uint16_t         memAddress;        //**< Địa chỉ thanh ghi (chỉ MEM_READ/WRITE) >**/
+    uint16_t         memAddressSize;    //**< I2C_MEMADD_SIZE_8BIT / 16BIT          >**/
+    uint8_t         *data;              //**< Bộ đệm dữ liệu                        >**/
+    uint16_t         length;            //**< Số byte                               >**/
+    uint32_t         deadlineUs;        //**< Deadline tính từ lúc gửi vào hàng đợi  >**/
+    I2C_Mgr_Callback callback;          //**< Callback khi kết thúc (có thể NULL)   >**/
+    void            *context;           //**< Tham số truyền cho callback           >**/
+} I2C_Mgr_Request;
+
+/**
+ * @brief   Thống kê độ trễ của một client
+ * @details Độ trễ tính từ lúc giao dịch vào hàng đợi đến lúc hoàn thành (chờ + truyền).
+ **/
+typedef struct {
+    uint32_t completed;                 //**< Số giao dịch thành công               >**/
+    uint32_t failed;                    //**< Số giao dịch lỗi (NACK, lỗi bus, timeout) >**/
+    uint32_t expired;                   //**< Số giao dịch hết deadline trước khi chạy >**/
+    uint32_t rejected;                  //**< Số giao dịch bị từ chối (hàng đợi đầy) >**/
+    uint32_t deadlineMisses;            //**< Số giao dịch hoàn thành sau deadline  >**/
+    uint32_t lastLatencyUs;             //**< Độ trễ gần nhất (us)                  >**/
+    uint32_t maxLatencyUs;              //**< Độ trễ lớn nhất (us)                  >**/
+    uint64_t sumLatencyUs;              //**< Tổng độ trễ để tính trung bình (us)   >**/
+} I2C_Mgr_ClientStats;
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm khởi tạo bộ quản lý bus I2C
+ * @note    Gọi trước lcd_init và trước khi đăng ký client.
+ *          Sau khi khởi tạo, không dùng I2C_Bus_Transmit trực tiếp trên cùng bus.
+ * @param   void
+ * @return  void
+ **/
+void I2C_Mgr_Init(void);
+
+/**
+ * @brief   Hàm đăng ký client mới trên bus
+ * @param   priority    Độ ưu tiên (I2C_MGR_PRIORITY_HIGH ... I2C_MGR_PRIORITY_LOW)
+ * @return  uint8_t     Mã client, hoặc I2C_MGR_INVALID_CLIENT nếu đã đủ client
+ **/
+uint8_t I2C_Mgr_RegisterClient(uint8_t priority);
+
+/**
+ * @brief   Hàm gửi một giao dịch vào hàng đợi
+ * @details Hàm không chặn: giao dịch được thực hiện bằng DMA khi bus rảnh và
+ *          kết quả được báo qua callback.
+ * @param   client      Mã client đã đăng ký
+ * @param   request     Thông tin giao dịch (được sao chép vào hàng đợi)
+ * @return  I2C_Bus_Status  I2C_BUS_OK nếu đã vào hàng đợi, I2C_BUS_DROPPED nếu hàng đợi đầy
+ **/
+I2C_Bus_Status I2C_Mgr_Submit(uint8_t client, const I2C_Mgr_Request *request);
+
+/**
+ * @brief   Hàm phục vụ bộ quản lý, gọi trong vòng lặp chính
+ * @details Hàm này hủy giao dịch DMA bị treo quá I2C_MGR_TRANSFER_TIMEOUT_US (giải phóng bus),
+ *          loại bỏ giao dịch đã hết deadline và khởi động lại bộ lập lịch nếu bus đang rảnh.
+ * @param   void
+ * @return  void
+ **/
+void I2C_Mgr_Service(void);
+
+/**
+ * @brief   Hàm đếm số giao dịch đang chờ hoặc đang chạy của một client
+ * @param   client      Mã client
+ * @return  uint8_t     Số giao dịch
+ **/
+uint8_t I2C_Mgr_Pending(uint8_t client);
+
+/**
+ * @brief   Hàm đọc thống kê độ trễ của một client
+ * @param   client      Mã client
+ * @return  const I2C_Mgr_ClientStats*  Con trỏ đến thống kê, NULL nếu client không hợp lệ
+ **/
+const I2C_Mgr_ClientStats *I2C_Mgr_GetStats(uint8_t client);
+
+/**
+ * @brief   Hàm xóa thống kê độ trễ của tất cả client
+ * @param   void
+ * @return  void
+ **/
+void I2C_Mgr_ResetStats(void);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
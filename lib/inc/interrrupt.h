@@ -56,6 +56,17 @@ uint8_t distance = DISTANCE_MIN;	//**< Khoảng cách đo thiết lập 		>**/
  **/
 extern void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
 
+/**
+ * @brief   Hàm xử lý ngắt tràn (update) của các Timer
+ * @details Hàm này phân phối ngắt update đến các module sử dụng Timer làm nhịp nền,
+ *          mỗi module tự kiểm tra htim có phải Timer của mình hay không.
+ * @note    Nếu HAL dùng một Timer làm timebase (thay vì SysTick), chuyển lời gọi HAL_IncTick
+ *          của main.c vào hàm này.
+ * @param   htim    Handle Timer phát sinh ngắt
+ * @return  void
+ **/
+extern void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+
 /* =====================================================[ Guard ]====================================================*/
 #endif
 
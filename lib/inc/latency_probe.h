@@ -0,0 +1,123 @@
+/*********************************************************************************************************************
+ * @file    latency_probe.h
+ * @brief   Thư viện đo độ trễ từ tay cầm PS2 đến động cơ
+ * @details Thư viện gắn nhãn thời gian (bộ đếm chu kỳ DWT trên vi điều khiển, đồng hồ ảo khi HOST_SIM)
+ *          cho từng giai đoạn của đường điều khiển:
+ *          nhận xong khung SPI -> giải mã / công bố -> lệnh chuyển động -> ghi xong PWM và 74HC595.
+ *          Mỗi lần trạng thái tay cầm lái xe (PS2_FEATURE_LATENCY) thay đổi, một mẫu được bắt đầu và gắn
+ *          số thứ tự khung đã công bố. Giai đoạn MOTION chỉ được ghi khi control_PS2 xử lý ảnh chụp có số
+ *          khung đó (hoặc mới hơn), nên lần gọi carSetMotors dùng ảnh chụp cũ hay từ chế độ khác không kết thúc mẫu.
+ *          Độ trễ tổng được đưa vào histogram riêng cho từng chế độ (Mode); chỉ đo khi được bật
+ *          (chế độ mà tay cầm PS2 trực tiếp điều khiển động cơ).
+ *          Tại mỗi thời điểm chỉ đo 1 mẫu, các thay đổi xảy ra khi đang đo được bỏ qua.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __LATENCY_PROBE_H__
+#define __LATENCY_PROBE_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include <stdint.h>                     //**< Thư viện sử dụng kiểu dữ liệu uint >**/
+#include "timebase.h"                   //**< Thư viện nguồn thời gian (DWT / đồng hồ ảo) >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define LATENCY_MODES           4       //**< Số chế độ (CONTROL, LINE, AUTO, NONE)            >**/
+#define LATENCY_HIST_BINS       16      //**< Số ô histogram, ô cuối chứa mọi giá trị lớn hơn  >**/
+#define LATENCY_HIST_BIN_US     1000    //**< Độ rộng mỗi ô histogram (us)                     >**/
+#define LATENCY_SAMPLE_TIMEOUT_US 1000000 //**< Mẫu chưa kết thúc sau thời gian này bị hủy (us)  >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Các giai đoạn của đường điều khiển
+ **/
+typedef enum {
+    LATENCY_STAGE_RESPONSE = 0,         //**< DMA nhận xong khung SPI (ngắt DMA)            >**/
+    LATENCY_STAGE_DECODE   = 1,         //**< Đã giải mã và công bố ảnh chụp (ngắt DMA)     >**/
+    LATENCY_STAGE_MOTION   = 2,         //**< control_PS2 xử lý ảnh chụp của mẫu            >**/
+    LATENCY_STAGE_COMMIT   = 3,         //**< Đã ghi CCR của TIM1 và dịch xong 74HC595      >**/
+    LATENCY_STAGES         = 4
+} Latency_Stage;
+
+/**
+ * @brief   Thống kê độ trễ của một chế độ
+ * @details stageMaxUs[i] là khoảng lớn nhất giữa giai đoạn i và i + 1.
+ **/
+typedef struct {
+    uint32_t count;                             //**< Số mẫu đã đo                      >**/
+    uint32_t minUs;                             //**< Độ trễ tổng nhỏ nhất (us)         >**/
+    uint32_t maxUs;                             //**< Độ trễ tổng lớn nhất (us)         >**/
+    uint64_t sumUs;                             //**< Tổng độ trễ để tính trung bình    >**/
+    uint32_t stageMaxUs[LATENCY_STAGES - 1];    //**< Khoảng lớn nhất giữa 2 giai đoạn  >**/
+    uint32_t bins[LATENCY_HIST_BINS];           //**< Histogram độ trễ tổng             >**/
+} Latency_ModeStats;
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm xóa toàn bộ thống kê và hủy mẫu đang đo
+ * @param   void
+ * @return  void
+ **/
+void Latency_Probe_Reset(void);
+
+/**
+ * @brief   Hàm bắt đầu một mẫu tại giai đoạn LATENCY_STAGE_RESPONSE
+ * @details Gọi trong ngắt khi khung vừa nhận có trạng thái khác khung trước.
+ *          Bỏ qua nếu đang tắt đo hoặc đang có mẫu chưa kết thúc (trừ khi mẫu đó đã quá LATENCY_SAMPLE_TIMEOUT_US).
+ * @param   cycles  Thời điểm nhận xong khung (Timebase_Cycles)
+ * @param   frame   Số thứ tự khung của ảnh chụp chứa thay đổi (PS2_Snapshot.frame)
+ * @return  void
+ **/
+void Latency_Probe_Start(uint32_t cycles, uint32_t frame);
+
+/**
+ * @brief   Hàm ghi nhãn thời gian cho một giai đoạn của mẫu đang đo
+ * @details Chỉ ghi nếu giai đoạn trước đã được ghi và giai đoạn này chưa được ghi.
+ *          Khi ghi LATENCY_STAGE_COMMIT, mẫu kết thúc và được đưa vào thống kê của chế độ hiện tại.
+ *          LATENCY_STAGE_MOTION ghi bằng Latency_Probe_Motion.
+ * @param   stage   Giai đoạn cần ghi
+ * @return  void
+ **/
+void Latency_Probe_Stamp(Latency_Stage stage);
+
+/**
+ * @brief   Hàm ghi nhãn LATENCY_STAGE_MOTION khi bộ điều khiển xử lý 1 ảnh chụp tay cầm
+ * @details Gọi ngay trước lệnh chuyển động được tính từ ảnh chụp. Chỉ ghi nếu ảnh chụp có số khung
+ *          không cũ hơn khung của mẫu đang đo.
+ * @param   frame   Số thứ tự khung của ảnh chụp đang xử lý (PS2_Snapshot.frame)
+ * @return  void
+ **/
+void Latency_Probe_Motion(uint32_t frame);
+
+/**
+ * @brief   Hàm bật / tắt đo độ trễ
+ * @details Khi tắt, mẫu đang đo bị hủy (không tính là bỏ qua) và không bắt đầu mẫu mới.
+ * @param   enable  1: bật (tay cầm điều khiển động cơ), 0: tắt
+ * @return  void
+ **/
+void Latency_Probe_Enable(uint8_t enable);
+
+/**
+ * @brief   Hàm đặt chế độ hiện tại để phân loại các mẫu
+ * @param   mode    Chế độ (0 - LATENCY_MODES - 1)
+ * @return  void
+ **/
+void Latency_Probe_SetMode(uint8_t mode);
+
+/**
+ * @brief   Hàm đọc thống kê độ trễ của một chế độ
+ * @param   mode    Chế độ (0 - LATENCY_MODES - 1)
+ * @return  const Latency_ModeStats*    Con trỏ đến thống kê, NULL nếu mode không hợp lệ
+ **/
+const Latency_ModeStats *Latency_Probe_GetStats(uint8_t mode);
+
+/**
+ * @brief   Hàm đọc số mẫu bị bỏ qua (đang đo mẫu khác) hoặc bị hủy (quá thời gian)
+ * @param   void
+ * @return  uint32_t    Số mẫu
+ **/
+uint32_t Latency_Probe_Missed(void);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
@@ -0,0 +1,129 @@
+/*********************************************************************************************************************
+ * @file    line_adc.h
+ * @brief   Thư viện đọc cảm biến line dạng analog bằng ADC quét + DMA vòng
+ * @details ADC quét LINE_ADC_CHANNELS kênh (rank 1 ... 5 = LINE1 ... LINE5, cấu hình trong CubeMX),
+ *          DMA ghi vòng vào bộ đệm LINE_ADC_SCANS lượt quét, không cần ngắt mỗi lượt;
+ *          chương trình lấy trung bình bộ đệm khi cần đọc.
+ *          Module chỉ chạy khi LINE_ADC_ENABLE = 1: mảng cảm biến analog phải nối vào các chân ADC
+ *          (PB12 - PB15 / PC7 của mảng số không phải ngõ vào ADC) và hadc1 đã được cấu hình trong CubeMX;
+ *          khi tắt, LineAdc_Start không đụng đến ADC và LineAdc_Calibrated luôn trả về 0 (chỉ dùng cảm biến số).
+ *          Nếu định nghĩa LINE_ADC_TIM, ADC được kích bằng TRGO của Timer đó với tần số LINE_ADC_RATE_HZ;
+ *          nếu không, ADC quét liên tục với thời gian lấy mẫu dài. ADC chỉ kích được bằng TIM1 / 2 / 3 / 4 / 5 / 8,
+ *          hiện đều đã có chủ (TIM1 động cơ, TIM2 / TIM4 HCSR05, TIM3 Servo, TIM5 nguồn thời gian, TIM8 PS2)
+ *          nên LINE_ADC_TIM để trống; LineAdc_Start từ chối nếu Timer được chọn đang chạy.
+ *          Hiệu chỉnh ghi min / max từng cảm biến khi xe quét qua line, sau đó giá trị được chuẩn hóa
+ *          về 0 - 1000 (1000: đúng trên line) và vị trí line được nội suy bằng trọng tâm số nguyên,
+ *          cùng đơn vị với Line_Position (1/1000 bước cảm biến, trái dương).
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __LINE_ADC_H__
+#define __LINE_ADC_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "main.h"                       //**< Thư viện chứa các định nghĩa GPIO và hàm HAL >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define LINE_ADC_ENABLE         0       //**< 1: đã nối mảng analog vào các chân ADC và cấu hình hadc1 >**/
+#define LINE_ADC_HANDLE         hadc1   //**< Handle ADC quét 5 kênh, DMA vòng, dữ liệu 16 bit  >**/
+// #define LINE_ADC_TIM         htimX   //**< Timer rảnh kích ADC bằng TRGO (không dùng Timer đã có chủ) >**/
+#define LINE_ADC_RATE_HZ        2000    //**< Tần số quét khi kích bằng Timer (Hz)              >**/
+
+#define LINE_ADC_CHANNELS       5       //**< Số kênh (LINE1 ... LINE5)                         >**/
+#define LINE_ADC_SCANS          8       //**< Số lượt quét trong bộ đệm DMA (lấy trung bình)    >**/
+#define LINE_ADC_LINE_HIGH      1       //**< 1: giá trị ADC tăng khi cảm biến ở trên line      >**/
+#define LINE_ADC_CAL_MIN_SPAN   200     //**< Chênh lệch min / max tối thiểu để hiệu chỉnh hợp lệ >**/
+#define LINE_ADC_NOISE          150     //**< Giá trị chuẩn hóa dưới mức này coi là nền (0 - 1000) >**/
+#define LINE_ADC_FOUND          500     //**< Có cảm biến vượt mức này thì coi là thấy line     >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+#if LINE_ADC_ENABLE
+extern ADC_HandleTypeDef LINE_ADC_HANDLE;       //**< Handle ADC sử dụng cho cảm biến line >**/
+#endif
+
+/**
+ * @brief   Kết quả hiệu chỉnh của các cảm biến
+ **/
+typedef struct {
+    uint16_t min[LINE_ADC_CHANNELS];    //**< Giá trị nhỏ nhất đã gặp   >**/
+    uint16_t max[LINE_ADC_CHANNELS];    //**< Giá trị lớn nhất đã gặp   >**/
+    uint8_t  valid;                     //**< 1: mọi kênh đủ chênh lệch >**/
+} LineAdc_Calibration;
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm bắt đầu quét ADC bằng DMA vòng
+ * @param   void
+ * @return  HAL_StatusTypeDef   HAL_OK nếu thành công, HAL_ERROR nếu module đang tắt (LINE_ADC_ENABLE = 0),
+ *                              HAL_BUSY nếu LINE_ADC_TIM đang được module khác sử dụng
+ **/
+HAL_StatusTypeDef LineAdc_Start(void);
+
+/**
+ * @brief   Hàm dừng quét ADC
+ * @param   void
+ * @return  void
+ **/
+void LineAdc_Stop(void);
+
+/**
+ * @brief   Hàm đọc giá trị thô trung bình của các kênh
+ * @param   raw     Mảng LINE_ADC_CHANNELS phần tử (LINE1 ... LINE5)
+ * @return  void
+ **/
+void LineAdc_Read(uint16_t *raw);
+
+/**
+ * @brief   Hàm bắt đầu hiệu chỉnh (xóa min / max)
+ * @param   void
+ * @return  void
+ **/
+void LineAdc_CalibrateStart(void);
+
+/**
+ * @brief   Hàm cập nhật min / max từ giá trị hiện tại, gọi thường xuyên khi xe quét qua line
+ * @param   void
+ * @return  void
+ **/
+void LineAdc_CalibrateUpdate(void);
+
+/**
+ * @brief   Hàm kết thúc hiệu chỉnh
+ * @param   void
+ * @return  uint8_t     1 nếu mọi kênh đủ chênh lệch (đã thấy cả nền và line), 0 nếu chưa
+ **/
+uint8_t LineAdc_CalibrateFinish(void);
+
+/**
+ * @brief   Hàm kiểm tra đã có hiệu chỉnh hợp lệ
+ * @param   void
+ * @return  uint8_t     1 nếu đã hiệu chỉnh, 0 nếu chưa
+ **/
+uint8_t LineAdc_Calibrated(void);
+
+/**
+ * @brief   Hàm đọc kết quả hiệu chỉnh
+ * @param   calibration     Nơi lưu kết quả
+ * @return  void
+ **/
+void LineAdc_GetCalibration(LineAdc_Calibration *calibration);
+
+/**
+ * @brief   Hàm chuẩn hóa giá trị thô theo hiệu chỉnh
+ * @param   raw     Giá trị thô (LINE_ADC_CHANNELS phần tử)
+ * @param   norm    Nơi lưu giá trị chuẩn hóa 0 - 1000 (1000: trên line)
+ * @return  void
+ **/
+void LineAdc_Normalize(const uint16_t *raw, uint16_t *norm);
+
+/**
+ * @brief   Hàm tính vị trí line nội suy từ giá trị analog
+ * @param   found   Nơi lưu 1 nếu thấy line, 0 nếu không
+ * @return  int16_t     Vị trí (1/1000 bước cảm biến, trái dương), 0 nếu không thấy line
+ **/
+int16_t LineAdc_Position(uint8_t *found);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
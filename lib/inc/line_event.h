@@ -0,0 +1,130 @@
+/*********************************************************************************************************************
+ * @file    line_event.h
+ * @brief   Thư viện lọc cảm biến line và nhận dạng ngã rẽ, ngã ba, ngã tư
+ * @details Trong ngắt Timer riêng (LINE_EVENT_TIM, không dùng chung nhịp polling PS2 nên PS2_Poll_SetRate /
+ *          PS2_Poll_Stop không ảnh hưởng), mỗi cảm biến được dịch 1 bit vào lịch sử 32 bit riêng;
+ *          cảm biến chỉ đổi trạng thái khi LINE_EVENT_DEBOUNCE mẫu gần nhất giống nhau (chống nhiễu).
+ *          Vòng lặp chính phân loại mẫu đã lọc thành đi thẳng, cua, ngã ba (T), ngã tư, hết line, mất line:
+ *          khi cảm biến biên thấy line cùng cảm biến giữa, xe đang qua giao lộ và các nhánh trái / phải
+ *          được ghi lại; khi ra khỏi giao lộ, line còn ở giữa hay không cho biết có nhánh đi thẳng.
+ *          Mỗi lần phân loại thay đổi, 1 sự kiện được đưa vào hàng đợi cho bộ điều khiển.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __LINE_EVENT_H__
+#define __LINE_EVENT_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "detectline.h"                 //**< Thư viện đọc cảm biến line >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define LINE_EVENT_TIM          htim6   //**< Timer lấy mẫu riêng (TIM6, tick 1 us trong CubeMX) >**/
+#define LINE_EVENT_RATE_HZ      1000    //**< Tần số lấy mẫu (Hz), trễ chống nhiễu = DEBOUNCE mẫu >**/
+#define LINE_ACTIVE_LOW         1       //**< 1: cảm biến trả về 0 khi thấy line               >**/
+#define LINE_EVENT_DEBOUNCE     3       //**< Số mẫu giống nhau liên tiếp để đổi trạng thái    >**/
+#define LINE_EVENT_QUEUE_SIZE   8       //**< Kích thước hàng đợi sự kiện (lũy thừa 2)         >**/
+
+#define LINE_MASK_LEFT          0x10    //**< LINE1 (biên trái) trong mẫu thấy line            >**/
+#define LINE_MASK_CENTER        0x0E    //**< LINE2 - LINE4                                    >**/
+#define LINE_MASK_MIDDLE        0x04    //**< LINE3                                            >**/
+#define LINE_MASK_RIGHT         0x01    //**< LINE5 (biên phải)                                >**/
+
+#define LINE_ARM_LEFT           0x01    //**< Giao lộ có nhánh trái                            >**/
+#define LINE_ARM_STRAIGHT       0x02    //**< Giao lộ có nhánh đi thẳng                        >**/
+#define LINE_ARM_RIGHT          0x04    //**< Giao lộ có nhánh phải                            >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+extern TIM_HandleTypeDef LINE_EVENT_TIM;        //**< Handle Timer lấy mẫu cảm biến line >**/
+
+/**
+ * @brief   Loại sự kiện line
+ **/
+typedef enum {
+    LINE_EVENT_STRAIGHT   = 0,          //**< Line ở giữa                                   >**/
+    LINE_EVENT_CURVE      = 1,          //**< Line lệch về biên / góc cua (arms: phía cua)  >**/
+    LINE_EVENT_T_JUNCTION = 2,          //**< Ngã ba (arms: 2 nhánh)                        >**/
+    LINE_EVENT_CROSS      = 3,          //**< Ngã tư                                        >**/
+    LINE_EVENT_END        = 4,          //**< Hết line khi đang đi thẳng                    >**/
+    LINE_EVENT_LOST       = 5           //**< Mất line khi đang cua / lệch                  >**/
+} Line_EventType;
+
+/**
+ * @brief   Một sự kiện line
+ **/
+typedef struct {
+    uint8_t  type;                      //**< Loại sự kiện (Line_EventType)         >**/
+    uint8_t  arms;                      //**< Các nhánh (LINE_ARM_...)              >**/
+    uint8_t  onLine;                    //**< Mẫu đã lọc, bit = 1: thấy line (LINE1 = bit 4) >**/
+    uint32_t timeMs;                    //**< Thời điểm phát sinh (ms)              >**/
+} Line_Event;
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm khởi tạo bộ lọc và hàng đợi sự kiện
+ * @details Gọi được khi Timer lấy mẫu đang chạy (đổi mảng cảm biến): lịch sử được xóa trong vùng tắt ngắt.
+ * @param   void
+ * @return  void
+ **/
+void Line_Event_Init(void);
+
+/**
+ * @brief   Hàm bắt đầu lấy mẫu theo ngắt Timer với tần số LINE_EVENT_RATE_HZ
+ * @note    Gọi sau Line_Event_Init và detect_Line_Init.
+ * @param   void
+ * @return  HAL_StatusTypeDef   HAL_OK nếu thành công
+ **/
+HAL_StatusTypeDef Line_Event_Start(void);
+
+/**
+ * @brief   Hàm đưa 1 mẫu vào lịch sử và cập nhật trạng thái đã lọc (gọi trong ngắt)
+ * @param   pattern Mẫu 5 bit của detect_Line_Read
+ * @return  void
+ **/
+void Line_Event_Sample(uint8_t pattern);
+
+/**
+ * @brief   Hàm xử lý ngắt update của Timer lấy mẫu, gọi trong HAL_TIM_PeriodElapsedCallback
+ * @param   htim    Handle Timer phát sinh ngắt
+ * @return  void
+ **/
+void Line_Event_TimerHandler(TIM_HandleTypeDef *htim);
+
+/**
+ * @brief   Hàm phân loại mẫu đã lọc và tạo sự kiện, gọi thường xuyên trong vòng lặp chính
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+void Line_Event_Update(uint32_t nowMs);
+
+/**
+ * @brief   Hàm lấy sự kiện tiếp theo trong hàng đợi
+ * @param   event   Nơi lưu sự kiện
+ * @return  uint8_t     1 nếu có sự kiện, 0 nếu hàng đợi trống
+ **/
+uint8_t Line_Event_Get(Line_Event *event);
+
+/**
+ * @brief   Hàm đọc mẫu đã lọc theo định dạng của detect_Line_Read
+ * @param   void
+ * @return  uint8_t     Mẫu 5 bit (LINE1 = bit 4 ... LINE5 = bit 0)
+ **/
+uint8_t Line_Event_Pattern(void);
+
+/**
+ * @brief   Hàm kiểm tra xe đang đi qua giao lộ
+ * @param   void
+ * @return  uint8_t     1 nếu cảm biến biên đang thấy nhánh ngang, 0 nếu không
+ **/
+uint8_t Line_Event_InJunction(void);
+
+/**
+ * @brief   Hàm đọc số sự kiện bị mất do hàng đợi đầy
+ * @param   void
+ * @return  uint32_t    Số sự kiện bị mất
+ **/
+uint32_t Line_Event_Dropped(void);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
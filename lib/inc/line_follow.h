@@ -0,0 +1,200 @@
+/*********************************************************************************************************************
+ * @file    line_follow.h
+ * @brief   Thư viện dò line liên tục bằng bộ điều khiển PID
+ * @details Vị trí line được tính bằng trọng tâm có trọng số của các cảm biến đang thấy line
+ *          (LINE1 ... LINE5 ở vị trí +2 ... -2 bước cảm biến, trái dương), đơn vị 1/1000 bước.
+ *          Khi mất line, vị trí được giữ ở LINE_LOST_ERROR theo phía thấy line cuối cùng để xe quay về line.
+ *          Mỗi LINE_CONTROL_MS, PID trên sai số vị trí cho ra lệnh quay và một phần đi ngang (Mecanum),
+ *          tốc độ tiến giảm theo độ lệch; lệnh được gửi liên tục bằng carMoveVector, không dừng xe giữa các mẫu.
+ *          Sau khi hiệu chỉnh cảm biến analog (xe quay qua lại trên line), vị trí được nội suy từ ADC
+ *          (line_adc) thay cho 5 mức của cảm biến số. Cảm biến số được lọc và phân loại bởi line_event;
+ *          khi đang qua giao lộ, xe giữ hướng thẳng thay vì bám theo nhánh ngang.
+ *          Tốc độ tiến được lập lịch theo độ cong ước lượng từ LINE_CURVE_WINDOW chu kỳ gần nhất:
+ *          đầu ra PID trung bình (đang cua đều) và độ trôi của sai số (line bắt đầu lệch: sắp vào cua).
+ *          Đường thẳng chạy đến tốc độ cơ bản, cua gắt giảm về LINE_SPEED_CURVE; tốc độ thực tăng / giảm
+ *          theo giới hạn gia tốc LINE_ACCEL / LINE_DECEL. Lịch tốc độ được ghi vào bộ đệm vòng để chỉnh thông số,
+ *          Line_Log_Dump trong vòng lặp chính gửi nhật ký ra qua Line_Log_Write (mặc định ITM / SWO).
+ *          Xe Mecanum đi lùi dọc line bằng mảng cảm biến sau: Line_SetDirection chọn mảng theo chiều đi,
+ *          mọi tính toán giữ trong hệ tọa độ chiều đi, chỉ vx, vy đổi dấu khi gửi cho xe (omega giữ nguyên).
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __LINE_FOLLOW_H__
+#define __LINE_FOLLOW_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "line_event.h"                 //**< Thư viện lọc cảm biến line và sự kiện giao lộ >**/
+#include "line_adc.h"                   //**< Thư viện cảm biến line analog >**/
+#include "line_route.h"                 //**< Thư viện chạy lộ trình theo giao lộ >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define LINE_SENSORS            5       //**< Số cảm biến line                              >**/
+#define LINE_PITCH              1000    //**< 1 bước cảm biến theo đơn vị sai số            >**/
+#define LINE_LOST_ERROR         3000    //**< Sai số khi mất line (ngoài cảm biến biên)     >**/
+
+#define LINE_CONTROL_MS         10      //**< Chu kỳ điều khiển (ms)                        >**/
+#define LINE_RESUME_MS          100     //**< Lâu hơn giá trị này không gọi thì khởi động lại PID >**/
+#define LINE_KP                 12      //**< Hệ số P (% / 1000 đơn vị sai số)              >**/
+#define LINE_KI                 1       //**< Hệ số I (% / 1000 đơn vị sai số x chu kỳ / 16) >**/
+#define LINE_KD                 20      //**< Hệ số D (% / 1000 đơn vị sai số / chu kỳ)     >**/
+#define LINE_INTEGRAL_MAX       160000  //**< Giới hạn tích phân (chống bão hòa, 10 %)      >**/
+#define LINE_OUTPUT_MAX         60      //**< Giới hạn đầu ra PID (%)                       >**/
+#define LINE_STRAFE_PERCENT     30      //**< Phần đầu ra PID dùng để đi ngang (%)          >**/
+
+#define LINE_SPEED_BASE         60      //**< Tốc độ tiến trên đường thẳng (%)              >**/
+#define LINE_SPEED_CURVE        30      //**< Tốc độ tiến ở độ cong lớn nhất (%)            >**/
+#define LINE_SPEED_MIN          15      //**< Tốc độ tiến nhỏ nhất khi còn thấy line (%)    >**/
+#define LINE_SLOW_GAIN          8       //**< Giảm tốc độ tiến (% / 1000 đơn vị sai số)     >**/
+#define LINE_ACCEL              80      //**< Giới hạn tăng tốc (% / s)                     >**/
+#define LINE_DECEL              300     //**< Giới hạn giảm tốc (% / s)                     >**/
+#define LINE_CURVE_WINDOW       16      //**< Số chu kỳ ước lượng độ cong (lũy thừa 2)      >**/
+#define LINE_CURVE_DRIFT        2000    //**< Độ trôi sai số trong cửa sổ ứng với độ cong lớn nhất >**/
+#define LINE_LOG_SIZE           128     //**< Số mục nhật ký lịch tốc độ (lũy thừa 2)       >**/
+#define LINE_LOG_DIVIDER        4       //**< Ghi nhật ký mỗi LINE_LOG_DIVIDER chu kỳ       >**/
+#define LINE_LOG_DUMP_MAX       2       //**< Số mục gửi ra tối đa mỗi lần gọi Line_Log_Dump >**/
+#define LINE_SEARCH_SPEED       35      //**< Tốc độ quay tìm line khi mất line (%)         >**/
+#define LINE_SWITCH_CYCLES      3       //**< Số chu kỳ đứng yên chờ lọc mảng cảm biến mới  >**/
+
+#define LINE_CAL_SPEED          30      //**< Tốc độ quay khi hiệu chỉnh (%)                >**/
+#define LINE_CAL_SWEEP_MS       400     //**< Thời gian quay mỗi chiều khi hiệu chỉnh (ms)  >**/
+#define LINE_CAL_SWEEPS         5       //**< Số lần quay hết quãng (lẻ), thêm 2 nửa quãng đầu / cuối >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Trạng thái bộ dò line sau chu kỳ điều khiển gần nhất
+ **/
+typedef struct {
+    uint8_t pattern;                    //**< Mẫu 5 bit đã đọc (LINE1 = bit 4)      >**/
+    uint8_t found;                      //**< 1: có cảm biến thấy line              >**/
+    uint8_t analog;                     //**< 1: vị trí lấy từ cảm biến analog      >**/
+    uint8_t calibrating;                //**< 1: đang quay hiệu chỉnh               >**/
+    uint8_t event;                      //**< Loại sự kiện line gần nhất (Line_EventType) >**/
+    uint16_t junctions;                 //**< Số giao lộ (ngã ba, ngã tư) đã đi qua >**/
+    int16_t error;                      //**< Vị trí line (1/1000 bước, trái dương) >**/
+    int16_t output;                     //**< Đầu ra PID (%)                        >**/
+    int8_t  direction;                  //**< Chiều đi (1: tiến, mảng trước; -1: lùi, mảng sau) >**/
+    int16_t vx;                         //**< Lệnh sang ngang theo chiều đi (%, phải dương) >**/
+    int16_t vy;                         //**< Lệnh tiến theo chiều đi (%)           >**/
+    int16_t omega;                      //**< Lệnh quay (%, trái dương)             >**/
+    int16_t curvature;                  //**< Độ cong ước lượng (0 - 1000)          >**/
+    int16_t target;                     //**< Tốc độ tiến theo lịch (%)             >**/
+} Line_State;
+
+/**
+ * @brief   Một mục nhật ký lịch tốc độ
+ **/
+typedef struct {
+    uint32_t timeMs;                    //**< Thời điểm (ms)                        >**/
+    int16_t  error;                     //**< Vị trí line (1/1000 bước)             >**/
+    int16_t  output;                    //**< Đầu ra PID (%)                        >**/
+    int16_t  curvature;                 //**< Độ cong ước lượng (0 - 1000)          >**/
+    int16_t  target;                    //**< Tốc độ theo lịch (%)                  >**/
+    int16_t  speed;                     //**< Tốc độ sau giới hạn gia tốc (1/10 %)  >**/
+} Line_LogEntry;
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm khởi tạo bộ dò line (xóa tích phân và bộ nhớ mất line)
+ * @param   void
+ * @return  void
+ **/
+void Line_Init(void);
+
+/**
+ * @brief   Hàm đặt tốc độ tiến cơ bản
+ * @param   speed   Tốc độ khi đúng giữa line (0 - 100 %)
+ * @return  void
+ **/
+void Line_SetSpeed(int16_t speed);
+
+/**
+ * @brief   Hàm đặt chiều đi dọc line
+ * @details Chọn mảng cảm biến phục vụ chiều đi, xóa bộ lọc / PID và đứng yên LINE_SWITCH_CYCLES chu kỳ
+ *          để mảng mới qua bộ chống nhiễu, sau đó đi tiếp theo chiều mới mà không cần quay 180°.
+ *          Khi lùi chỉ dùng cảm biến số (hiệu chỉnh analog thuộc mảng trước).
+ * @param   direction   1: tiến (mảng trước), -1: lùi (mảng sau)
+ * @return  void
+ **/
+void Line_SetDirection(int8_t direction);
+
+/**
+ * @brief   Hàm đọc chiều đi dọc line
+ * @param   void
+ * @return  int8_t      1: tiến, -1: lùi
+ **/
+int8_t Line_GetDirection(void);
+
+/**
+ * @brief   Hàm bắt đầu hiệu chỉnh cảm biến analog
+ * @details Xe đặt trên line, Line_Update quay xe qua lại LINE_CAL_SWEEPS lần để mọi cảm biến
+ *          đi qua cả line và nền, sau đó dừng xe và dùng vị trí analog nếu hiệu chỉnh hợp lệ.
+ *          Bỏ qua khi LINE_ADC_ENABLE = 0.
+ * @param   void
+ * @return  void
+ **/
+void Line_StartCalibration(void);
+
+/**
+ * @brief   Hàm tính vị trí line từ mẫu cảm biến
+ * @param   pattern Mẫu 5 bit (LINE1 = bit 4 ... LINE5 = bit 0)
+ * @param   found   Nơi lưu 1 nếu có cảm biến thấy line, 0 nếu không
+ * @return  int16_t     Vị trí trọng tâm (1/1000 bước, trái dương), 0 nếu không thấy line
+ **/
+int16_t Line_Position(uint8_t pattern, uint8_t *found);
+
+/**
+ * @brief   Hàm dò line, gọi thường xuyên trong vòng lặp chính ở chế độ LINE
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  uint8_t     1 nếu đến chu kỳ điều khiển và lệnh đã được gửi, 0 nếu chưa
+ **/
+uint8_t Line_Update(uint32_t nowMs);
+
+/**
+ * @brief   Hàm đọc trạng thái của chu kỳ điều khiển gần nhất
+ * @param   state   Nơi lưu trạng thái
+ * @return  void
+ **/
+void Line_GetState(Line_State *state);
+
+/**
+ * @brief   Hàm lấy mục nhật ký lịch tốc độ cũ nhất
+ * @details Bộ đệm đầy thì mục cũ nhất bị ghi đè, nên luôn giữ LINE_LOG_SIZE mục gần nhất
+ *          (có thể đọc trực tiếp bằng debugger sau 1 vòng chạy thử).
+ *          Dùng chung vị trí đọc với Line_Log_Dump: mỗi mục chỉ được lấy ra 1 lần.
+ * @param   entry   Nơi lưu mục nhật ký
+ * @return  uint8_t     1 nếu có mục, 0 nếu nhật ký trống
+ **/
+uint8_t Line_Log_Get(Line_LogEntry *entry);
+
+/**
+ * @brief   Hàm đọc số mục nhật ký bị ghi đè trước khi được đọc
+ * @param   void
+ * @return  uint32_t    Số mục bị ghi đè
+ **/
+uint32_t Line_Log_Overwritten(void);
+
+/**
+ * @brief   Hàm gửi nhật ký lịch tốc độ ra ngoài, gọi trong vòng lặp chính ở chế độ LINE
+ * @details Mỗi lần gọi gửi tối đa LINE_LOG_DUMP_MAX mục cũ nhất qua Line_Log_Write (nhật ký ghi 1 mục
+ *          mỗi LINE_LOG_DIVIDER x LINE_CONTROL_MS nên vòng lặp chính đọc kịp). Mục chỉ bị lấy khỏi nhật ký
+ *          khi Line_Log_Write nhận, nên khi chưa có đầu ra nhật ký vẫn giữ LINE_LOG_SIZE mục gần nhất.
+ * @param   void
+ * @return  uint8_t     Số mục đã gửi
+ **/
+uint8_t Line_Log_Dump(void);
+
+/**
+ * @brief   Hàm gửi 1 mục nhật ký (debug hook, định nghĩa lại trong ứng dụng để đổi đầu ra)
+ * @details Mặc định (__weak) gửi 1 dòng CSV "timeMs,error,output,curvature,target,speed" qua ITM kênh 0
+ *          (SWO: SWV ITM Data Console của CubeIDE hoặc openocd itm port 0), chỉ khi debugger đã bật ITM;
+ *          không có debugger thì trả về 0 ngay. Định nghĩa lại (ví dụ gửi qua UART) phải không chặn lâu,
+ *          trả về 0 khi đầu ra đang bận để mục được gửi lại lần sau.
+ * @param   entry   Mục nhật ký
+ * @return  uint8_t     1 nếu đã gửi, 0 nếu đầu ra chưa sẵn sàng
+ **/
+uint8_t Line_Log_Write(const Line_LogEntry *entry);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
@@ -0,0 +1,111 @@
+/*********************************************************************************************************************
+ * @file    line_route.h
+ * @brief   Thư viện chạy lộ trình theo số giao lộ khi dò line
+ * @details Lộ trình là chuỗi ký tự hằng (nằm trong flash), mỗi ký tự là hành động tại 1 giao lộ đếm được
+ *          (ngã ba hoặc ngã tư): 'S' đi thẳng, 'L' rẽ trái, 'R' rẽ phải, 'U' quay đầu, 'X' dừng (kết thúc),
+ *          'B' đổi chiều đi ngay tại chỗ (dùng mảng cảm biến line còn lại, không quay 180°).
+ *          Mỗi hành động rẽ dùng 1 thao tác tính sẵn: tiến thêm để tâm xe vào giữa giao lộ,
+ *          quay tại chỗ ít nhất minTurnMs để rời line cũ, rồi quay tiếp đến khi cảm biến giữa bắt được nhánh mới.
+ *          Lõi không dùng HAL (chỉ nhận mẫu line đã lọc, sự kiện giao lộ và thời gian),
+ *          nên có thể biên dịch và chạy trên máy tính với bản đồ đường mô phỏng.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __LINE_ROUTE_H__
+#define __LINE_ROUTE_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include <stdint.h>                     //**< Thư viện sử dụng kiểu dữ liệu uint >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define ROUTE_ADVANCE_SPEED     30      //**< Tốc độ tiến vào giữa giao lộ (%)              >**/
+#define ROUTE_ADVANCE_MS        180     //**< Thời gian tiến từ cảm biến đến tâm xe (ms)    >**/
+#define ROUTE_TURN_SPEED        40      //**< Tốc độ quay tại chỗ (%)                       >**/
+#define ROUTE_TURN_MIN_MS       250     //**< Quay tối thiểu để rời line cũ (ms)            >**/
+#define ROUTE_UTURN_MIN_MS      700     //**< Quay đầu tối thiểu (ms)                       >**/
+#define ROUTE_TURN_MAX_MS       2500    //**< Quá thời gian chưa bắt được line: lỗi         >**/
+
+#define ROUTE_ARM_LEFT          0x01    //**< Giống LINE_ARM_LEFT                           >**/
+#define ROUTE_ARM_STRAIGHT      0x02    //**< Giống LINE_ARM_STRAIGHT                       >**/
+#define ROUTE_ARM_RIGHT         0x04    //**< Giống LINE_ARM_RIGHT                          >**/
+#define ROUTE_MASK_MIDDLE       0x04    //**< Cảm biến giữa trong mẫu thấy line (LINE3)     >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Lộ trình (đặt const để nằm trong flash)
+ **/
+typedef struct {
+    const char *name;                   //**< Tên hiển thị                          >**/
+    const char *steps;                  //**< Chuỗi hành động, ví dụ "LSRX"         >**/
+} Route_Program;
+
+/**
+ * @brief   Trạng thái chạy lộ trình
+ **/
+typedef enum {
+    ROUTE_IDLE    = 0,                  //**< Không chạy lộ trình, chỉ dò line      >**/
+    ROUTE_FOLLOW  = 1,                  //**< Dò line, chờ giao lộ tiếp theo        >**/
+    ROUTE_ADVANCE = 2,                  //**< Tiến vào giữa giao lộ                 >**/
+    ROUTE_TURN    = 3,                  //**< Quay tìm nhánh mới                    >**/
+    ROUTE_DONE    = 4,                  //**< Đã dừng ở bước 'X' hoặc hết lộ trình  >**/
+    ROUTE_FAILED  = 5                   //**< Giao lộ không có nhánh cần đi / quay quá lâu >**/
+} Route_State;
+
+/**
+ * @brief   Tiến độ lộ trình
+ **/
+typedef struct {
+    const char *name;                   //**< Tên lộ trình                          >**/
+    uint8_t state;                      //**< Trạng thái (Route_State)              >**/
+    uint8_t step;                       //**< Số giao lộ đã xử lý                   >**/
+    uint8_t total;                      //**< Số bước của lộ trình                  >**/
+    char    action;                     //**< Hành động đang / sắp thực hiện        >**/
+    uint8_t arms;                       //**< Các nhánh của giao lộ gần nhất        >**/
+} Route_Progress;
+
+/**
+ * @brief   Lệnh chuyển động khi lộ trình điều khiển xe (thay cho bộ dò line)
+ **/
+typedef struct {
+    int16_t vx;                         //**< Sang phải dương (%)   >**/
+    int16_t vy;                         //**< Tiến lên dương (%)    >**/
+    int16_t omega;                      //**< Quay trái dương (%)   >**/
+    uint8_t reverse;                    //**< 1: đổi chiều đi (bước 'B') >**/
+} Route_Command;
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm bắt đầu chạy lộ trình
+ * @param   program     Lộ trình, NULL để dừng chạy lộ trình (chỉ dò line)
+ * @return  void
+ **/
+void Route_Start(const Route_Program *program);
+
+/**
+ * @brief   Hàm báo xe vừa đi qua 1 giao lộ (sự kiện ngã ba / ngã tư)
+ * @param   arms    Các nhánh của giao lộ (ROUTE_ARM_...)
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+void Route_OnJunction(uint8_t arms, uint32_t nowMs);
+
+/**
+ * @brief   Hàm cập nhật thao tác, gọi mỗi chu kỳ điều khiển
+ * @param   onLine  Mẫu đã lọc, bit = 1: thấy line (LINE1 = bit 4)
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @param   command Nơi lưu lệnh chuyển động khi lộ trình điều khiển xe
+ * @return  uint8_t     1 nếu lộ trình điều khiển xe (dùng command), 0 nếu để bộ dò line điều khiển
+ **/
+uint8_t Route_Update(uint8_t onLine, uint32_t nowMs, Route_Command *command);
+
+/**
+ * @brief   Hàm đọc tiến độ lộ trình
+ * @param   progress    Nơi lưu tiến độ
+ * @return  void
+ **/
+void Route_GetProgress(Route_Progress *progress);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
@@ -218,6 +218,31 @@ void DirControlMotorUpdate(void);
 void carMove(int16_t angle, int16_t power, int8_t rot, uint8_t drift);
 
 
+/**
+ * @brief   Hàm điều khiển xe theo vector vận tốc
+ * @details Hàm này trộn vận tốc tịnh tiến và vận tốc quay cho 4 bánh Mecanum bằng số nguyên:
+ *          [0] = vy + vx - omega, [1] = vy - vx + omega, [2] = vy + vx + omega, [3] = vy - vx - omega.
+ *          Nếu bánh lớn nhất vượt 100 %, cả 4 bánh được chia tỉ lệ để giữ nguyên hướng chuyển động.
+ * @param   vx      Vận tốc sang ngang (-100 - 100 %, sang phải dương)
+ * @param   vy      Vận tốc tiến lùi (-100 - 100 %, tiến lên dương)
+ * @param   omega   Vận tốc quay (-100 - 100 %, quay trái dương)
+ * @return  void
+ **/
+void carMoveVector(int16_t vx, int16_t vy, int16_t omega);
+
+
+/**
+ * @brief   Hàm đọc vector vận tốc đã ra lệnh gần nhất
+ * @details Hàm này suy ngược vector từ công suất 4 bánh của lần gọi carSetMotors gần nhất,
+ *          dùng để ước lượng vị trí xe (odometry theo lệnh) khi không có encoder.
+ * @param   vx      Nơi lưu vận tốc sang ngang (%, sang phải dương)
+ * @param   vy      Nơi lưu vận tốc tiến lùi (%, tiến lên dương)
+ * @param   omega   Nơi lưu vận tốc quay (%, quay trái dương)
+ * @return  void
+ **/
+void carGetVector(int16_t *vx, int16_t *vy, int16_t *omega);
+
+
 /**
  * @brief   Hàm điều khiển xe theo hướng góc và tốc độ
  * @details Hàm này sẽ điều khiển động cơ Mecanum dựa trên các tham số đầu vào,
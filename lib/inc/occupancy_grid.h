@@ -0,0 +1,136 @@
+/*********************************************************************************************************************
+ * @file    occupancy_grid.h
+ * @brief   Thư viện bản đồ chiếm chỗ cục bộ quanh xe
+ * @details Bản đồ lưới GRID_SIZE x GRID_SIZE ô, mỗi ô GRID_CELL_MM, lưu log-odds dạng int8 (1 KB SRAM).
+ *          Bản đồ cuộn theo xe: khi xe lệch khỏi tâm quá GRID_RECENTER_CELLS ô, gốc bản đồ dịch theo
+ *          và chỉ các hàng / cột mới được xóa (chỉ số ô lấy theo modulo, không sao chép dữ liệu).
+ *          Vị trí xe ước lượng từ vector vận tốc đã ra lệnh (không có encoder) bằng số nguyên và bảng sin.
+ *          Mỗi mẫu siêu âm được chiếu tia Bresenham từ xe: các ô trên tia giảm log-odds (trống),
+ *          ô cuối tăng log-odds (vật cản). Tia chỉ xét trục cảm biến, bỏ qua độ rộng búp sóng.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __OCCUPANCY_GRID_H__
+#define __OCCUPANCY_GRID_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include <stdint.h>                     //**< Thư viện sử dụng kiểu dữ liệu uint >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define GRID_SIZE               32      //**< Số ô mỗi chiều (lũy thừa 2)                   >**/
+#define GRID_CELL_MM            100     //**< Kích thước 1 ô (mm)                           >**/
+#define GRID_RECENTER_CELLS     4       //**< Lệch tâm quá số ô này thì cuộn bản đồ         >**/
+
+#define GRID_LOGODDS_HIT        48      //**< Cộng vào ô có vật cản (1 lần đo đủ vượt ngưỡng) >**/
+#define GRID_LOGODDS_FREE       (-6)    //**< Cộng vào ô tia đi qua                         >**/
+#define GRID_LOGODDS_LIMIT      120     //**< Giới hạn log-odds (-LIMIT - LIMIT)            >**/
+#define GRID_OCCUPIED           40      //**< Log-odds lớn hơn giá trị này: có vật cản      >**/
+#define GRID_RAY_MAX_MM         1500    //**< Tầm tin cậy của tia, xa hơn chỉ đánh dấu trống >**/
+
+#define GRID_SPEED_MM_S         500     //**< Vận tốc tịnh tiến tại 100 % (mm/s), cần hiệu chỉnh >**/
+#define GRID_TURN_DEG_S         180     //**< Vận tốc quay tại 100 % (độ/s), cần hiệu chỉnh      >**/
+#define GRID_ODOM_MAX_DT_MS     200     //**< Giới hạn bước tích phân (ms)                  >**/
+
+#define GRID_BEARING_FRONT      0       //**< Hướng cảm biến so với xe (độ, trái dương)     >**/
+#define GRID_BEARING_LEFT       90
+#define GRID_BEARING_REAR       180
+#define GRID_BEARING_RIGHT      (-90)
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Vị trí xe trong hệ tọa độ bản đồ (gốc tại vị trí khởi tạo, hướng 0 là hướng ban đầu của xe)
+ **/
+typedef struct {
+    int32_t xMm;                        //**< Tọa độ x (mm), trục x theo hướng 0    >**/
+    int32_t yMm;                        //**< Tọa độ y (mm), trục y bên trái hướng 0 >**/
+    int16_t headingDeg;                 //**< Hướng xe (0 - 359 độ, quay trái dương) >**/
+} Grid_Pose;
+
+/**
+ * @brief   Hàm callback duyệt các ô có vật cản
+ * @param   dxMm        Độ lệch x từ xe đến tâm ô (mm)
+ * @param   dyMm        Độ lệch y từ xe đến tâm ô (mm)
+ * @param   logOdds     Log-odds của ô (> 0)
+ **/
+typedef void (*Grid_CellVisitor)(int32_t dxMm, int32_t dyMm, int8_t logOdds);
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm xóa bản đồ và đặt xe về gốc tọa độ
+ * @param   void
+ * @return  void
+ **/
+void Grid_Init(void);
+
+/**
+ * @brief   Hàm cập nhật vị trí xe từ vector vận tốc đã ra lệnh
+ * @details Tích phân vận tốc từ lần gọi trước (tối đa GRID_ODOM_MAX_DT_MS), cuộn bản đồ nếu cần.
+ * @param   vx      Vận tốc sang ngang (-100 - 100 %, sang phải dương)
+ * @param   vy      Vận tốc tiến lùi (-100 - 100 %, tiến lên dương)
+ * @param   omega   Vận tốc quay (-100 - 100 %, quay trái dương)
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+void Grid_Odometry(int16_t vx, int16_t vy, int16_t omega, uint32_t nowMs);
+
+/**
+ * @brief   Hàm cập nhật bản đồ từ 1 mẫu khoảng cách
+ * @param   bearingDeg  Hướng cảm biến so với đầu xe (độ, trái dương)
+ * @param   distanceMm  Khoảng cách đo được (mm)
+ * @param   valid       1: có vật cản tại distanceMm, 0: ngoài tầm (chỉ đánh dấu trống)
+ * @return  void
+ **/
+void Grid_AddRange(int16_t bearingDeg, uint16_t distanceMm, uint8_t valid);
+
+/**
+ * @brief   Hàm tính khoảng trống theo 1 hướng
+ * @param   bearingDeg  Hướng so với đầu xe (độ, trái dương)
+ * @return  uint16_t    Khoảng cách đến ô có vật cản đầu tiên (mm), tối đa GRID_RAY_MAX_MM
+ **/
+uint16_t Grid_Clearance(int16_t bearingDeg);
+
+/**
+ * @brief   Hàm tìm hướng có khoảng trống lớn nhất
+ * @details Khi bằng nhau, ưu tiên hướng gần đầu xe hơn.
+ * @param   fromDeg     Hướng bắt đầu (độ, trái dương)
+ * @param   toDeg       Hướng kết thúc (độ, >= fromDeg)
+ * @param   stepDeg     Bước góc (độ, > 0)
+ * @param   clearanceMm Nơi lưu khoảng trống của hướng tìm được, NULL nếu không cần
+ * @return  int16_t     Hướng có khoảng trống lớn nhất (độ)
+ **/
+int16_t Grid_BestDirection(int16_t fromDeg, int16_t toDeg, uint8_t stepDeg, uint16_t *clearanceMm);
+
+/**
+ * @brief   Hàm duyệt các ô có log-odds > 0 trong bán kính quanh xe
+ * @param   radiusMm    Bán kính (mm)
+ * @param   visitor     Hàm được gọi với mỗi ô
+ * @return  void
+ **/
+void Grid_ForEachOccupied(uint16_t radiusMm, Grid_CellVisitor visitor);
+
+/**
+ * @brief   Hàm đọc vị trí xe hiện tại
+ * @param   pose    Nơi lưu vị trí
+ * @return  void
+ **/
+void Grid_GetPose(Grid_Pose *pose);
+
+/**
+ * @brief   Hàm đọc log-odds của ô chứa 1 điểm
+ * @param   xMm     Tọa độ x (mm)
+ * @param   yMm     Tọa độ y (mm)
+ * @return  int8_t  Log-odds (> 0: có vật cản, < 0: trống), 0 nếu điểm nằm ngoài bản đồ
+ **/
+int8_t Grid_CellAt(int32_t xMm, int32_t yMm);
+
+/**
+ * @brief   Hàm tra sin theo độ bằng bảng
+ * @param   deg     Góc (độ, bất kỳ)
+ * @return  int16_t sin x 16384
+ **/
+int16_t Grid_Sin(int16_t deg);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
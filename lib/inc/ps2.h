@@ -13,19 +13,41 @@
 #define PS2_CONTROLLER_H
 
 /* ============================================[ INCLUDE FILE ]============================================*/
-#include <stdlib.h>                     //**< Thư viện chuẩn sử dụng hàm malloc >**/
 #include <stdint.h>                     //**< Thư viện sử dụng kiểu dữ liệu uint >**/
 #include "main.h"                       //**< Thư viện chứa các định nghĩa GPIO và hàm HAL >**/
+#include "timebase.h"                   //**< Thư viện nguồn thời gian micro giây >**/
 
 /* ============================================[ MACRO DEFINITIONS ]==========================================*/
-#define PS2_CS_PORT 	GPIOC           //**< GPIO - CS - SPI - PORT >**/
-#define PS2_CS_PIN 		GPIO_PIN_4      //**< GPIO - CS - SPI - PIN  >**/
+#define PS2_CS_PORT 	GPIOC           //**< GPIO - CS - SPI - PORT (tay cầm lái xe)         >**/
+#define PS2_CS_PIN 		GPIO_PIN_4      //**< GPIO - CS - SPI - PIN  (tay cầm lái xe)         >**/
+#define PS2_CS2_PORT 	GPIOC           //**< GPIO - CS - SPI - PORT (tay cầm người vận hành) >**/
+#define PS2_CS2_PIN 	GPIO_PIN_5      //**< GPIO - CS - SPI - PIN  (tay cầm người vận hành) >**/
 
-#define CS_LOW 		HAL_GPIO_WritePin(PS2_CS_PORT, PS2_CS_PIN, GPIO_PIN_RESET)      //**< CS LOW  >**/
-#define CS_HIGH 	HAL_GPIO_WritePin(PS2_CS_PORT, PS2_CS_PIN, GPIO_PIN_SET)        //**< CS HIGH >**/
+#define PS2_CS_LOW(driver)  HAL_GPIO_WritePin((driver)->csPort, (driver)->csPin, GPIO_PIN_RESET)   //**< CS LOW  >**/
+#define PS2_CS_HIGH(driver) HAL_GPIO_WritePin((driver)->csPort, (driver)->csPin, GPIO_PIN_SET)     //**< CS HIGH >**/
+
+#define PS2_MAX_CONTROLLERS 2           //**< Số tay cầm tối đa dùng chung Timer tạo nhịp và DMA >**/
 
 #define PS2_SPI_HANDLE  hspi1           //**< Handle SPI sử dụng cho PS2        >**/ 
 #define PS2_TIM_COUNTER htim12          //**< Handle Timer sử dụng cho delay    >**/ 
+#define PS2_TIM_PACER   htim8           //**< Timer tạo nhịp byte cho SPI DMA (TIM8_UP - DMA2, cùng bus với SPI1) >**/
+
+#define PS2_TIM_POLL    htim7           //**< Timer tạo nhịp polling nền (tick 1 us)                              >**/
+#define PS2_POLL_RATE_HZ    200         //**< Tần số polling nền mặc định (Hz) >**/
+#define PS2_POLL_PERIOD_MAX_US  65536UL //**< Chu kỳ dài nhất của Timer 16 bit tick 1 us (~15.3 Hz) >**/
+
+#define PS2_BYTE_PERIOD_US  50          //**< Chu kỳ giữa 2 byte: ~32us truyền byte (250kHz) + khoảng nghỉ >**/
+#define PS2_FRAME_MAX       21          //**< Kích thước khung dữ liệu lớn nhất (byte) >**/
+#define PS2_FRAME_ANALOG    9           //**< Kích thước khung analog 0x73 (byte)       >**/
+
+#define PS2_FEATURE_RUMBLE      0x01    //**< Bật 2 động cơ rung (lệnh 0x4D)                    >**/
+#define PS2_FEATURE_PRESSURE    0x02    //**< Bật khung 21 byte có áp lực nút (lệnh 0x4F)       >**/
+#define PS2_FEATURE_LATENCY     0x04    //**< Đo độ trễ đến động cơ (chỉ tay cầm lái xe)         >**/
+
+#define PS2_RUMBLE_LARGE_MIN    0x40    //**< Giá trị nhỏ nhất để động cơ rung lớn quay được    >**/
+
+#define PS2_LINK_DEADLINE_US        100000  //**< Mặc định: mất tín hiệu quá thời gian này thì dừng xe (us) >**/
+#define PS2_LINK_REINIT_INTERVAL_US 500000  //**< Khoảng cách tối thiểu giữa 2 lần khởi tạo lại (us)        >**/
 
 /*
  * Last 6 bytes from 0x42 response (Analog Mode):
@@ -68,6 +90,21 @@
 #define PSB_LX          0xFF            //**< BYTE 07         >**/ 
 #define PSB_LY          0x00FF          //**< BYTE 08         >**/ 
 
+// Vị trí áp lực nút trong pressure[] (BYTE 09 - 20, khung 0x79)
+#define PS2_PRESSURE_COUNT      12      //**< Số nút có áp lực            >**/
+#define PS2_PRESSURE_RIGHT      0       //**< BYTE 09                     >**/
+#define PS2_PRESSURE_LEFT       1       //**< BYTE 10                     >**/
+#define PS2_PRESSURE_UP         2       //**< BYTE 11                     >**/
+#define PS2_PRESSURE_DOWN       3       //**< BYTE 12                     >**/
+#define PS2_PRESSURE_TRIANGLE   4       //**< BYTE 13                     >**/
+#define PS2_PRESSURE_CIRCLE     5       //**< BYTE 14                     >**/
+#define PS2_PRESSURE_CROSS      6       //**< BYTE 15                     >**/
+#define PS2_PRESSURE_SQUARE     7       //**< BYTE 16                     >**/
+#define PS2_PRESSURE_L1         8       //**< BYTE 17                     >**/
+#define PS2_PRESSURE_R1         9       //**< BYTE 18                     >**/
+#define PS2_PRESSURE_L2         10      //**< BYTE 19                     >**/
+#define PS2_PRESSURE_R2         11      //**< BYTE 20                     >**/
+
 
 /* =============================================[ TYPE DEFINITIONS ]==========================================*/
 /**
@@ -95,6 +132,7 @@ typedef union {
         uint8_t RY;
         uint8_t LX;
         uint8_t LY;
+        uint8_t pressure[PS2_PRESSURE_COUNT];   //**< Áp lực nút 0x00 - 0xFF (chỉ khung 0x79) >**/
     }button;
 	struct{
         uint16_t buttonData;
@@ -103,94 +141,240 @@ typedef union {
     }data;	
 }PS2;
 
+/**
+ * @brief   Ảnh chụp trạng thái PS2 được công bố bởi tác vụ polling nền
+ **/
+typedef struct {
+    PS2      state;                     //**< Trạng thái nút và joystick đã giải mã     >**/
+    uint8_t  mode;                      //**< Chế độ tay cầm (2: áp lực, 1: analog, 0: digital) >**/
+    uint32_t timestampUs;               //**< Thời điểm nhận xong khung (us)            >**/
+    uint32_t frame;                     //**< Số thứ tự khung đã công bố                >**/
+} PS2_Snapshot;
+
+/**
+ * @brief   Thống kê chất lượng liên kết với tay cầm
+ * @details Được cập nhật trong ngắt DMA sau mỗi khung polling.
+ **/
+typedef struct {
+    uint32_t validFrames;               //**< Số khung có ID hợp lệ (0x41, 0x73, 0x79)  >**/
+    uint32_t badIds;                    //**< Số khung có ID không hợp lệ               >**/
+    uint32_t consecutiveMisses;         //**< Số khung lỗi liên tiếp gần nhất           >**/
+    uint32_t lastGoodUs;                //**< Thời điểm nhận khung hợp lệ gần nhất (us) >**/
+    uint32_t reinits;                   //**< Số lần tự động khởi tạo lại               >**/
+    uint8_t  expectedId;                //**< ID sau khi cấu hình (0: chưa cấu hình được) >**/
+} PS2_LinkStats;
+
+typedef struct PS2_Driver PS2_Driver;
+
+/**
+ * @brief   Hàm callback khi một khung SPI DMA hoàn thành
+ * @note    Được gọi trong ngắt DMA, phản hồi nằm trong driver->response.
+ **/
+typedef void (*PS2_TransferCallback)(PS2_Driver *driver, uint8_t length);
+
+/**
+ * @brief   Đối tượng điều khiển một tay cầm PS2
+ * @details Mỗi tay cầm có handle SPI, chân CS, bộ đệm phản hồi, trạng thái đã giải mã
+ *          và bộ đệm kép ảnh chụp riêng. Đối tượng được cấp phát tĩnh bởi chương trình gọi,
+ *          không dùng bộ nhớ động.
+ **/
+struct PS2_Driver {
+    SPI_HandleTypeDef  *hspi;                       //**< Handle SPI của tay cầm                >**/
+    GPIO_TypeDef       *csPort;                     //**< Port chân CS                          >**/
+    uint16_t            csPin;                      //**< Chân CS                               >**/
+    uint8_t             features;                   //**< PS2_FEATURE_... đã yêu cầu khi khởi tạo >**/
+    uint8_t             command[PS2_FRAME_MAX];     //**< Khung polling (byte 3, 4: động cơ rung) >**/
+    uint8_t             response[PS2_FRAME_MAX];    //**< Bộ đệm nhận phản hồi                  >**/
+    uint8_t             frameLength;                //**< Số byte polling theo chế độ hiện tại  >**/
+    PS2                 state;                      //**< Trạng thái nút bấm đã giải mã         >**/
+    uint8_t             mode;                       //**< Chế độ tay cầm (2: áp lực, 1: analog, 0: digital) >**/
+    uint32_t            frameStartUs;               //**< Thời điểm bắt đầu khung hiện tại (us) >**/
+    uint32_t            frameUs;                    //**< Thời gian khung gần nhất (us)         >**/
+    uint32_t            frameMaxUs;                 //**< Thời gian khung lớn nhất (us)         >**/
+    PS2_LinkStats       link;                       //**< Thống kê liên kết                     >**/
+    volatile uint8_t    reinitPending;              //**< Cờ yêu cầu khởi tạo lại (đặt trong ngắt) >**/
+    uint32_t            reinitUs;                   //**< Thời điểm khởi tạo lại gần nhất (us)  >**/
+    volatile uint8_t    configStep;                 //**< Khung cấu hình tiếp theo + 1 (0: polling bình thường) >**/
+    PS2_Snapshot        snapshot[2];                //**< Bộ đệm kép ảnh chụp trạng thái        >**/
+    volatile uint8_t    snapshotIndex;              //**< Bộ đệm đang được công bố              >**/
+    volatile uint32_t   snapshotSeq;                //**< Số thứ tự seqlock (lẻ: đang ghi)      >**/
+};
+
 extern SPI_HandleTypeDef PS2_SPI_HANDLE;            //**< Handle SPI sử dụng cho PS2            >**/ 
 extern TIM_HandleTypeDef PS2_TIM_COUNTER;           //**< Handle Timer sử dụng cho delay        >**/
+extern TIM_HandleTypeDef PS2_TIM_PACER;             //**< Handle Timer tạo nhịp byte cho DMA    >**/
+extern TIM_HandleTypeDef PS2_TIM_POLL;              //**< Handle Timer tạo nhịp polling nền     >**/
 
-uint8_t ps2_response[9] ={0x00};                    //**< Mảng toàn cục để lưu dữ liệu PS2      >**/
 
-PS2 *ps2 = NULL;                                    //**< Lưu trữ trạng thái toàn bộ nút bấm    >**/
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm khởi tạo động cơ Mecanum
+ * @details Hàm này sẽ khởi tạo các thông số cần thiết cho động cơ Mecanum,
+ *          bao gồm việc cấu hình GPIO và Timer cho các động cơ.
+ * @param   void
+ * @return  void
+ **/
+void delay_us(uint16_t us);
 
-uint8_t PS2_MODE;                                   //**< Lưu trữ chế độ của tay cầm PS2        >**/
 
+/**
+ * @brief   Hàm khởi tạo giao tiếp PS2
+ * @details Hàm này sẽ gán SPI / CS cho tay cầm, truyền các lệnh setup và cấu hình chế độ PS2
+ *          0x42 (READ_DATA) -> 0X43 (ENTER_CONFIG_MODE) -> 0X44 (ANALOG_MODE)
+ *          [-> 0x4D (ENABLE_RUMBLE)] [-> 0x4F (SET_BYTES_LARGE)] -> 0X43 (EXIT_CONFIG_MODE),
+ *          sau đó đăng ký tay cầm vào danh sách polling nền.
+ *          Với PS2_FEATURE_PRESSURE, tay cầm trả về khung 0x79 dài 21 byte (thêm 12 byte áp lực nút),
+ *          thời gian mỗi khung tăng từ ~(9 + 1) lên ~(21 + 1) x PS2_BYTE_PERIOD_US.
+ * @note    Các tay cầm dùng chung bus SPI phải có chân CS riêng.
+ * @param   driver      Đối tượng tay cầm (cấp phát tĩnh)
+ * @param   hspi        Handle SPI nối với tay cầm
+ * @param   csPort      Port chân CS
+ * @param   csPin       Chân CS
+ * @param   features    PS2_FEATURE_RUMBLE | PS2_FEATURE_PRESSURE | PS2_FEATURE_LATENCY, 0 để chỉ dùng analog
+ * @return  HAL_StatusTypeDef   HAL_OK, HAL_ERROR nếu đã đủ PS2_MAX_CONTROLLERS tay cầm
+ **/
+HAL_StatusTypeDef PS2_Init(PS2_Driver *driver, SPI_HandleTypeDef *hspi, GPIO_TypeDef *csPort, uint16_t csPin, uint8_t features);
 
-/*
- * NON-CONFIG MODE
- */
-/* Main polling command */
-uint8_t main_polling_42[9] = { 0x01, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 
-/* Exit Config Mode */
-uint8_t exit_config_43[9] = { 0x01, 0x43, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A };
+/**
+ * @brief   Hàm đặt mức rung của tay cầm
+ * @details Giá trị được ghi vào byte 3, 4 của khung polling và có hiệu lực từ khung tiếp theo.
+ * @note    Cần khởi tạo với PS2_FEATURE_RUMBLE.
+ * @param   driver  Đối tượng tay cầm
+ * @param   small   Động cơ nhỏ (0: tắt, khác 0: bật)
+ * @param   large   Động cơ lớn (0: tắt, 1 - 255: tốc độ, được đưa về PS2_RUMBLE_LARGE_MIN - 0xFF)
+ * @return  void
+ **/
+void PS2_SetRumble(PS2_Driver *driver, uint8_t small, uint8_t large);
 
-/*
- * CONFIG MODE RESPONSES
- */
-/* Find out what buttons are included in poll responses. */
- uint8_t find_polling_41[9] = { 0x01, 0x41, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A };
 
-/* Enter Config Mode, */
- uint8_t enter_config_43[9] = { 0x01, 0x43, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 };
+/**
+ * @brief   Hàm đọc trạng thái của các nút bấm
+ * @details Hàm này sẽ xử lý data trạng thái nút bấm được PS2 trả về trong driver->response,
+ *          sau đó lưu trạng thái nút vào driver->state
+ * @param   driver  Đối tượng tay cầm
+ * @return  void
+ **/
+void PS2_ButtonPressed(PS2_Driver *driver);
+
 
-/* Switch modes between digital and analog */
- uint8_t switch_mode_44[9] = { 0x01, 0x44, 0x00, 0x01, 0x03, 0x00, 0x00, 0x00, 0x00 };
+/**
+ * @brief   Hàm bắt đầu truyền một khung lệnh PS2 bằng SPI DMA
+ * @details Hàm này kéo CS của tay cầm xuống, cấu hình DMA nhận của SPI và DMA của Timer PS2_TIM_PACER:
+ *          mỗi sự kiện update của Timer ghi 1 byte lệnh vào SPI->DR, tạo khoảng nghỉ giữa các byte
+ *          mà CPU không phải chờ. Khi nhận đủ length byte vào driver->response,
+ *          CS được kéo lên và callback được gọi.
+ * @note    Cần cấu hình trong CubeMX: DMA SPI1_RX và DMA TIM8_UP (Memory To Peripheral, byte),
+ *          Timer PS2_TIM_PACER có tick 1 us.
+ *          Timer tạo nhịp dùng chung nên tại mỗi thời điểm chỉ có 1 khung của 1 tay cầm.
+ *          Bộ đệm command phải tồn tại đến khi callback được gọi.
+ * @param   driver      Đối tượng tay cầm
+ * @param   command     Khung lệnh cần gửi
+ * @param   length      Số byte của khung (tối đa PS2_FRAME_MAX)
+ * @param   callback    Hàm gọi khi hoàn thành (có thể NULL)
+ * @return  HAL_StatusTypeDef   HAL_OK nếu đã bắt đầu, HAL_BUSY nếu khung trước chưa xong
+ **/
+HAL_StatusTypeDef PS2_Transfer_Start(PS2_Driver *driver, const uint8_t *command, uint8_t length, PS2_TransferCallback callback);
 
-/* Get more status info */
- uint8_t read_more_info_45[9] = { 0x01, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 
-/* Read an unknown constant value from controller */
- uint8_t type_read_46[2][9] = {{ 0x01, 0x46, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A },
-								{ 0x01, 0x46, 0x00, 0x01, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A }};
+/**
+ * @brief   Hàm kiểm tra có khung SPI DMA đang truyền hay không
+ * @param   void
+ * @return  uint8_t     1 nếu đang truyền
+ **/
+uint8_t PS2_Transfer_Busy(void);
 
-/* Read an unknown constant value from controller */
- uint8_t type_read_47[9] = { 0x01, 0x47, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A };
 
-/* Read an unknown constant value from controller */
- uint8_t type_read_4c[2][9] = {{ 0x01, 0x4C, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A },
-								{ 0x01, 0x4C, 0x00, 0x01, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A }};
+/**
+ * @brief   Hàm hủy khung SPI DMA đang truyền
+ * @details Dừng Timer tạo nhịp, hủy 2 kênh DMA và kéo CS lên, không gọi callback.
+ * @param   void
+ * @return  void
+ **/
+void PS2_Transfer_Abort(void);
 
- uint8_t enable_rumble_4d[9] = { 0x01, 0x4D, 0x00, 0x00, 0x01, 0xFF, 0xFF, 0xFF, 0xFF };
 
- uint8_t set_bytes_large_4f[9] = { 0x01, 0x4F, 0x00, 0xFF, 0xFF, 0x03, 0x00, 0x00, 0x00 };
+/**
+ * @brief   Hàm bắt đầu polling PS2 nền theo Timer
+ * @details Mỗi chu kỳ của Timer PS2_TIM_POLL, ngắt sẽ khởi động khung polling SPI DMA của tay cầm đầu tiên;
+ *          khi khung hoàn thành, trạng thái được giải mã, công bố vào bộ đệm kép của tay cầm đó
+ *          và khung của tay cầm tiếp theo được khởi động ngay trong callback (polling lần lượt).
+ * @note    Gọi sau PS2_Init. Vòng lặp chính chỉ đọc trạng thái bằng PS2_Poll_Read.
+ * @param   rateHz  Tần số polling (Hz), 0 để dùng PS2_POLL_RATE_HZ
+ * @return  void
+ **/
+void PS2_Poll_Start(uint16_t rateHz);
 
 
-/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
 /**
- * @brief   Hàm khởi tạo động cơ Mecanum
- * @details Hàm này sẽ khởi tạo các thông số cần thiết cho động cơ Mecanum,
- *          bao gồm việc cấu hình GPIO và Timer cho các động cơ.
+ * @brief   Hàm dừng polling PS2 nền
  * @param   void
  * @return  void
  **/
-void delay_us(uint16_t us);
+void PS2_Poll_Stop(void);
 
 
 /**
- * @brief   Hàm khởi tạo giao tiếp PS2
- * @details Hàm này sẽ truyền các lệnh setup và cấu hình chế độ PS2
- *          0x42 (READ_DATA) -> 0X43 (ENTER_CONFIG_MODE) -> 0X44 (ANALOG_MODE) -> 0X43 (EXIT_CONFIG_MODE)
- * @param   void
+ * @brief   Hàm thay đổi tần số polling PS2 nền
+ * @details Chu kỳ được giới hạn trong [1 lượt polling các tay cầm, PS2_POLL_PERIOD_MAX_US]
+ *          vì PS2_TIM_POLL là Timer 16 bit tick 1 us; tần số thấp hơn ~15.3 Hz được làm tròn lên.
+ * @param   rateHz  Tần số polling (Hz)
  * @return  void
  **/
-void PS2_Init(void);
+void PS2_Poll_SetRate(uint16_t rateHz);
 
 
 /**
- * @brief   Hàm đọc trạng thái của các nút bấm
- * @details Hàm này sẽ xử lý data trạng thái nút bấm được PS2 trả về trong ps2_response,
- *          sau đó lưu trạng thái nút vào ps2
- * @param   void
+ * @brief   Hàm đọc ảnh chụp trạng thái PS2 mới nhất
+ * @details Bộ đệm kép kết hợp số thứ tự (seqlock): ngắt ghi vào bộ đệm không hoạt động rồi đổi chỉ số,
+ *          vòng lặp chính sao chép và thử lại nếu số thứ tự thay đổi trong lúc sao chép.
+ *          Không cần tắt ngắt và ngắt không bao giờ phải chờ vòng lặp chính.
+ * @param   driver      Đối tượng tay cầm
+ * @param   snapshot    Nơi lưu ảnh chụp
+ * @param   ageUs       Tuổi của dữ liệu tính đến lúc đọc (us), có thể NULL
+ * @return  uint8_t     1 nếu đã có ít nhất 1 khung hợp lệ, 0 nếu chưa
+ **/
+uint8_t PS2_Poll_Read(PS2_Driver *driver, PS2_Snapshot *snapshot, uint32_t *ageUs);
+
+
+/**
+ * @brief   Hàm xử lý ngắt Timer polling PS2
+ * @details Gọi trong HAL_TIM_PeriodElapsedCallback; bỏ qua nếu htim không phải PS2_TIM_POLL.
+ *          Nếu khung trước chưa xong, chu kỳ này bị bỏ qua và được đếm vào số lần tràn.
+ * @param   htim    Handle Timer phát sinh ngắt
  * @return  void
  **/
-void PS2_ButtonPressed(void);
+void PS2_Poll_TimerHandler(TIM_HandleTypeDef *htim);
 
 
 /**
- * @brief   Hàm cập nhật trạng thái của PS2
- * @details Hàm này sẽ gửi lệnh để nhận trạng thái của PS2
- *          Sau đó sẽ gọi hàm đọc trạng thái nút để lưu lại
+ * @brief   Hàm kiểm tra liên kết với tay cầm còn hoạt động
+ * @param   driver      Đối tượng tay cầm
+ * @param   deadlineUs  Thời gian tối đa kể từ khung hợp lệ gần nhất (us)
+ * @return  uint8_t     1 nếu đã nhận khung hợp lệ trong deadlineUs, 0 nếu mất tín hiệu
+ **/
+uint8_t PS2_Link_Alive(PS2_Driver *driver, uint32_t deadlineUs);
+
+
+/**
+ * @brief   Hàm phục vụ liên kết PS2, gọi trong vòng lặp chính
+ * @details Khi tay cầm xuất hiện lại (khung hợp lệ có ID khác expectedId, ví dụ 0x41 sau khi
+ *          bộ thu mất nguồn), ngắt chỉ đặt cờ; hàm này bắt đầu chuỗi cấu hình của PS2_Init (giữ nguyên thống kê).
+ *          Chuỗi được gửi bằng SPI DMA, mỗi lượt polling của tay cầm đó 1 khung thay cho khung polling,
+ *          nên vòng lặp chính không bị chặn và các tay cầm khác vẫn được polling.
+ *          Mỗi tay cầm được khởi tạo lại tối đa 1 lần trong PS2_LINK_REINIT_INTERVAL_US.
+ * @note    Cần polling nền đang chạy (PS2_Poll_Start).
  * @param   void
  * @return  void
  **/
-void PS2_Update(void);
+void PS2_Link_Service(void);
+
+
+/**
+ * @brief   Hàm đọc số chu kỳ polling bị bỏ qua vì khung trước chưa xong
+ * @param   void
+ * @return  uint32_t    Số lần tràn
+ **/
+uint32_t PS2_Poll_Overruns(void);
 
 #endif
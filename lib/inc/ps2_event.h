@@ -0,0 +1,92 @@
+/*********************************************************************************************************************
+ * @file    ps2_event.h
+ * @brief   Thư viện tạo sự kiện nút bấm từ trạng thái tay cầm PS2
+ * @details Thư viện so sánh 2 lần đọc buttonData liên tiếp bằng phép toán bit để phát hiện cạnh,
+ *          mỗi nút có một máy trạng thái nhỏ (nhấn, giữ lâu, lặp lại) và các sự kiện
+ *          nhấn / nhả / giữ lâu / lặp lại được đưa vào hàng đợi cho vòng lặp chính xử lý.
+ *          Nhờ đó, mỗi lần nhấn nút chỉ tạo đúng một hành động.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __PS2_EVENT_H__
+#define __PS2_EVENT_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include <stdint.h>                     //**< Thư viện sử dụng kiểu dữ liệu uint >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define PS2_EVENT_BUTTONS           16      //**< Số nút trong buttonData                   >**/
+#define PS2_EVENT_QUEUE_SIZE        16      //**< Kích thước hàng đợi sự kiện (lũy thừa 2)  >**/
+
+#define PS2_EVENT_LONG_PRESS_MS     800     //**< Thời gian giữ để tạo sự kiện giữ lâu      >**/
+#define PS2_EVENT_REPEAT_DELAY_MS   500     //**< Thời gian giữ trước khi bắt đầu lặp lại   >**/
+#define PS2_EVENT_REPEAT_PERIOD_MS  150     //**< Chu kỳ lặp lại khi tiếp tục giữ           >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Loại sự kiện nút bấm
+ **/
+typedef enum {
+    PS2_EVENT_PRESS      = 0,           //**< Nút vừa được nhấn                     >**/
+    PS2_EVENT_RELEASE    = 1,           //**< Nút vừa được nhả                      >**/
+    PS2_EVENT_LONG_PRESS = 2,           //**< Nút được giữ quá longPressMs          >**/
+    PS2_EVENT_REPEAT     = 3            //**< Nút vẫn được giữ (tự động lặp lại)    >**/
+} PS2_EventType;
+
+/**
+ * @brief   Một sự kiện nút bấm
+ **/
+typedef struct {
+    uint16_t mask;                      //**< Bitmask của nút (PSB_...)             >**/
+    uint8_t  type;                      //**< Loại sự kiện (PS2_EventType)          >**/
+    uint8_t  button;                    //**< Vị trí bit của nút (0 - 15)           >**/
+    uint32_t timeMs;                    //**< Thời điểm phát sinh (ms)              >**/
+} PS2_Event;
+
+/**
+ * @brief   Cấu hình thời gian và các nút được phép giữ lâu / lặp lại
+ **/
+typedef struct {
+    uint16_t longPressMs;               //**< Thời gian giữ để tạo LONG_PRESS (ms)  >**/
+    uint16_t repeatDelayMs;             //**< Thời gian giữ trước REPEAT đầu tiên   >**/
+    uint16_t repeatPeriodMs;            //**< Chu kỳ giữa các REPEAT (ms)           >**/
+    uint16_t longPressMask;             //**< Các nút tạo sự kiện LONG_PRESS        >**/
+    uint16_t repeatMask;                //**< Các nút tạo sự kiện REPEAT            >**/
+} PS2_EventConfig;
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm khởi tạo lớp sự kiện nút bấm
+ * @param   config  Cấu hình thời gian, NULL để dùng giá trị mặc định (không nút nào lặp lại)
+ * @return  void
+ **/
+void PS2_Event_Init(const PS2_EventConfig *config);
+
+/**
+ * @brief   Hàm cập nhật trạng thái nút và tạo sự kiện
+ * @details Cạnh nhấn / nhả được tính bằng phép XOR giữa 2 lần đọc liên tiếp;
+ *          chỉ các nút đang giữ mới cần kiểm tra thời gian giữ lâu và lặp lại.
+ * @param   buttonData  Trạng thái 16 nút (bit = 1: đang nhấn), ps2->data.buttonData
+ * @param   nowMs       Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+void PS2_Event_Update(uint16_t buttonData, uint32_t nowMs);
+
+/**
+ * @brief   Hàm lấy sự kiện tiếp theo trong hàng đợi
+ * @param   event   Nơi lưu sự kiện
+ * @return  uint8_t     1 nếu có sự kiện, 0 nếu hàng đợi trống
+ **/
+uint8_t PS2_Event_Get(PS2_Event *event);
+
+/**
+ * @brief   Hàm đọc số sự kiện bị mất do hàng đợi đầy
+ * @param   void
+ * @return  uint32_t    Số sự kiện bị mất
+ **/
+uint32_t PS2_Event_Dropped(void);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
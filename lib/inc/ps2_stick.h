@@ -0,0 +1,80 @@
+/*********************************************************************************************************************
+ * @file    ps2_stick.h
+ * @brief   Thư viện chuyển joystick analog PS2 thành vector chuyển động
+ * @details Joystick trái điều khiển tịnh tiến (vx, vy), joystick phải điều khiển quay (omega).
+ *          Mỗi trục đi qua vùng chết hình tròn và đường cong expo / rate;
+ *          đường cong được tính sẵn vào bảng 256 phần tử khi khởi tạo,
+ *          nên mỗi lần polling chỉ cần tra bảng, không tính số thực.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __PS2_STICK_H__
+#define __PS2_STICK_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include <stdint.h>                     //**< Thư viện sử dụng kiểu dữ liệu uint >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define PS2_STICK_CENTER        128     //**< Giá trị joystick ở vị trí giữa            >**/
+#define PS2_STICK_OUTPUT_MAX    100     //**< Giá trị đầu ra lớn nhất (%)               >**/
+
+#define PS2_STICK_DEADZONE      16      //**< Bán kính vùng chết mặc định (0 - 127)     >**/
+#define PS2_STICK_MOVE_EXPO     40      //**< Expo mặc định của tịnh tiến (0 - 100 %)   >**/
+#define PS2_STICK_MOVE_RATE     100     //**< Rate mặc định của tịnh tiến (0 - 100 %)   >**/
+#define PS2_STICK_TURN_EXPO     60      //**< Expo mặc định của quay (0 - 100 %)        >**/
+#define PS2_STICK_TURN_RATE     70      //**< Rate mặc định của quay (0 - 100 %)        >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Thông số đường cong của một joystick
+ * @details out = rate * ((1 - expo) * t + expo * t^3), với t là độ lệch chuẩn hóa (-1 - 1).
+ **/
+typedef struct {
+    uint8_t deadzone;                   //**< Bán kính vùng chết (0 - 127)          >**/
+    uint8_t expo;                       //**< Độ cong expo (0: tuyến tính - 100 %)  >**/
+    uint8_t rate;                       //**< Giá trị lớn nhất (0 - 100 %)          >**/
+} PS2_StickCurve;
+
+/**
+ * @brief   Cấu hình 2 joystick
+ **/
+typedef struct {
+    PS2_StickCurve move;                //**< Joystick trái: tịnh tiến              >**/
+    PS2_StickCurve turn;                //**< Joystick phải: quay                   >**/
+} PS2_StickConfig;
+
+/**
+ * @brief   Vector chuyển động (-100 - 100 %)
+ **/
+typedef struct {
+    int8_t vx;                          //**< Sang phải dương                       >**/
+    int8_t vy;                          //**< Tiến lên dương                        >**/
+    int8_t omega;                       //**< Quay trái dương                       >**/
+} PS2_StickCommand;
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm khởi tạo và tính bảng đường cong joystick
+ * @note    Số thực chỉ được dùng ở đây; gọi lại khi thay đổi cấu hình.
+ * @param   config  Cấu hình đường cong, NULL để dùng giá trị mặc định
+ * @return  void
+ **/
+void PS2_Stick_Init(const PS2_StickConfig *config);
+
+/**
+ * @brief   Hàm chuyển giá trị joystick thô thành vector chuyển động
+ * @details Vùng chết của joystick trái là hình tròn (x^2 + y^2 <= deadzone^2), tránh trôi xe khi joystick
+ *          không về đúng tâm theo cả 2 trục; ngoài vùng chết, vector được co theo bán kính nên
+ *          đầu ra tăng từ 0 tại biên vùng chết theo mọi hướng.
+ * @param   lx      Joystick trái, trục X (0x00: trái - 0xFF: phải)
+ * @param   ly      Joystick trái, trục Y (0x00: lên - 0xFF: xuống)
+ * @param   rx      Joystick phải, trục X (0x00: trái - 0xFF: phải)
+ * @param   command Nơi lưu vector chuyển động
+ * @return  uint8_t     1 nếu có ít nhất 1 thành phần khác 0
+ **/
+uint8_t PS2_Stick_Map(uint8_t lx, uint8_t ly, uint8_t rx, PS2_StickCommand *command);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
@@ -14,6 +14,9 @@
 *  Servo SG90 
 *   f = 50 Hz, T = 20ms
 *   xung PWM 0.5 ms -> 2.5 ms tương ứng 0 - 180 độ
+*   Dịch vụ không chặn: Servo_SetTarget đặt góc đích, Servo_Service (vòng lặp chính) giới hạn tốc độ lệnh
+*   nếu có và ước lượng vị trí trục theo SERVO_SPEED_DEG_S; Servo ổn định khi vị trí ước lượng tới đích
+*   thêm SERVO_SETTLE_MARGIN_MS, nên thời gian chờ tỉ lệ với góc quay thay vì cố định.
 **/ 
 
 /* ============================================[ INCLUDE FILE ]============================================*/
@@ -32,13 +35,21 @@
 #define SERVO_FRONT         ServoTurn(90)               //**< Servo hướng phía trước        >**/
 #define SERVO_RIGHT         ServoTurn(0)                //**< Servo quay phải               >**/
 
-#define	SERVO_DELAY_TIME_MS	100                         //**< Thời gian delay ms            >**/
+#define SERVO_SPEED_DEG_S   500                         //**< Tốc độ quay của Servo (SG90: 0.1 s / 60 độ, trừ hao tải) >**/
+#define SERVO_SETTLE_MARGIN_MS  40                      //**< Thời gian dập dao động sau khi tới (>= 1 chu kỳ PWM) >**/
+#define SERVO_SLEW_DEG_S    0                           //**< Giới hạn tốc độ lệnh mặc định (0: không giới hạn) >**/
 #define	SERVO_TIM_HANDLE    htim3                       //**< Handle Timer sử dụng tạo xung >**/
 #define	SERVO_TIM_CHANNEL   TIM_CHANNEL_1               //**< Kênh sử dụng cho servo        >**/
 
 /* =============================================[ TYPE DEFINITIONS ]==========================================*/
 extern TIM_HandleTypeDef SERVO_TIM_HANDLE;              //**< Handle Timer sử dụng tạo xung >**/
 
+/**
+ * @brief   Hàm callback khi Servo ổn định tại góc đích (gọi trong Servo_Service)
+ * @param   angle   Góc đích (độ)
+ **/
+typedef void (*Servo_Callback)(uint8_t angle);
+
 /* ============================================[ FUNCTION PROTOTYPES ]========================================*/
 /**
  * @brief   Hàm khởi tạo Servo
@@ -51,12 +62,72 @@ void PWM_Servo_Start(void);
 
 /**
  * @brief   Hàm điểu khiển góc quay Servo
- * @details Hàm này sẽ điểu khiển góc quay Servo bằng dutyCycle
+ * @details Hàm này đặt góc đích và chờ (chặn) đến khi Servo ổn định, thời gian chờ theo góc quay
  * @param   angle	Góc muốn xuay ( tính theo độ )
  * @return  void
  **/
 void ServoTurn(uint8_t angle);
 
+
+/**
+ * @brief   Hàm đặt góc đích không chờ
+ * @details Không giới hạn tốc độ: ghi dutyCycle ngay. Có giới hạn: Servo_Service tiến dần lệnh về đích.
+ *          Mỗi lần gọi, callback được gọi 1 lần khi Servo ổn định (kể cả khi đã ở sẵn góc đích).
+ * @param   angle	Góc đích (0 - 180 độ)
+ * @return  void
+ **/
+void Servo_SetTarget(uint8_t angle);
+
+
+/**
+ * @brief   Hàm đặt giới hạn tốc độ lệnh
+ * @param   degPerS Tốc độ lệnh tối đa (độ / s), 0: không giới hạn
+ * @return  void
+ **/
+void Servo_SetSlew(uint16_t degPerS);
+
+
+/**
+ * @brief   Hàm đăng ký callback khi Servo ổn định
+ * @param   callback    Hàm callback, NULL để hủy
+ * @return  void
+ **/
+void Servo_OnSettled(Servo_Callback callback);
+
+
+/**
+ * @brief   Hàm cập nhật lệnh và vị trí ước lượng, gọi thường xuyên trong vòng lặp chính
+ * @param   void
+ * @return  void
+ **/
+void Servo_Service(void);
+
+
+/**
+ * @brief   Hàm kiểm tra Servo đã ổn định tại góc đích
+ * @param   void
+ * @return  uint8_t     1 nếu đã ổn định, 0 nếu đang quay
+ **/
+uint8_t Servo_IsSettled(void);
+
+
+/**
+ * @brief   Hàm ước lượng thời gian còn lại đến khi ổn định
+ * @param   void
+ * @return  uint32_t    Thời gian (ms), 0 nếu đã ổn định
+ **/
+uint32_t Servo_SettleRemainingMs(void);
+
+
+/**
+ * @brief   Hàm đặt góc Servo không chờ
+ * @details Hàm này chỉ ghi dutyCycle, không chờ Servo quay xong;
+ *          chương trình tự chờ thời gian ổn định trước khi dùng vị trí mới.
+ * @param   angle	Góc muốn xuay ( tính theo độ )
+ * @return  void
+ **/
+void ServoWrite(uint8_t angle);
+
 #endif
 
 
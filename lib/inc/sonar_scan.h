@@ -0,0 +1,133 @@
+/*********************************************************************************************************************
+ * @file    sonar_scan.h
+ * @brief   Thư viện quét khoảng cách bằng Servo và cảm biến siêu âm
+ * @details Dịch vụ quét chạy nền trong vòng lặp chính, không dùng HAL_Delay:
+ *          Servo lần lượt quay tới từng góc trong bộ góc cấu hình, chờ Servo báo ổn định
+ *          (thời gian chờ theo góc quay của từng bước, xem servo.h),
+ *          sau đó lấy mẫu Echo đầu tiên được phát sau thời điểm ổn định của cảm biến gắn trên Servo.
+ *          Mỗi bước đo xong được báo ngay qua callback (góc, khoảng cách, mẫu gốc) để đưa vào bản đồ
+ *          theo vị trí xe tại thời điểm đo; kết quả cả lượt là mảng khoảng cách theo góc (polar),
+ *          được công bố khi quét xong 1 lượt.
+ *          Quét 1 lần: sau lượt quét Servo quay về phía trước và chờ 1 mẫu mới trước khi kết thúc.
+ *          Quét liên tục: Servo quét qua lại (không quay về đầu), mỗi lượt công bố 1 kết quả.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __SONAR_SCAN_H__
+#define __SONAR_SCAN_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "HCSR05.h"                     //**< Thư viện cảm biến siêu âm HCSR05 >**/
+#include "servo.h"                      //**< Thư viện điều khiển Servo >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define SCAN_MAX_ANGLES         16      //**< Số góc tối đa của 1 lượt quét             >**/
+#define SCAN_ANGLE_LEFT         180     //**< Góc Servo hướng bên trái                  >**/
+#define SCAN_ANGLE_FRONT        90      //**< Góc Servo hướng phía trước (vị trí nghỉ)  >**/
+#define SCAN_ANGLE_RIGHT        0       //**< Góc Servo hướng bên phải                  >**/
+
+#define SCAN_SAMPLE_TIMEOUT_MS  250     //**< Không có mẫu sau thời gian này: ngoài tầm >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Khoảng cách đo tại 1 góc
+ **/
+typedef struct {
+    uint8_t  angle;                     //**< Góc Servo (độ)                            >**/
+    uint8_t  valid;                     //**< 1: có vật cản trong tầm                   >**/
+    uint16_t distanceMm;                //**< Khoảng cách chưa lọc (mm), HCSR05_MAX_RANGE_MM nếu ngoài tầm >**/
+    uint32_t timeMs;                    //**< Thời điểm lấy mẫu (ms)                    >**/
+} Scan_Point;
+
+/**
+ * @brief   Kết quả 1 lượt quét, points[i] tương ứng góc thứ i của bộ góc
+ **/
+typedef struct {
+    Scan_Point points[SCAN_MAX_ANGLES]; //**< Khoảng cách theo góc                      >**/
+    uint8_t    count;                   //**< Số góc                                    >**/
+    uint32_t   durationMs;              //**< Thời gian của lượt quét (ms)              >**/
+    uint32_t   sequence;                //**< Số thứ tự lượt quét (0: chưa có)          >**/
+} Scan_Polar;
+
+/**
+ * @brief   Callback báo 1 bước quét vừa đo xong (gọi trong Scan_Service)
+ * @param   point   Kết quả của bước (góc, khoảng cách, thời điểm)
+ * @param   sample  Mẫu HCSR05 của bước, NULL nếu hết thời gian chờ mà không có mẫu
+ * @return  void
+ **/
+typedef void (*Scan_StepCallback)(const Scan_Point *point, const HCSR05_Sample *sample);
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm khởi tạo dịch vụ quét
+ * @details Đăng ký nhận mẫu từ HCSR05 và đặt bộ góc mặc định (trái, phải).
+ * @note    Gọi sau HCSR05_Init của cảm biến gắn trên Servo.
+ * @param   sensor  Cảm biến gắn trên Servo
+ * @return  void
+ **/
+void Scan_Init(HCSR05_Sensor *sensor);
+
+/**
+ * @brief   Hàm đăng ký callback nhận kết quả từng bước quét
+ * @details Gồm cả bước đưa Servo về phía trước khi dừng quét.
+ * @param   callback    Hàm callback, NULL để hủy đăng ký
+ * @return  void
+ **/
+void Scan_OnStep(Scan_StepCallback callback);
+
+/**
+ * @brief   Hàm đặt bộ góc quét
+ * @param   angles  Mảng góc theo thứ tự quét (độ)
+ * @param   count   Số góc (1 - SCAN_MAX_ANGLES)
+ * @return  uint8_t     1 nếu thành công, 0 nếu count không hợp lệ hoặc đang quét
+ **/
+uint8_t Scan_SetAngles(const uint8_t *angles, uint8_t count);
+
+/**
+ * @brief   Hàm bắt đầu quét
+ * @param   continuous  0: quét 1 lượt rồi quay về phía trước, 1: quét qua lại liên tục
+ * @return  void
+ **/
+void Scan_Start(uint8_t continuous);
+
+/**
+ * @brief   Hàm dừng quét và đưa Servo về phía trước
+ * @details Lượt quét đang dở bị bỏ; Scan_Busy trả về 1 cho đến khi Servo đã về và có mẫu mới.
+ * @param   void
+ * @return  void
+ **/
+void Scan_Stop(void);
+
+/**
+ * @brief   Hàm kiểm tra dịch vụ quét đang chạy
+ * @param   void
+ * @return  uint8_t     1 nếu Servo chưa về vị trí nghỉ hoặc chưa có mẫu mới ở vị trí nghỉ
+ **/
+uint8_t Scan_Busy(void);
+
+/**
+ * @brief   Hàm xử lý dịch vụ quét, gọi thường xuyên trong vòng lặp chính (sau HCSR05_update và Servo_Service)
+ * @param   void
+ * @return  void
+ **/
+void Scan_Service(void);
+
+/**
+ * @brief   Hàm đọc kết quả lượt quét hoàn chỉnh gần nhất
+ * @param   polar   Nơi lưu kết quả
+ * @return  uint8_t     1 nếu đã có ít nhất 1 lượt quét, 0 nếu chưa
+ **/
+uint8_t Scan_Read(Scan_Polar *polar);
+
+/**
+ * @brief   Hàm tra khoảng cách tại 1 góc của kết quả quét
+ * @param   polar   Kết quả quét
+ * @param   angle   Góc cần tra (độ)
+ * @return  uint16_t    Khoảng cách (mm), HCSR05_MAX_RANGE_MM nếu góc không có trong lượt quét
+ **/
+uint16_t Scan_DistanceAt(const Scan_Polar *polar, uint8_t angle);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
@@ -0,0 +1,88 @@
+/*********************************************************************************************************************
+ * @file    timebase.h
+ * @brief   Thư viện nguồn thời gian micro giây dùng chung
+ * @details Thư viện cung cấp bộ đếm thời gian micro giây tự do (free-running) và bộ đếm chu kỳ CPU (DWT),
+ *          dùng để đặt deadline, đo thời gian chặn (blocking) và gắn nhãn thời gian cho dữ liệu.
+ *          Khi biên dịch cho máy tính (định nghĩa HOST_SIM), thời gian là đồng hồ ảo
+ *          được điều khiển bởi chương trình mô phỏng.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __TIMEBASE_H__
+#define __TIMEBASE_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include <stdint.h>                     //**< Thư viện sử dụng kiểu dữ liệu uint >**/
+#ifndef HOST_SIM
+#include "main.h"                       //**< Thư viện chứa các định nghĩa GPIO và hàm HAL >**/
+#endif
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define TIMEBASE_TIM_HANDLE     htim5   //**< Timer 32 bit chạy tự do 1 MHz (TIM5 - APB1)  >**/
+
+/**
+ * @brief   Khoảng thời gian đã trôi qua kể từ mốc start (đơn vị giống start)
+ * @note    Phép trừ không dấu xử lý đúng trường hợp bộ đếm tràn.
+ **/
+#define TIMEBASE_ELAPSED(now, start)    ((uint32_t)((uint32_t)(now) - (uint32_t)(start)))
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+#ifndef HOST_SIM
+extern TIM_HandleTypeDef TIMEBASE_TIM_HANDLE;   //**< Handle Timer sử dụng làm nguồn thời gian >**/
+#endif
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm khởi tạo nguồn thời gian
+ * @details Hàm này sẽ khởi động Timer 32 bit chạy tự do (prescaler cấu hình cho 1 tick = 1 us)
+ *          và bật bộ đếm chu kỳ DWT->CYCCNT của lõi Cortex-M4.
+ * @param   void
+ * @return  void
+ **/
+void Timebase_Init(void);
+
+/**
+ * @brief   Hàm đọc thời gian hiện tại tính bằng micro giây
+ * @details Giá trị tràn sau 2^32 us (~71 phút), dùng TIMEBASE_ELAPSED để tính khoảng thời gian.
+ * @param   void
+ * @return  uint32_t    Thời gian hiện tại (us)
+ **/
+uint32_t Timebase_Micros(void);
+
+/**
+ * @brief   Hàm đọc bộ đếm chu kỳ CPU
+ * @details Trên vi điều khiển đọc DWT->CYCCNT, trên máy tính trả về đồng hồ ảo quy đổi ra chu kỳ.
+ * @param   void
+ * @return  uint32_t    Số chu kỳ CPU hiện tại
+ **/
+uint32_t Timebase_Cycles(void);
+
+/**
+ * @brief   Hàm quy đổi số chu kỳ CPU sang micro giây
+ * @param   cycles  Số chu kỳ CPU
+ * @return  uint32_t    Thời gian tương ứng (us)
+ **/
+uint32_t Timebase_CyclesToMicros(uint32_t cycles);
+
+/**
+ * @brief   Hàm tạo độ trễ ngắn tính bằng micro giây
+ * @details Hàm này chờ bận dựa trên Timebase_Micros, không thay đổi bộ đếm của Timer nào,
+ *          nên có thể dùng song song với delay_us.
+ * @param   us    Thời gian trễ cần tạo (us)
+ * @return  void
+ **/
+void Timebase_DelayUs(uint32_t us);
+
+#ifdef HOST_SIM
+/**
+ * @brief   Hàm tăng đồng hồ ảo khi chạy mô phỏng trên máy tính
+ * @param   us    Thời gian cần tăng thêm (us)
+ * @return  void
+ **/
+void Timebase_SimAdvance(uint32_t us);
+#endif
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
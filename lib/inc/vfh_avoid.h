@@ -0,0 +1,88 @@
+/*********************************************************************************************************************
+ * @file    vfh_avoid.h
+ * @brief   Thư viện tránh vật cản phản xạ bằng biểu đồ cực (Vector Field Histogram)
+ * @details Mỗi chu kỳ điều khiển, các ô có vật cản của bản đồ chiếm chỗ trong bán kính VFH_WINDOW_MM
+ *          được cộng vào biểu đồ cực VFH_SECTORS hướng quanh xe (ô gần và chắc chắn có trọng số lớn,
+ *          mỗi ô được nới rộng theo bán kính xe và khoảng cách an toàn). Các hướng có mật độ
+ *          dưới ngưỡng tạo thành các "thung lũng"; hướng đi là hướng trong thung lũng gần hướng mục tiêu nhất.
+ *          Xe Mecanum đi ngang theo hướng đó mà không cần quay thân (chỉ quay khi hướng lệch lớn),
+ *          tốc độ giảm theo mật độ vật cản ở hướng đi. Khi không còn thung lũng, xe quay tại chỗ.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __VFH_AVOID_H__
+#define __VFH_AVOID_H__
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "occupancy_grid.h"             //**< Thư viện bản đồ chiếm chỗ >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define VFH_SECTORS             36      //**< Số hướng của biểu đồ (10 độ / hướng)          >**/
+#define VFH_SECTOR_DEG          (360 / VFH_SECTORS)
+#define VFH_WINDOW_MM           1200    //**< Bán kính vùng xét (mm)                        >**/
+#define VFH_ROBOT_RADIUS_MM     150     //**< Bán kính xe (mm)                              >**/
+#define VFH_SMOOTH              2       //**< Số hướng lân cận dùng để làm mượt             >**/
+#define VFH_THRESHOLD           60      //**< Mật độ lớn hơn giá trị này: hướng bị chặn     >**/
+#define VFH_DENSITY_MAX         240     //**< Mật độ tại đó tốc độ giảm về tối thiểu        >**/
+#define VFH_WIDE_SECTORS        4       //**< Thung lũng rộng hơn số hướng này là thung lũng rộng >**/
+
+#define VFH_CONTROL_MS          50      //**< Chu kỳ điều khiển (ms)                        >**/
+#define VFH_SPEED_MAX           80      //**< Tốc độ lớn nhất (%), giới hạn bởi collision_guard >**/
+#define VFH_SPEED_MIN           20      //**< Tốc độ nhỏ nhất khi còn đi được (%)           >**/
+#define VFH_STRAFE_MAX_DEG      60      //**< Lệch quá góc này thì quay thân xe theo hướng đi >**/
+#define VFH_TURN_SPEED          35      //**< Tốc độ quay tại chỗ / quay thân (%)           >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Lệnh chuyển động của bộ tránh vật cản (dùng cho carMoveVector)
+ **/
+typedef struct {
+    int16_t vx;                         //**< Sang phải dương (%)                   >**/
+    int16_t vy;                         //**< Tiến lên dương (%)                    >**/
+    int16_t omega;                      //**< Quay trái dương (%)                   >**/
+    int16_t headingDeg;                 //**< Hướng đi đã chọn so với đầu xe (độ)   >**/
+    uint8_t blocked;                    //**< 1: không còn hướng trống, đang quay tại chỗ >**/
+} Vfh_Command;
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm khởi tạo bộ tránh vật cản
+ * @param   void
+ * @return  void
+ **/
+void Vfh_Init(void);
+
+/**
+ * @brief   Hàm đặt hướng mục tiêu
+ * @param   bearingDeg  Hướng mục tiêu so với đầu xe (độ, trái dương), mặc định 0
+ * @return  void
+ **/
+void Vfh_SetTarget(int16_t bearingDeg);
+
+/**
+ * @brief   Hàm đặt khoảng cách an toàn (cộng vào bán kính xe khi nới rộng vật cản)
+ * @param   distanceMm  Khoảng cách an toàn (mm)
+ * @return  void
+ **/
+void Vfh_SetSafeDistance(uint16_t distanceMm);
+
+/**
+ * @brief   Hàm tính lệnh chuyển động, gọi thường xuyên trong vòng lặp chính
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @param   command Nơi lưu lệnh chuyển động
+ * @return  uint8_t     1 nếu đến chu kỳ điều khiển và command đã được cập nhật, 0 nếu chưa
+ **/
+uint8_t Vfh_Update(uint32_t nowMs, Vfh_Command *command);
+
+/**
+ * @brief   Hàm đọc biểu đồ cực đã làm mượt của chu kỳ gần nhất
+ * @details Phần tử i ứng với hướng i x VFH_SECTOR_DEG (độ, trái dương, 0 là đầu xe).
+ * @param   void
+ * @return  const uint16_t*     Mảng VFH_SECTORS phần tử
+ **/
+const uint16_t *Vfh_Histogram(void);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif
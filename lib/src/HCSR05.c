@@ -10,81 +10,405 @@
  **********************************************************************************/
 /* ============================================[ INCLUDE FILE ]============================================*/
 #include "HCSR05.h"
+#include "timebase.h"                   //**< Thư viện nguồn thời gian micro giây >**/
+#include <string.h>                     //**< Thư viện sử dụng hàm memset >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+static HCSR05_Sensor       *sensors[HCSR05_MAX_SENSORS];    //**< Các cảm biến đã khởi tạo      >**/
+static uint8_t              sensorCount = 0;            //**< Số cảm biến                   >**/
+static uint16_t             sensorDistanceMm[HCSR05_MAX_SENSORS];  //**< Khoảng cách mới nhất (mm) >**/
+
+static uint32_t             slotChannels[HCSR05_MAX_SLOTS]; //**< Kênh Trigger của từng nhóm  >**/
+static uint8_t              slotCount = 0;              //**< Số nhóm                       >**/
+static volatile uint8_t     activeSlot = 0;             //**< Nhóm đã kích trong chu kỳ này >**/
+static volatile uint8_t     armedSlot = 0;              //**< Nhóm sẽ kích ở chu kỳ sau     >**/
+static volatile uint8_t     slotPending = 0;            //**< Cảm biến của nhóm chưa có Echo (bit) >**/
+static uint32_t             slotPeriodUs = HCSR05_MIN_PERIOD_US;   //**< Chu kỳ mỗi nhóm (us)   >**/
+
+static HCSR05_Echo          echoQueue[HCSR05_ECHO_QUEUE];   //**< Echo thô chờ xử lý (ghi trong ngắt) >**/
+static volatile uint8_t     echoHead = 0;               //**< Vị trí ghi (ngắt)             >**/
+static volatile uint8_t     echoTail = 0;               //**< Vị trí đọc (vòng lặp chính)   >**/
+
+static HCSR05_Callback      subscribers[HCSR05_MAX_SUBSCRIBERS];   //**< Các callback nhận mẫu  >**/
+static uint8_t              subscriberCount = 0;        //**< Số callback đã đăng ký        >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ đưa 1 xung Echo thô vào hàng đợi (gọi trong ngắt)
+ * @param   sensor      Cảm biến nhận Echo
+ * @param   pulseUs     Độ rộng xung Echo (us), 0 nếu mất Echo
+ * @return  void
+ **/
+static void HCSR05_PushEcho(HCSR05_Sensor *sensor, uint32_t pulseUs){
+    uint32_t primask = __get_PRIMASK();                         //**< Ngắt của TIM2 và TIM4 cùng ghi >**/
+    uint8_t  next;
+
+    __disable_irq();
+    next = (echoHead + 1) & (HCSR05_ECHO_QUEUE - 1);
+    if (next == echoTail) {                                     //**< Vòng lặp chính chưa kịp xử lý >**/
+        sensor->filter.overruns++;
+    } else {
+        echoQueue[echoHead].pulseUs     = pulseUs;
+        echoQueue[echoHead].timestampUs = Timebase_Micros();
+        echoQueue[echoHead].sensor      = sensor->index;
+        echoHead = next;
+    }
+    __set_PRIMASK(primask);
+}
+
+
+/**
+ * @brief   Hàm nội bộ nạp trước kênh Trigger cho nhóm sẽ kích ở chu kỳ sau
+ * @details CCR có preload nên giá trị mới chỉ có hiệu lực từ sự kiện update tiếp theo:
+ *          kênh của nhóm được chọn phát xung HCSR05_TRIG_PULSE_US, các kênh khác giữ mức thấp.
+ * @param   slot    Nhóm sẽ kích
+ * @return  void
+ **/
+static void HCSR05_ArmSlot(uint8_t slot){
+    for (uint8_t i = 0; i < slotCount; i++) {
+        __HAL_TIM_SET_COMPARE(&TIM_HANDLE_HCSR05, slotChannels[i], (i == slot) ? HCSR05_TRIG_PULSE_US : 0);
+    }
+    armedSlot = slot;
+}
+
+
+/**
+ * @brief   Hàm nội bộ đánh dấu các cảm biến của nhóm vừa kích là đang chờ Echo
+ * @param   slot    Nhóm vừa kích
+ * @return  void
+ **/
+static void HCSR05_BeginSlot(uint8_t slot){
+    uint8_t pending = 0;
+
+    for (uint8_t i = 0; i < sensorCount; i++) {
+        if (sensors[i]->slot == slot) {
+            sensors[i]->echoDone = 0;
+            pending |= 1U << i;
+        }
+    }
+    activeSlot  = slot;
+    slotPending = pending;
+}
+
 
-/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
 /**
  * @brief   Hàm sử dụng để xử lý ngắt khi có sự kiện capture từ Timer
- * @details Hàm này sẽ được gọi khi có sự kiện capture từ Timer HCSR05.
- *          Nó sẽ đọc giá trị thời gian từ Timer và tính toán khoảng cách dựa trên thời gian xung.
+ * @details Hàm này sẽ được gọi khi có sự kiện capture từ Timer Echo của một cảm biến.
+ *          Ngắt chỉ ghi lại độ rộng xung Echo, không tính toán số thực.
+ *          Khi cảm biến cuối cùng của nhóm nhận Echo, chu kỳ hiện tại được rút ngắn còn HCSR05_GUARD_US.
  * @note    Hàm này sẽ được gọi tự động khi có sự kiện capture từ Timer.  
- * @param   htim    Handle của Timer HCSR05
+ * @param   htim    Handle của Timer
  * @return  void
  **/
 extern void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
-    if (htim->Instance == TIM_HCSR05) {  									// Ki?m tra d�ng Timer
-        if (htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1) {  // K�nh dang d�ng
-            if (capture_flag == 0) {
-                // (Rising Edge)
-                rising_edge = HAL_TIM_ReadCapturedValue(htim, TIM_HCSR05_CHANNEL);
-                __HAL_TIM_SET_CAPTUREPOLARITY(htim, TIM_HCSR05_CHANNEL, TIM_INPUTCHANNELPOLARITY_FALLING);
-                capture_flag = 1;
-            } else {
-                // (Falling Edge)
-                falling_edge = HAL_TIM_ReadCapturedValue(htim, TIM_HCSR05_CHANNEL);
-                __HAL_TIM_SET_CAPTUREPOLARITY(htim, TIM_HCSR05_CHANNEL, TIM_INPUTCHANNELPOLARITY_RISING);
-                capture_flag = 0;
-
-                // T�nh to�n
-                if (falling_edge > rising_edge) {
-                    pulse_width = falling_edge - rising_edge;
-										distance_measure = (pulse_width * 0.0343) / 2.0;
-                } else {
-                    pulse_width = (htim->Init.Period - rising_edge) + falling_edge;
-										distance_measure = (pulse_width * 0.0343) / 2.0;
-                }
-            }
+    for (uint8_t i = 0; i < sensorCount; i++) {
+        HCSR05_Sensor *sensor = sensors[i];
+        uint32_t edge, period;
+
+        if (sensor->echoTim->Instance != htim->Instance || sensor->activeChannel != htim->Channel)
+            continue;
+
+        edge = HAL_TIM_ReadCapturedValue(htim, sensor->echoChannel);
+        if (sensor->slot != activeSlot || sensor->echoDone)     //**< Echo lạc ngoài chu kỳ của nhóm >**/
+            return;
+
+        if (sensor->capturing == 0) {
+            // (Rising Edge)
+            sensor->risingEdge = edge;
+            __HAL_TIM_SET_CAPTUREPOLARITY(htim, sensor->echoChannel, TIM_INPUTCHANNELPOLARITY_FALLING);
+            sensor->capturing = 1;
+            return;
         }
+
+        // (Falling Edge)
+        __HAL_TIM_SET_CAPTUREPOLARITY(htim, sensor->echoChannel, TIM_INPUTCHANNELPOLARITY_RISING);
+        sensor->capturing = 0;
+        sensor->echoDone  = 1;
+        period = __HAL_TIM_GET_AUTORELOAD(htim) + 1;            //**< Timer Echo có thể tràn giữa 2 cạnh >**/
+        HCSR05_PushEcho(sensor, (edge >= sensor->risingEdge) ? edge - sensor->risingEdge
+                                                              : edge + period - sensor->risingEdge);
+
+        slotPending &= ~(1U << i);
+        if (slotPending == 0) {                                 //**< Cả nhóm đã có Echo: chuyển nhóm sớm >**/
+            uint32_t end = __HAL_TIM_GET_COUNTER(&TIM_HANDLE_HCSR05) + HCSR05_GUARD_US;
+            if (end < __HAL_TIM_GET_AUTORELOAD(&TIM_HANDLE_HCSR05))
+                __HAL_TIM_SET_AUTORELOAD(&TIM_HANDLE_HCSR05, end);
+        }
+        return;
     }
 }
 
 
 /**
- * @brief   Hàm khởi tạo cảm biến HCSR05   
- * @details Hàm này sẽ khởi tạo Timer và cấu hình các thông số cần thiết cho cảm biến HCSR05. 
- * @param   void   
+ * @brief   Hàm xử lý ngắt update của Timer HCSR05
+ * @param   htim    Handle Timer phát sinh ngắt
+ * @return  void
+ **/
+void HCSR05_TimerHandler(TIM_HandleTypeDef *htim){
+    if (htim->Instance != TIM_HCSR05 || slotCount == 0)
+        return;
+    __HAL_TIM_SET_AUTORELOAD(htim, slotPeriodUs - 1);          //**< Trả lại chu kỳ nếu đã rút ngắn >**/
+
+    for (uint8_t i = 0; i < sensorCount; i++) {                 //**< Kết thúc nhóm vừa kích >**/
+        HCSR05_Sensor *sensor = sensors[i];
+
+        if (sensor->slot != activeSlot)
+            continue;
+        if (sensor->capturing) {                                //**< Echo chưa kết thúc >**/
+            __HAL_TIM_SET_CAPTUREPOLARITY(sensor->echoTim, sensor->echoChannel, TIM_INPUTCHANNELPOLARITY_RISING);
+            sensor->capturing = 0;
+        }
+        if (!sensor->echoDone) {                                //**< Không có Echo hoàn chỉnh: báo mất >**/
+            sensor->timeouts++;
+            HCSR05_PushEcho(sensor, 0);
+        }
+    }
+
+    HCSR05_BeginSlot(armedSlot);                                //**< Xung Trigger vừa bắt đầu tại update này >**/
+    HCSR05_ArmSlot((armedSlot + 1) % slotCount);
+}
+
+
+/**
+ * @brief   Hàm khởi tạo 1 cảm biến HCSR05   
+ * @details Hàm này đăng ký cảm biến vào bộ lập lịch và bật Input Capture kênh Echo.
+ * @param   sensor      Đối tượng cảm biến (cấp phát tĩnh)
+ * @param   echoTim     Timer Input Capture của chân Echo
+ * @param   echoChannel Kênh Input Capture (TIM_CHANNEL_x)
+ * @param   trigChannel Kênh PWM Trigger của TIM_HCSR05 (TIM_CHANNEL_x)
+ * @return  HAL_StatusTypeDef   HAL_OK, HAL_ERROR nếu đã đủ cảm biến hoặc đủ nhóm
+ **/
+HAL_StatusTypeDef HCSR05_Init(HCSR05_Sensor *sensor, TIM_HandleTypeDef *echoTim, uint32_t echoChannel, uint32_t trigChannel){
+    uint8_t slot = 0;
+
+    if (sensorCount >= HCSR05_MAX_SENSORS)
+        return HAL_ERROR;
+    while (slot < slotCount && slotChannels[slot] != trigChannel) {
+        slot++;
+    }
+    if (slot == slotCount) {                                    //**< Kênh Trigger mới: tạo nhóm mới >**/
+        if (slotCount >= HCSR05_MAX_SLOTS)
+            return HAL_ERROR;
+        slotChannels[slotCount++] = trigChannel;
+    }
+
+    memset(sensor, 0, sizeof(HCSR05_Sensor));
+    sensor->echoTim       = echoTim;
+    sensor->echoChannel   = echoChannel;
+    sensor->trigChannel   = trigChannel;
+    sensor->activeChannel = (uint8_t)(1U << (echoChannel >> 2));   //**< TIM_CHANNEL_x -> HAL_TIM_ACTIVE_CHANNEL_x >**/
+    sensor->index         = sensorCount;
+    sensor->slot          = slot;
+    sensor->echoDone      = 1;                                  //**< Chưa được kích >**/
+    sensor->sample.distanceMm = HCSR05_MAX_RANGE_MM;
+    sensor->sample.sensor     = sensorCount;
+    HCSR05_Filter_Init(&sensor->filter);
+
+    sensorDistanceMm[sensorCount] = HCSR05_MAX_RANGE_MM;
+    sensors[sensorCount++] = sensor;
+    HAL_TIM_IC_Start_IT(echoTim, echoChannel);
+    return HAL_OK;
+}
+
+
+/**
+ * @brief   Hàm bắt đầu đo liên tục các cảm biến đã khởi tạo
+ * @param   rateHz  Tần số kích nhóm (Hz), bị giới hạn bởi HCSR05_MIN_PERIOD_US
+ * @return  void
+ **/
+void HCSR05_Start(uint16_t rateHz){
+    if (slotCount == 0)
+        return;
+    HCSR05_SetRate(rateHz);
+    HCSR05_ArmSlot(0);
+    for (uint8_t i = 0; i < slotCount; i++) {
+        HAL_TIM_PWM_Start(&TIM_HANDLE_HCSR05, slotChannels[i]);
+    }
+    HAL_TIM_GenerateEvent(&TIM_HANDLE_HCSR05, TIM_EVENTSOURCE_UPDATE);    // nap CCR: nhom 0 kich ngay
+    __HAL_TIM_CLEAR_FLAG(&TIM_HANDLE_HCSR05, TIM_FLAG_UPDATE);
+    HCSR05_BeginSlot(0);
+    HCSR05_ArmSlot(1 % slotCount);
+    HAL_TIM_Base_Start_IT(&TIM_HANDLE_HCSR05);
+}
+
+
+/**
+ * @brief   Hàm thay đổi tần số kích nhóm
+ * @param   rateHz  Tần số kích nhóm (Hz), bị giới hạn bởi HCSR05_MIN_PERIOD_US
  * @return  void
  **/
-void HCSR05_Init(){
-	HAL_TIM_IC_Start_IT(&TIM_HANDLE_HCSR05, TIM_HCSR05_CHANNEL);
-	HAL_TIM_Base_Start(&TIM_HANDLE_HCSR05);
+void HCSR05_SetRate(uint16_t rateHz){
+    uint32_t periodUs;
+
+    if (rateHz == 0)
+        return;
+    periodUs = 1000000UL / rateHz;
+    if (periodUs < HCSR05_MIN_PERIOD_US)                        //**< Tránh nhận Echo của lần đo trước >**/
+        periodUs = HCSR05_MIN_PERIOD_US;
+    slotPeriodUs = periodUs;
+    __HAL_TIM_SET_AUTORELOAD(&TIM_HANDLE_HCSR05, periodUs - 1);
 }
 
 
 /**
  * @brief   Hàm kích hoạt cảm biến HCSR05 để bắt đầu quá trình đo khoảng cách   
- * @details Hàm này sẽ gửi tín hiệu kích hoạt đến chân Trigger của cảm biến HCSR05 
- *          để bắt đầu quá trình đo khoảng cách. 
- *          Sau khi kích hoạt, cảm biến sẽ gửi sóng siêu âm và chờ phản hồi từ vật thể.
- * @note    Hàm này sẽ được gọi để bắt đầu quá trình đo khoảng cách. 
- * @param   htim   
+ * @details Hàm này kết thúc nhóm hiện tại và khởi động lại chu kỳ Timer để kích nhóm tiếp theo ngay lập tức.
+ * @param   void   
  * @return  void
  **/
 void HCSR05_Trigger() {
-    HAL_GPIO_WritePin(TRIG_GPIO_Port, TRIG_Pin, GPIO_PIN_SET);  	// Set Trigger
-    delay_us(10);                                     						// 1ms
-    HAL_GPIO_WritePin(TRIG_GPIO_Port, TRIG_Pin, GPIO_PIN_RESET); 	// Reset Trigger
+    HAL_TIM_GenerateEvent(&TIM_HANDLE_HCSR05, TIM_EVENTSOURCE_UPDATE);  // CNT = 0 -> xung Trigger moi
+}
+
+
+/**
+ * @brief   Hàm đọc mẫu đo mới nhất của 1 cảm biến
+ * @param   sensor  Đối tượng cảm biến
+ * @param   sample  Nơi lưu mẫu
+ * @return  uint8_t     1 nếu đã có ít nhất 1 mẫu, 0 nếu chưa
+ **/
+uint8_t HCSR05_Read(const HCSR05_Sensor *sensor, HCSR05_Sample *sample){
+    *sample = sensor->sample;                                   //**< Chỉ được ghi trong vòng lặp chính >**/
+    return sample->sequence != 0;
+}
+
+
+/**
+ * @brief   Hàm đọc mảng khoảng cách mới nhất của mọi cảm biến
+ * @param   count   Nơi lưu số cảm biến, NULL nếu không cần
+ * @return  const uint16_t*     Mảng khoảng cách (mm)
+ **/
+const uint16_t *HCSR05_Distances(uint8_t *count){
+    if (count != NULL)
+        *count = sensorCount;
+    return sensorDistanceMm;
+}
+
+
+/**
+ * @brief   Hàm đăng ký callback nhận mẫu mới
+ * @param   callback    Hàm được gọi với mỗi mẫu mới
+ * @return  uint8_t     1 nếu thành công, 0 nếu đã đủ HCSR05_MAX_SUBSCRIBERS
+ **/
+uint8_t HCSR05_Subscribe(HCSR05_Callback callback){
+    if (callback == NULL || subscriberCount >= HCSR05_MAX_SUBSCRIBERS)
+        return 0;
+    subscribers[subscriberCount++] = callback;
+    return 1;
+}
+
+
+/**
+ * @brief   Hàm đọc số lần mất xung Echo (quá 1 chu kỳ của nhóm)
+ * @param   sensor  Đối tượng cảm biến
+ * @return  uint32_t    Số lần mất Echo
+ **/
+uint32_t HCSR05_Timeouts(const HCSR05_Sensor *sensor){
+    return sensor->timeouts;
+}
+
+
+/**
+ * @brief   Hàm khởi tạo bộ lọc khoảng cách
+ * @param   filter  Bộ lọc
+ * @return  void
+ **/
+void HCSR05_Filter_Init(HCSR05_Filter *filter){
+    memset(filter, 0, sizeof(HCSR05_Filter));
+}
+
+
+/**
+ * @brief   Hàm nội bộ tính trung vị của cửa sổ mẫu
+ * @param   filter  Bộ lọc
+ * @return  uint16_t    Giá trị trung vị (mm)
+ **/
+static uint16_t HCSR05_Filter_Median(const HCSR05_Filter *filter){
+    uint16_t sorted[HCSR05_MEDIAN_N];
+    uint8_t  count = filter->windowCount;
+
+    for (uint8_t i = 0; i < count; i++) {                       //**< Sắp xếp chèn, N nhỏ >**/
+        uint16_t value = filter->window[i];
+        int8_t   j = i - 1;
+        while (j >= 0 && sorted[j] > value) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = value;
+    }
+    return sorted[count / 2];
+}
+
+
+/**
+ * @brief   Hàm xử lý 1 xung Echo thô: quy đổi mm, loại bỏ Echo lỗi, lọc trung vị + EMA
+ * @param   filter  Bộ lọc
+ * @param   echo    Xung Echo thô
+ * @param   sample  Mẫu kết quả (sequence không thay đổi)
+ * @return  uint8_t     1 nếu sample được cập nhật, 0 nếu Echo bị loại
+ **/
+uint8_t HCSR05_Filter_Process(HCSR05_Filter *filter, const HCSR05_Echo *echo, HCSR05_Sample *sample){
+    uint16_t median;
+
+    if (echo->pulseUs == 0 || echo->pulseUs < HCSR05_MIN_ECHO_US || echo->pulseUs > HCSR05_MAX_ECHO_US) {
+        if (echo->pulseUs == 0)
+            filter->missingCount++;
+        else
+            filter->rangeCount++;
+        if (++filter->invalidRun < HCSR05_INVALID_LIMIT)
+            return 0;                                           //**< Bỏ qua Echo lỗi đơn lẻ >**/
+
+        filter->invalidRun  = HCSR05_INVALID_LIMIT;             //**< Lỗi kéo dài: ngoài tầm đo >**/
+        filter->windowCount = 0;
+        filter->windowIndex = 0;
+        sample->pulseUs     = echo->pulseUs;
+        sample->rawMm       = HCSR05_MAX_RANGE_MM;
+        sample->distanceMm  = HCSR05_MAX_RANGE_MM;
+        sample->valid       = 0;
+        sample->timestampUs = echo->timestampUs;
+        return 1;
+    }
+
+    filter->validCount++;
+    filter->invalidRun = 0;
+    sample->pulseUs     = echo->pulseUs;
+    sample->rawMm       = (uint16_t)HCSR05_US_TO_MM(echo->pulseUs);
+    sample->timestampUs = echo->timestampUs;
+
+    filter->window[filter->windowIndex] = sample->rawMm;
+    filter->windowIndex = (filter->windowIndex + 1) % HCSR05_MEDIAN_N;
+    if (filter->windowCount < HCSR05_MEDIAN_N) {
+        if (filter->windowCount++ == 0)
+            filter->emaScaled = (int32_t)sample->rawMm << 4;    //**< Mẫu đầu tiên khởi tạo EMA >**/
+    }
+
+    median = HCSR05_Filter_Median(filter);
+    filter->emaScaled += (((int32_t)median << 4) - filter->emaScaled) >> HCSR05_EMA_SHIFT;
+    sample->distanceMm = (uint16_t)(filter->emaScaled >> 4);
+    sample->valid      = 1;
+    return 1;
+}
+
+
+/**
+ * @brief   Hàm đọc bộ đếm chất lượng của bộ lọc
+ * @param   sensor  Đối tượng cảm biến
+ * @return  const HCSR05_Filter*    Bộ lọc của cảm biến
+ **/
+const HCSR05_Filter *HCSR05_GetStats(const HCSR05_Sensor *sensor){
+    return &sensor->filter;
 }
 
 
 /**
  * @brief   Hàm tính toán khoảng cách dựa trên thời gian xung đã đo được từ cảm biến HCSR05  
  * @details Hàm này sẽ tính toán khoảng cách dựa trên thời gian xung đã đo được từ cảm biến HCSR05.
- *          Công thức tính khoảng cách là: distance = (pulse_width * 0.0343) / 2.0 (đơn vị: cm).   
- * @param   void   
+ *          Khoảng cách lấy từ mẫu đã lọc: distance = distanceMm / 10 (đơn vị: cm).   
+ * @param   sensor  Đối tượng cảm biến
  * @return  float   Khoảng cách đã tính toán (đơn vị: cm)
  **/
-float Calculate_Distance() {
-    return (pulse_width * 0.0343) / 2.0;  // pw tinh bang us => pw/1.000.000 *34.300 cm /2 quang duong
+float Calculate_Distance(const HCSR05_Sensor *sensor) {
+    return sensor->sample.distanceMm / 10.0f;
 }
 
 
@@ -93,30 +417,40 @@ float Calculate_Distance() {
  * @details Hàm này sẽ hiển thị khoảng cách đo được trên LCD.
  *          Nó sẽ sử dụng hàm sprintf để định dạng chuỗi và gửi đến LCD.
  * @note    Hàm này sẽ được gọi để hiển thị kết quả đo được trên LCD.    
- * @param   void   
+ * @param   sensor  Đối tượng cảm biến
  * @return  void
  **/
-void HCSR05_LCD(){
+void HCSR05_LCD(const HCSR05_Sensor *sensor){
 		char buf[16];
 		lcd_set_cursor(1,1);
-		sprintf(buf,"Distance=%.1fcm",Calculate_Distance());
+		sprintf(buf,"Distance=%.1fcm",Calculate_Distance(sensor));
 		lcd_send_string(buf);
 }
 
 
 /**
  * @brief   Hàm cập nhật khoảng cách đo được từ cảm biến HCSR05   
- * @details Hàm này sẽ kích hoạt cảm biến HCSR05 và chờ đợi kết quả đo được.
- *          Sau khi đo xong, nó sẽ trả về khoảng cách đã đo được.
+ * @details Hàm này không chặn: lọc các Echo đang chờ của mọi cảm biến, cập nhật mảng khoảng cách
+ *          và gọi các callback đã đăng ký với mỗi mẫu mới.
  * @param   void   
- * @return  float   Khoảng cách đã đo được (đơn vị: cm)
+ * @return  float   Khoảng cách đo được gần nhất của cảm biến đầu tiên (đơn vị: cm)
  **/
 float HCSR05_update(){
-		HCSR05_Trigger();
-		HAL_Delay(10);
-//		HCSR05_LCD();
-//		return (pulse_width * 0.0343) / 2.0;  // pw tinh bang us => pw/1.000.000 *34.300 cm /2 quang duong
-		return distance_measure;
-}
-
+		while (echoTail != echoHead) {								// xu ly cac Echo tho dang cho
+			HCSR05_Echo echo = echoQueue[echoTail];
+			HCSR05_Sensor *sensor = sensors[echo.sensor];
+			echoTail = (echoTail + 1) & (HCSR05_ECHO_QUEUE - 1);
 
+			if (HCSR05_Filter_Process(&sensor->filter, &echo, &sensor->sample)) {
+				sensor->sample.sequence++;
+				sensorDistanceMm[echo.sensor] = sensor->sample.distanceMm;
+				for (uint8_t i = 0; i < subscriberCount; i++) {
+					subscribers[i](&sensor->sample);
+				}
+			}
+		}
+		if (sensorCount == 0)
+			return 0;
+//		HCSR05_LCD(sensors[0]);
+		return sensors[0]->sample.distanceMm / 10.0f;
+}
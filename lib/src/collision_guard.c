@@ -0,0 +1,202 @@
+/*********************************************************************************************************************
+ * @file    collision_guard.c
+ * @brief   Thư viện giới hạn tốc độ theo quãng đường phanh và thời gian va chạm
+ * @details Triển khai ước lượng vận tốc tiếp cận từng hướng và giới hạn lệnh vận tốc bằng số nguyên.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "collision_guard.h"            //**< Thư viện giới hạn tốc độ >**/
+#include "timebase.h"                   //**< Thư viện nguồn thời gian micro giây >**/
+#include <string.h>                     //**< Thư viện sử dụng hàm memset >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Lịch sử mẫu siêu âm của 1 hướng
+ **/
+typedef struct {
+    uint16_t lastMm;                    //**< Khoảng cách của mẫu trước (mm)        >**/
+    uint32_t lastUs;                    //**< Thời điểm của mẫu trước (us)          >**/
+    int32_t  closingMmS;                //**< Vận tốc tiếp cận đã lọc (mm/s)        >**/
+    uint8_t  hasLast;                   //**< Đã có mẫu hợp lệ trước đó             >**/
+} Guard_Track;
+
+static const int16_t axisBearing[GUARD_AXES] = {
+    GRID_BEARING_FRONT, GRID_BEARING_REAR, GRID_BEARING_LEFT, GRID_BEARING_RIGHT
+};
+static const uint32_t axisMaxAgeUs[GUARD_AXES] = {        //**< Tuổi lớn nhất của mẫu theo chu kỳ đo từng hướng >**/
+    GUARD_FRONT_MAX_AGE_US, GUARD_SAMPLE_MAX_AGE_US, GUARD_SAMPLE_MAX_AGE_US, GUARD_SAMPLE_MAX_AGE_US
+};
+static Guard_Track  tracks[GUARD_AXES];                     //**< Lịch sử mẫu từng hướng        >**/
+static Guard_State  states[GUARD_AXES];                     //**< Kết quả lần giới hạn gần nhất >**/
+static uint16_t     safeMarginMm = GUARD_MARGIN_MM;         //**< Lề an toàn (mm)               >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ tính căn bậc hai số nguyên
+ * @param   value   Giá trị
+ * @return  uint32_t    Phần nguyên của căn bậc hai
+ **/
+static uint32_t Guard_Sqrt(uint32_t value)
+{
+    uint32_t root = 0, bit = 1UL << 30;
+
+    while (bit > value)
+        bit >>= 2;
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root   = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+
+/**
+ * @brief   Hàm nội bộ tính vận tốc lớn nhất còn phanh kịp trong 1 khoảng trống
+ * @details Giải v x t + v^2 / (2a) = d  =>  v = sqrt(2ad + (at)^2) - at.
+ * @param   freeMm      Khoảng trống sau khi trừ lề an toàn (mm)
+ * @param   latencyMs   Trễ từ lúc đo đến lúc bắt đầu phanh (ms)
+ * @return  uint32_t    Vận tốc lớn nhất (mm/s)
+ **/
+static uint32_t Guard_AllowedSpeed(uint32_t freeMm, uint32_t latencyMs)
+{
+    uint32_t at = (uint32_t)GUARD_DECEL_MM_S2 * latencyMs / 1000;
+
+    return Guard_Sqrt(2UL * GUARD_DECEL_MM_S2 * freeMm + at * at) - at;
+}
+
+
+/**
+ * @brief   Hàm khởi tạo bộ giới hạn
+ * @param   void
+ * @return  void
+ **/
+void Guard_Init(void)
+{
+    memset(tracks, 0, sizeof(tracks));
+    memset(states, 0, sizeof(states));
+}
+
+
+/**
+ * @brief   Hàm đặt lề an toàn (khoảng cách luôn giữ với vật cản)
+ * @param   marginMm    Lề an toàn (mm)
+ * @return  void
+ **/
+void Guard_SetMargin(uint16_t marginMm)
+{
+    safeMarginMm = marginMm;
+}
+
+
+/**
+ * @brief   Hàm đưa 1 mẫu siêu âm đã lọc của 1 hướng vào bộ giới hạn (gọi trong callback HCSR05)
+ * @param   axis    Hướng của cảm biến
+ * @param   sample  Mẫu mới
+ * @return  void
+ **/
+void Guard_AddRange(Guard_Axis axis, const HCSR05_Sample *sample)
+{
+    Guard_Track *track = &tracks[axis];
+    uint32_t dtMs = (sample->timestampUs - track->lastUs + 500) / 1000;
+    int32_t  closing;
+
+    if (!sample->valid) {                                       //**< Ngoài tầm: không còn vật cản để tiếp cận >**/
+        track->hasLast    = 0;
+        track->closingMmS = 0;
+        track->lastMm     = HCSR05_MAX_RANGE_MM;
+        track->lastUs     = sample->timestampUs;
+        return;
+    }
+
+    if (track->hasLast && dtMs > 0 && dtMs < 2 * axisMaxAgeUs[axis] / 1000) {
+        closing = ((int32_t)track->lastMm - (int32_t)sample->distanceMm) * 1000 / (int32_t)dtMs;
+        if (closing > GUARD_CLOSING_MAX_MM_S)
+            closing = GUARD_CLOSING_MAX_MM_S;
+        else if (closing < -GUARD_CLOSING_MAX_MM_S)
+            closing = -GUARD_CLOSING_MAX_MM_S;
+        track->closingMmS += (closing - track->closingMmS) / (1 << GUARD_CLOSING_SHIFT);
+    } else {
+        track->closingMmS = 0;
+    }
+    track->lastMm  = sample->distanceMm;
+    track->lastUs  = sample->timestampUs;
+    track->hasLast = 1;
+}
+
+
+/**
+ * @brief   Hàm giới hạn lệnh vận tốc theo quãng đường phanh và thời gian va chạm
+ * @param   vx      Vận tốc sang ngang (%, sang phải dương), được sửa tại chỗ
+ * @param   vy      Vận tốc tiến lùi (%, tiến lên dương), được sửa tại chỗ
+ * @return  uint8_t     1 nếu lệnh đã bị giảm, 0 nếu giữ nguyên
+ **/
+uint8_t Guard_Limit(int16_t *vx, int16_t *vy)
+{
+    uint32_t nowUs = Timebase_Micros();
+    int32_t  vxMmS = (int32_t)*vx * GRID_SPEED_MM_S / 100;
+    int32_t  vyMmS = (int32_t)*vy * GRID_SPEED_MM_S / 100;
+    int32_t  command[GUARD_AXES] = { vyMmS, -vyMmS, -vxMmS, vxMmS };   //**< Thành phần lệnh về mỗi hướng >**/
+    uint8_t  limited = 0;
+
+    for (uint8_t axis = 0; axis < GUARD_AXES; axis++) {
+        Guard_Track *track = &tracks[axis];
+        Guard_State *state = &states[axis];
+        uint32_t range = Grid_Clearance(axisBearing[axis]);
+        uint32_t ageUs = nowUs - track->lastUs;
+        uint8_t  fresh = track->hasLast && (ageUs < axisMaxAgeUs[axis]);
+        int32_t  measured = fresh ? track->closingMmS : 0;
+        int32_t  commanded = (command[axis] > 0) ? command[axis] : 0;
+        int32_t  closing = (measured > commanded) ? measured : commanded;
+        uint32_t freeMm, allowed, approach, ttc, latencyMs;
+
+        if (fresh && track->lastMm < range)                     //**< Mẫu trực tiếp gần hơn bản đồ >**/
+            range = track->lastMm;
+        latencyMs = GUARD_LATENCY_MS + (fresh ? ageUs : axisMaxAgeUs[axis]) / 1000;   //**< Xe đã đi tiếp từ lúc đo >**/
+        freeMm   = (range > safeMarginMm) ? range - safeMarginMm : 0;
+        approach = (measured > commanded) ? (uint32_t)(measured - commanded) : 0;   //**< Vật cản tự tiến lại >**/
+        allowed  = Guard_AllowedSpeed(freeMm, latencyMs);
+        allowed  = (allowed > approach) ? allowed - approach : 0;
+        ttc      = (closing > 0) ? freeMm * 1000 / (uint32_t)closing : 0xFFFF;
+        if (ttc < GUARD_TTC_STOP_MS)
+            allowed = 0;
+
+        state->rangeMm    = (uint16_t)range;
+        state->closingMmS = (int16_t)closing;
+        state->stoppingMm = (uint16_t)((uint32_t)closing * latencyMs / 1000 +
+                                       (uint32_t)closing * (uint32_t)closing / (2UL * GUARD_DECEL_MM_S2));
+        state->ttcMs      = (ttc > 0xFFFF) ? 0xFFFF : (uint16_t)ttc;
+        state->allowedMmS = (allowed > 0xFFFF) ? 0xFFFF : (uint16_t)allowed;
+        state->limited    = (uint32_t)commanded > allowed;
+        if (!state->limited)
+            continue;
+
+        limited = 1;
+        switch (axis) {                                         //**< Chỉ giảm thành phần về phía vật cản >**/
+        case GUARD_FRONT: *vy =  (int16_t)(allowed * 100 / GRID_SPEED_MM_S); break;
+        case GUARD_REAR:  *vy = -(int16_t)(allowed * 100 / GRID_SPEED_MM_S); break;
+        case GUARD_LEFT:  *vx = -(int16_t)(allowed * 100 / GRID_SPEED_MM_S); break;
+        case GUARD_RIGHT: *vx =  (int16_t)(allowed * 100 / GRID_SPEED_MM_S); break;
+        default: break;
+        }
+    }
+    return limited;
+}
+
+
+/**
+ * @brief   Hàm đọc trạng thái của 1 hướng
+ * @param   axis    Hướng cần đọc
+ * @param   state   Nơi lưu trạng thái
+ * @return  void
+ **/
+void Guard_GetState(Guard_Axis axis, Guard_State *state)
+{
+    *state = states[axis];
+}
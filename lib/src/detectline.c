@@ -3,49 +3,130 @@
 
 State_Line stateLine;
 
-//callback func xu l cac truong hop detect duoc
-void detect_Line(void (* handleLine[])(void)){
-	uint8_t detectLine = ((READ_LINE5 ? 1 : 0) | (READ_LINE4 ? 2 : 0) | (READ_LINE3 ? 4 : 0) | (READ_LINE2 ? 8 : 0) | (READ_LINE1 ? 16 : 0));
-	
-	switch(detectLine){
-		case LINE_GO_HEAD1:		// di thang
-		case LINE_GO_HEAD2:
-		case LINE_GO_HEAD3:
-		case LINE_GO_HEAD4:
-		case LINE_GO_HEAD5:
-			handleLine[0]();
-//			stateLine = STATE_HEAD;
-			break;
-		case LINE_GO_LEFT_SLOW1:	// lech trai
-		case LINE_GO_LEFT_SLOW2:
-		case LINE_GO_LEFT_SLOW3:
-		case LINE_GO_LEFT_SLOW4:
-		case LINE_GO_LEFT_SLOW5:
-			handleLine[1]();
-			stateLine = STATE_LEFT;
-			break;
-		case LINE_GO_RIGHT_SLOW1:	// lech phai
-		case LINE_GO_RIGHT_SLOW2:
-		case LINE_GO_RIGHT_SLOW3:
-		case LINE_GO_RIGHT_SLOW4:
-		case LINE_GO_RIGHT_SLOW5:
-			handleLine[2]();
-			stateLine = STATE_RIGHT;
-			break;
-		case LINE_GO_TURN:				// quay dau
-		default:									// th khc
-			if(stateLine == STATE_LEFT)
-			{
-				handleLine[3]();				// quay dau trai
-			}else{
-				handleLine[4]();					// quay dau phai
+// mang truoc phuc vu chieu tien; mang sau lap cung chieu nen khi lui LINE1 nam ben phai
+static const Line_Array lineArrays[LINE_ARRAY_COUNT] = {
+	{ LINE_FRONT_PORTS, LINE_FRONT_PINS, LINE_ORIENT_NORMAL },
+	{ LINE_REAR_PORTS, LINE_REAR_PINS, LINE_ORIENT_MIRROR }
+};
+
+// cach doc 1 mang tinh san: moi port 1 lan doc IDR, dich ve cua so 5 chan roi tra bang ra bit cua mau
+typedef struct {
+	GPIO_TypeDef *port[LINE_READ_PORTS];
+	uint8_t portCount;
+	uint8_t shift[LINE_READ_PORTS];					// chan thap nhat cua mang tren port
+	uint8_t remap[LINE_READ_PORTS][LINE_REMAP_SIZE];	// cua so chan -> bit cua mau (LINE1 = bit 4 NORMAL / bit 0 MIRROR)
+} Line_ReadPlan;
+
+static Line_ReadPlan linePlans[LINE_ARRAY_COUNT];
+static volatile uint8_t lineSelected = LINE_ARRAY_FRONT;
+
+// mau 5 bit (LINE1 = bit 4 ... LINE5 = bit 0) -> hanh dong
+static const uint8_t lineAction[32] = {
+	LINE_ACTION_HEAD,		// 00000
+	LINE_ACTION_LEFT,		// 00001
+	LINE_ACTION_TURN,		// 00010
+	LINE_ACTION_LEFT,		// 00011
+	LINE_ACTION_TURN,		// 00100
+	LINE_ACTION_TURN,		// 00101
+	LINE_ACTION_TURN,		// 00110
+	LINE_ACTION_LEFT,		// 00111
+	LINE_ACTION_TURN,		// 01000
+	LINE_ACTION_TURN,		// 01001
+	LINE_ACTION_TURN,		// 01010
+	LINE_ACTION_TURN,		// 01011
+	LINE_ACTION_TURN,		// 01100
+	LINE_ACTION_TURN,		// 01101
+	LINE_ACTION_TURN,		// 01110
+	LINE_ACTION_LEFT,		// 01111
+	LINE_ACTION_RIGHT,	// 10000
+	LINE_ACTION_HEAD,		// 10001
+	LINE_ACTION_TURN,		// 10010
+	LINE_ACTION_HEAD,		// 10011
+	LINE_ACTION_TURN,		// 10100
+	LINE_ACTION_TURN,		// 10101
+	LINE_ACTION_TURN,		// 10110
+	LINE_ACTION_LEFT,		// 10111
+	LINE_ACTION_RIGHT,	// 11000
+	LINE_ACTION_HEAD,		// 11001
+	LINE_ACTION_TURN,		// 11010
+	LINE_ACTION_HEAD,		// 11011
+	LINE_ACTION_RIGHT,	// 11100
+	LINE_ACTION_RIGHT,	// 11101
+	LINE_ACTION_RIGHT,	// 11110
+	LINE_ACTION_TURN		// 11111
+};
+
+// tinh san cach doc cac mang, goi 1 lan truoc khi bat ngat lay mau
+// moi mang toi da LINE_READ_PORTS port, cac chan tren 1 port nam trong LINE_REMAP_BITS chan lien tiep
+void detect_Line_Init(void){
+	for(uint8_t a = 0; a < LINE_ARRAY_COUNT; a++){
+		const Line_Array *array = &lineArrays[a];
+		Line_ReadPlan *plan = &linePlans[a];
+		uint16_t used[LINE_READ_PORTS] = {0};
+		uint8_t portIndex[LINE_ARRAY_SENSORS];
+
+		plan->portCount = 0;
+		for(uint8_t i = 0; i < LINE_ARRAY_SENSORS; i++){
+			uint8_t k = 0;
+			while(k < plan->portCount && plan->port[k] != array->port[i])
+				k++;
+			if(k == plan->portCount)
+				plan->port[plan->portCount++] = array->port[i];
+			portIndex[i] = k;
+			used[k] |= array->pin[i];
+		}
+		for(uint8_t k = 0; k < plan->portCount; k++){
+			plan->shift[k] = 0;
+			while(!(used[k] & (1U << plan->shift[k])))
+				plan->shift[k]++;
+			for(uint8_t v = 0; v < LINE_REMAP_SIZE; v++){
+				uint8_t bits = 0;
+				for(uint8_t i = 0; i < LINE_ARRAY_SENSORS; i++){
+					uint8_t bit = (array->orientation == LINE_ORIENT_MIRROR) ? i : (LINE_ARRAY_SENSORS - 1 - i);
+					if(portIndex[i] == k && ((uint32_t)v << plan->shift[k]) & array->pin[i])
+						bits |= 1U << bit;
+				}
+				plan->remap[k][v] = bits;
 			}
-			
-			break;
+		}
 	}
+	lineSelected = LINE_ARRAY_FRONT;
 }
 
+// chon mang cam bien cho detect_Line_Read (doi chieu di)
+void detect_Line_Select(Line_ArrayId array){
+	if(array < LINE_ARRAY_COUNT)
+		lineSelected = array;
+}
 
+Line_ArrayId detect_Line_Selected(void){
+	return (Line_ArrayId)lineSelected;
+}
 
+// doc mang dang chon: moi port doc IDR 1 lan, dich + mat na + tra bang, du nhanh de goi trong ngat Timer
+uint8_t detect_Line_Read(void){
+	const Line_ReadPlan *plan = &linePlans[lineSelected];
+	uint8_t pattern = plan->remap[0][(plan->port[0]->IDR >> plan->shift[0]) & LINE_REMAP_MASK];
 
+	if(plan->portCount > 1)
+		pattern |= plan->remap[1][(plan->port[1]->IDR >> plan->shift[1]) & LINE_REMAP_MASK];
+	return pattern;
+}
+
+//callback func xu l cac truong hop detect duoc
+void detect_Line_Dispatch(uint8_t pattern, void (* handleLine[])(void)){
+	uint8_t action = lineAction[pattern & 0x1F];
+
+	if(action == LINE_ACTION_LEFT){				// lech trai
+		stateLine = STATE_LEFT;
+	}else if(action == LINE_ACTION_RIGHT){		// lech phai
+		stateLine = STATE_RIGHT;
+	}else if(action == LINE_ACTION_TURN){		// quay dau / th khc
+		action = (stateLine == STATE_LEFT) ? LINE_ACTION_TURN_LEFT : LINE_ACTION_TURN_RIGHT;
+	}
+	handleLine[action]();
+}
 
+void detect_Line(void (* handleLine[])(void)){
+	detect_Line_Dispatch(detect_Line_Read(), handleLine);
+}
@@ -7,29 +7,130 @@ extern uint8_t distance;
 
 
 ///// PS2 CONTROLLER MODE ////////
-extern PS2 *ps2;
+PS2_Driver ps2Pad;					// tay cam lai xe (cap phat tinh)
+PS2_Driver ps2Operator;				// tay cam nguoi van hanh (cap phat tinh)
+PS2_Snapshot ps2Input;				// anh chup trang thai PS2 moi nhat (polling nen)
+PS2_Snapshot ps2OperatorInput;		// anh chup tay cam nguoi van hanh
+uint32_t ps2InputAgeUs = 0;		// tuoi du lieu PS2 (us)
+uint32_t ps2FailsafeUs = PS2_LINK_DEADLINE_US;	// mat tin hieu qua thoi gian nay thi dung xe (us)
+uint8_t ps2LinkUp = 0;				// tay cam lai xe dang ket noi
 
 ///// AUTO MOVING MODE ////////
-uint8_t flag_obstacle = 0;		//vat can
-uint8_t flag_turn_car = 0;		//trang thai quay dau
+HCSR05_Sensor sonarFront;			// cam bien sieu am truoc (nhom Trigger 0)
+HCSR05_Sensor sonarRear;			// cam bien sieu am sau (nhom Trigger 0)
+HCSR05_Sensor sonarLeft;			// cam bien sieu am trai (nhom Trigger 1)
+HCSR05_Sensor sonarRight;			// cam bien sieu am phai (nhom Trigger 1)
+Vfh_Command avoidCommand;		// lenh chuyen dong cua bo tranh vat can
+
+///// LINE DETECTION MODE ////////
+// lo trinh: moi ky tu la hanh dong tai 1 nga ba / nga tu (S thang, L trai, R phai, U quay dau, B lui, X dung)
+static const Route_Program lineRoute = {"KHO A", "LSRX"};
+Route_Progress routeProgress;		// tien do lo trinh da hien thi tren LCD
+
+
+// dua mau sieu am vao ban do chiem cho va bo gioi han toc do (goi trong HCSR05_update)
+static void grid_OnSonar(const HCSR05_Sample *sample){
+	if(sample->sensor == sonarFront.index){
+		if(Scan_Busy())
+			return;						// servo dang quay: mau quet duoc dua vao theo tung buoc (grid_OnScanStep)
+		Grid_AddRange(GRID_BEARING_FRONT, sample->rawMm, sample->valid);
+		Guard_AddRange(GUARD_FRONT, sample);
+	}else if(sample->sensor == sonarRear.index){
+		Grid_AddRange(GRID_BEARING_REAR, sample->rawMm, sample->valid);
+		Guard_AddRange(GUARD_REAR, sample);
+	}else if(sample->sensor == sonarLeft.index){
+		Grid_AddRange(GRID_BEARING_LEFT, sample->rawMm, sample->valid);
+		Guard_AddRange(GUARD_LEFT, sample);
+	}else if(sample->sensor == sonarRight.index){
+		Grid_AddRange(GRID_BEARING_RIGHT, sample->rawMm, sample->valid);
+		Guard_AddRange(GUARD_RIGHT, sample);
+	}
+}
+
+
+// dua tung buoc quet servo vao ban do ngay khi do xong, theo vi tri xe luc do (goi trong Scan_Service)
+// buoc o SCAN_ANGLE_FRONT con dua vao bo gioi han toc do: trong AUTO servo quet lien tuc, Scan_Busy luon bang 1
+static void grid_OnScanStep(const Scan_Point *point, const HCSR05_Sample *sample){
+	Grid_AddRange(point->angle - SCAN_ANGLE_FRONT, point->distanceMm, point->valid);
+	if(point->angle == SCAN_ANGLE_FRONT && sample != NULL){
+		Guard_AddRange(GUARD_FRONT, sample);	// mau do sau khi servo on dinh o phia truoc, giu thoi diem do that
+	}
+}
 
 
 /////////// CONFIG MODE /////////////////
+// goi 1 lan trong main sau khi khoi tao ngoai vi
+void initAll(){
+	PS2_Init(&ps2Pad, &PS2_SPI_HANDLE, PS2_CS_PORT, PS2_CS_PIN, PS2_FEATURE_RUMBLE | PS2_FEATURE_PRESSURE | PS2_FEATURE_LATENCY);
+	PS2_Init(&ps2Operator, &PS2_SPI_HANDLE, PS2_CS2_PORT, PS2_CS2_PIN, 0);
+	PS2_Poll_Start(PS2_POLL_RATE_HZ);	// polling lan luot 2 tay cam bang Timer + DMA
+
+	PS2_EventConfig eventConfig = {
+		PS2_EVENT_LONG_PRESS_MS, PS2_EVENT_REPEAT_DELAY_MS, PS2_EVENT_REPEAT_PERIOD_MS,
+		0xFFFF,							// tat ca nut deu co su kien giu lau
+		PSB_TRIANGLE | PSB_CROSS		// tang/giam khoang cach lap lai khi giu nut
+	};
+	PS2_Event_Init(&eventConfig);
+	PS2_Stick_Init(NULL);				// tinh bang duong cong joystick (vung chet, expo, rate)
+
+	// cam bien truoc khoi tao dau tien: HCSR05_update() tra ve khoang cach phia truoc
+	HCSR05_Init(&sonarFront, &TIM_HANDLE_HCSR05, HCSR05_FRONT_ECHO_CHANNEL, HCSR05_FRONT_TRIG_CHANNEL);
+	HCSR05_Init(&sonarRear, &TIM_HANDLE_HCSR05_ECHO, HCSR05_REAR_ECHO_CHANNEL, HCSR05_REAR_TRIG_CHANNEL);
+	HCSR05_Init(&sonarLeft, &TIM_HANDLE_HCSR05_ECHO, HCSR05_LEFT_ECHO_CHANNEL, HCSR05_LEFT_TRIG_CHANNEL);
+	HCSR05_Init(&sonarRight, &TIM_HANDLE_HCSR05_ECHO, HCSR05_RIGHT_ECHO_CHANNEL, HCSR05_RIGHT_TRIG_CHANNEL);
+	HCSR05_Start(HCSR05_RATE_HZ);		// truoc/sau va trai/phai kich xen ke, tranh nhieu cheo
+	Scan_Init(&sonarFront);				// cam bien truoc gan tren servo
+	Scan_OnStep(grid_OnScanStep);
+	Grid_Init();						// ban do chiem cho quanh xe
+	Guard_Init();						// gioi han toc do theo quang duong phanh
+	HCSR05_Subscribe(grid_OnSonar);
+
+	const uint8_t scanAngles[] = {135, SCAN_ANGLE_FRONT, 45};	// quet cheo truoc khi tranh vat can
+	Scan_SetAngles(scanAngles, sizeof(scanAngles));
+	Vfh_Init();
+
+	LineAdc_Start();					// cam bien line analog (chi khi LINE_ADC_ENABLE): ADC quet 5 kenh, DMA vong
+	detect_Line_Init();					// bang chan mang cam bien line truoc / sau
+	Line_Event_Init();					// loc cam bien line so trong ngat Timer, nhan dang giao lo
+	Line_Event_Start();					// Timer lay mau rieng, khong phu thuoc polling PS2
+}
+
 void updateAll(){
+	I2C_Mgr_Service();				// giam sat bus I2C dung chung (LCD, cam bien)
+	lcd_service();					// gui tiep khung hinh LCD sau lenh xoa man hinh
+	int16_t vx, vy, omega;
+	carGetVector(&vx, &vy, &omega);
+	Grid_Odometry(vx, vy, omega, HAL_GetTick());	// uoc luong vi tri xe theo lenh da ra
+	HCSR05_update();				// loc Echo cac cam bien sieu am, goi callback
+	Servo_Service();				// servo khong chan: bao on dinh theo goc quay
+	Scan_Service();					// servo quet nen, khong chan; moi buoc dua ngay vao ban do
+	PS2_Poll_Read(&ps2Pad, &ps2Input, &ps2InputAgeUs);	// doc trang thai PS2 tu polling nen, khong chan
+	PS2_Poll_Read(&ps2Operator, &ps2OperatorInput, NULL);
+	PS2_Link_Service();				// tu khoi tao lai tay cam khi xuat hien lai
+	ps2LinkUp = PS2_Link_Alive(&ps2Pad, ps2FailsafeUs);
+	if(!ps2LinkUp){
+		ps2Input.state.data.buttonData = 0;	// mat tin hieu: coi nhu nha het nut
+	}
+	if(!PS2_Link_Alive(&ps2Operator, ps2FailsafeUs)){
+		ps2OperatorInput.state.data.buttonData = 0;
+	}
+	// nut cau hinh (mode, khoang cach) nhan tu ca 2 tay cam
+	PS2_Event_Update(ps2Input.state.data.buttonData | ps2OperatorInput.state.data.buttonData, HAL_GetTick());
+	swap_Mode_PS2();				// lay het su kien moi vong (ca NONE): hang doi khong day, khong phat lai su kien cu
+	Latency_Probe_SetMode(mode);		// phan loai do tre theo che do
+	Latency_Probe_Enable(mode == CONTROL);	// chi do khi tay cam PS2 dieu khien dong co
+	if(mode != AUTO){
+		PS2_SetRumble(&ps2Pad, 0, 0);	// chi rung bao vat can trong che do AUTO
+		Scan_Stop();					// chi quet servo trong che do AUTO
+	}
 	switch(mode){
 		case CONTROL:
-			PS2_Update();
 			control_PS2();
-			swap_Mode_PS2();
 			break;
 		case AUTO:
-			PS2_Update();
-			swap_Mode_PS2();
 			update_status_car();
 			break;
 		case LINE:
-			PS2_Update();
-			swap_Mode_PS2();
 			update_Detect_Line();
 			break;
 		default:
@@ -38,29 +139,51 @@ void updateAll(){
 }
 
 // config mode with ps2
+// moi lan nhan nut chi tao 1 hanh dong, giu TRIANGLE/CROSS se lap lai theo chu ky
 void swap_Mode_PS2(void){
-	if(ps2->button.CIRCLE){					// MODE
-		if(mode < 3)
-				mode++;
-		if(mode >= 3)
-				mode = CONTROL;
-		set = NOT;
-	}else if(ps2->button.TRIANGLE){	//UP
-		if(mode == AUTO){
-			if(distance < DISTANCE_MAX)
-				distance += 5;
-			if(distance >= DISTANCE_MAX)
-				distance = DISTANCE_MIN;
-		}	
-	}else if(ps2->button.CROSS){		//DOWN
-		if(mode == AUTO){
-			if(distance > DISTANCE_MIN)
-					distance -= 5;
-			if(distance < DISTANCE_MIN)
+	PS2_Event event;
+
+	while(PS2_Event_Get(&event)){
+		if(event.type != PS2_EVENT_PRESS && event.type != PS2_EVENT_REPEAT)
+			continue;
+
+		if(event.mask == PSB_CIRCLE && event.type == PS2_EVENT_PRESS){	// MODE
+			if(mode < 3)
+					mode++;
+			if(mode >= 3)
+					mode = CONTROL;
+			set = NOT;
+		}else if(event.mask == PSB_TRIANGLE){	//UP
+			if(mode == LINE && event.type == PS2_EVENT_PRESS){
+				Route_Start(&lineRoute);	// chay lo trinh tu giao lo tiep theo
+				set = NOT;
+			}
+			if(mode == AUTO){
+				if(distance < DISTANCE_MAX)
+					distance += 5;
+				if(distance >= DISTANCE_MAX)
 					distance = DISTANCE_MIN;
+			}	
+		}else if(event.mask == PSB_CROSS){		//DOWN
+			if(mode == LINE && event.type == PS2_EVENT_PRESS){
+				Route_Start(NULL);			// dung lo trinh, chi do line
+				set = NOT;
+			}
+			if(mode == AUTO){
+				if(distance > DISTANCE_MIN)
+						distance -= 5;
+				if(distance < DISTANCE_MIN)
+						distance = DISTANCE_MIN;
+			}
+		}else if(event.mask == PSB_SQUARE){
+			if(mode == LINE && event.type == PS2_EVENT_PRESS)
+				Line_StartCalibration();	// dat xe tren line: quay qua lai do min/max cam bien analog
+		}else if(event.mask == PSB_L1 && event.type == PS2_EVENT_PRESS){
+			if(mode == LINE){
+				Line_SetDirection(-Line_GetDirection());	// doi chieu di: dung mang cam bien con lai, khong quay dau
+				set = NOT;
+			}
 		}
-	}else if(ps2->button.SQUARE){
-		
 	}
 }
 
@@ -85,7 +208,14 @@ void display_LCD(){
 	}else if(mode == LINE){
 			lcd_clear();
 			lcd_set_cursor(1,1);
-			lcd_send_string("DETECT LINE MODE");
+			lcd_send_string(Line_GetDirection() > 0 ? "DETECT LINE MODE" : "DETECT LINE REAR");
+			if(routeProgress.name != NULL){
+				static const char routeStateText[] = "-FATDE";	// IDLE, FOLLOW, ADVANCE, TURN, DONE, FAILED
+				lcd_set_cursor(1,2);
+				snprintf(buf, sizeof(buf), "%-6.6s%2u/%-2u %c %c", routeProgress.name, routeProgress.step, routeProgress.total,
+						routeProgress.action ? routeProgress.action : ' ', routeStateText[routeProgress.state]);
+				lcd_send_string(buf);
+			}
 	}
 }
 ////////////////////////////////////////////////////////
@@ -97,34 +227,51 @@ void display_LCD(){
 //  
 */
 void control_PS2(void){
-	if(ps2->button.UP){
-		if(ps2->button.LEFT){
+	PS2_StickCommand stick;
+
+	// failsafe: khong nhan khung hop le trong ps2FailsafeUs thi dung xe
+	if(!ps2LinkUp){
+		carStop();
+		return;
+	}
+	Latency_Probe_Motion(ps2Input.frame);	// lenh ben duoi tinh tu anh chup nay
+
+	// che do analog: joystick trai tinh tien, joystick phai quay, toc do thay doi lien tuc
+	if(ps2Input.mode && PS2_Stick_Map(ps2Input.state.button.LX, ps2Input.state.button.LY,
+									ps2Input.state.button.RX, &stick)){
+		carMoveVector(stick.vx, stick.vy, stick.omega);
+		return;
+	}
+
+	// joystick o giua hoac che do digital: dung D-pad nhu truoc
+	if(ps2Input.state.button.UP){
+		if(ps2Input.state.button.LEFT){
 			carLeftForword(50);
-		}else if(ps2->button.RIGHT){
+		}else if(ps2Input.state.button.RIGHT){
 			carRightForword(50);
 		}else{
 			carForward(50);
 		}
 	}
-	else if(ps2->button.DOWN){
-		if(ps2->button.LEFT){
+	else if(ps2Input.state.button.DOWN){
+		if(ps2Input.state.button.LEFT){
 			carLeftBackward(50);
-		}else if(ps2->button.RIGHT){
+		}else if(ps2Input.state.button.RIGHT){
 			carRightBackward(50);
 		}else{
 			carBackward(50);
 		}
 	}
-	else if(ps2->button.LEFT){
+	else if(ps2Input.state.button.LEFT){
 		carLeft(50);
 	}
-	else if(ps2->button.RIGHT){
+	else if(ps2Input.state.button.RIGHT){
 		carRight(50);
 	}
-//	else if(ps2->button.L1){
+//	else if(ps2Input.state.button.L1){
 //		carTurnLeftDrift(80);
 //	}
-	else if(ps2->button.R1){
+	else if(ps2Input.state.button.R1){
 		carTurnRightDrift(80);
 	}
 	else
@@ -142,68 +289,34 @@ void control_PS2(void){
 
 
 // dieu khien xe
-// Di thang
-// b1: neu distance < 20cm => dung xe, quay trai do kc trai luu lai, quay phai do kc phai luu lai, tra servo ve dang truoc
-// b1.1 neu ca 2 deu < 20 => lui xe va tiep tuc do lai tai b1
-// b1.2 1.3 neu phai >= trai => re phai else re tri
-// di thang
+// Tranh vat can phan xa (VFH): servo quet cheo lien tuc, 4 cam bien va luot quet dua vao ban do,
+// moi chu ky dieu khien chon huong trong gan phia truoc nhat va di ngang (mecanum) vong qua vat can
+// khong dung xe; toc do giam khi vat can day dac, het huong trong thi quay tai cho
+// lenh cuoi cung qua bo gioi han: van toc ve moi huong khong vuot qua muc con phanh kip
+// (theo khoang cach, van toc tiep can do duoc va thoi gian va cham) nen co the chay nhanh hon
+
+// rung tay cam khi vat can lai gan: bat dau tu 2 * distance, manh nhat o 0 cm
+void rumble_Obstacle(float dis){
+	uint16_t range = 2 * distance;
+
+	if(dis >= range){
+		PS2_SetRumble(&ps2Pad, 0, 0);
+	}else{
+		PS2_SetRumble(&ps2Pad, dis < distance, (uint8_t)(255 - dis * 255 / range));
+	}
+}
 
 void update_status_car(){
-	float disLeft, disRight;
-//	float dis;
-
-	if(flag_obstacle == 0){
-//		dis = HCSR05_update();
-		if(HCSR05_update() < distance){
-			// xu ly dung xe
-			autoHandle_Stop();
-			// BAT CO CO VAT CAN
-			flag_obstacle = 1;		
-		}
-		else{
-			// xu ly di thang
-			autoHalde_Head();
-		}
-		//NHAY RA NGOAI
-	}else{ // flag_obstacle == 1
-		// DO TRAI PHAI
-		SERVO_LEFT;
-		HAL_Delay(1000);
-		disLeft = HCSR05_update(); 
-		SERVO_RIGHT;
-		HAL_Delay(1000);
-		disRight = HCSR05_update();
-		SERVO_FRONT;
-		HAL_Delay(1000);
-		
-		// TH 1.1
-		if((disLeft < 30) && (disRight < 30)){
-			// TH 1.1.1
-			if((disLeft > 15) && (disRight > 15) && (flag_turn_car == 0)){
-				// XY LY QUAY DAU
-				autoHandle_Turn();
-				// BAT CO QUAY DAU LEN 1
-				flag_turn_car = 1;
-			}else if(flag_turn_car == 1){
-				// xy ly di thang 1 doan ngan
-				autoHandle_HeadSlow();			
-			}else{	// TH 1.1.2	
-				// xy ly di lui
-				autoHandle_Reverse();
-			}
-		}else if(disRight >= disLeft){	// TH 1.2
-			// xy ly re phai
-			autoHandle_Right();
-			//clear het cac co
-			flag_obstacle = 0;
-			flag_turn_car = 0;
-		}else{													// TH 1.3
-			// xy ly re trai
-			autoHandle_Left();
-			//clear het cac co
-			flag_obstacle = 0;
-			flag_turn_car = 0;
-		}
+	rumble_Obstacle(Grid_Clearance(GRID_BEARING_FRONT) / 10.0f);
+	if(!Scan_Busy())
+		Scan_Start(1);				// quet qua lai lien tuc trong che do AUTO
+
+	Vfh_SetSafeDistance(distance * 10);	// khoang cach cai dat (cm) lam vung an toan quanh xe
+	Guard_SetMargin(distance * 10);
+	if(Vfh_Update(HAL_GetTick(), &avoidCommand)){
+		// giam / dung thanh phan van toc ve phia vat can neu khong kip phanh
+		Guard_Limit(&avoidCommand.vx, &avoidCommand.vy);
+		carMoveVector(avoidCommand.vx, avoidCommand.vy, avoidCommand.omega);
 	}
 }
 
@@ -214,10 +327,18 @@ void update_status_car(){
 //  
 */
 
-void (* handleLine[])(void) = {lineHandle_Head, lineHandle_Left, lineHandle_Right, lineHandle_Turn_Left, lineHandle_Turn_Right};
-
+// PID theo vi tri line (trong tam cac cam bien), lenh quay + di ngang gui lien tuc, khong dung xe giua cac mau
+// TRIANGLE chay lo trinh: dem giao lo, tai moi giao lo tien vao giua roi quay den khi bat duoc nhanh moi
 void update_Detect_Line(){
-	detect_Line(handleLine);
+	Route_Progress progress;
+
+	Line_Update(HAL_GetTick());
+	Line_Log_Dump();					// gui nhat ky lich toc do qua Line_Log_Write (mac dinh SWO khi debugger bat ITM)
+	Route_GetProgress(&progress);
+	if(progress.step != routeProgress.step || progress.state != routeProgress.state || progress.name != routeProgress.name){
+		routeProgress = progress;
+		set = NOT;						// cap nhat tien do tren LCD
+	}
 }
 
 
@@ -11,7 +11,148 @@
 /* ============================================[ INCLUDE FILE ]============================================*/
 #include "i2c-lcd.h"
 
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define LCD_ENTER_CRITICAL()    uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define LCD_EXIT_CRITICAL()     __set_PRIMASK(primask)
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+static uint8_t  lcdTx[LCD_TX_BUFFER_SIZE];                  //**< Bộ đệm vòng dữ liệu chờ gửi     >**/
+static volatile uint16_t lcdHead = 0;                       //**< Vị trí ghi (vòng lặp chính)     >**/
+static volatile uint16_t lcdTail = 0;                       //**< Vị trí đọc (ngắt hoàn thành)    >**/
+static volatile uint16_t lcdInFlight = 0;                   //**< Số byte đang truyền DMA         >**/
+static uint8_t  lcdClient = I2C_MGR_INVALID_CLIENT;         //**< Mã client trên bus I2C          >**/
+
+static volatile uint8_t  lcdFrameDropped = 0;               //**< Cờ khung hình hiện tại bị bỏ    >**/
+static volatile uint32_t lcdDroppedFrames = 0;              //**< Số khung hình đã bị bỏ          >**/
+
+static volatile uint8_t  lcdHoldPending = 0;                //**< Có lệnh xóa màn hình chờ gửi    >**/
+static volatile uint16_t lcdHoldPos = 0;                    //**< Vị trí ngay sau lệnh xóa        >**/
+static volatile uint8_t  lcdHolding = 0;                    //**< Đang chờ LCD xóa màn hình       >**/
+static volatile uint32_t lcdHoldStartUs = 0;                //**< Thời điểm lệnh xóa gửi xong (us) >**/
+
 /* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+/**
+ * @brief   Hàm nội bộ bỏ phần còn lại của khung hình hiện tại
+ * @details Xóa dữ liệu đang chờ trong bộ đệm và đánh dấu bỏ khung hình.
+ * @note    Gọi trong vùng tới hạn hoặc trong ngắt.
+ * @param   void
+ * @return  void
+ **/
+static void lcd_drop_frame (void)
+{
+	lcdHead = (lcdTail + lcdInFlight) % LCD_TX_BUFFER_SIZE;	//**< Giữ lại phần đang truyền >**/
+	if (lcdHoldPending && lcdHoldPos != lcdHead)
+		lcdHoldPending = 0;								//**< Lệnh xóa bị bỏ cùng khung hình >**/
+	if (!lcdFrameDropped)
+	{
+		lcdFrameDropped = 1;
+		lcdDroppedFrames++;
+	}
+}
+
+static void lcd_tx_done (uint8_t client, I2C_Bus_Status status, void *context);
+
+/**
+ * @brief   Hàm nội bộ gửi đoạn dữ liệu tiếp theo trong bộ đệm vào hàng đợi I2C
+ * @details Mỗi lần chỉ có 1 đoạn tối đa LCD_I2C_CHUNK byte đang chờ/truyền, nên giao dịch
+ *          của client ưu tiên cao hơn chỉ phải chờ tối đa 1 đoạn dữ liệu hiển thị.
+ * @note    Gọi trong vùng tới hạn hoặc trong ngắt.
+ * @param   void
+ * @return  void
+ **/
+static void lcd_kick (void)
+{
+	I2C_Mgr_Request request = {0};
+	uint16_t length;
+
+	if (lcdInFlight || lcdHead == lcdTail)
+		return;
+	if (lcdHolding)
+	{
+		if (TIMEBASE_ELAPSED(Timebase_Micros(), lcdHoldStartUs) < LCD_CLEAR_HOLD_US)
+			return;										//**< LCD đang xóa màn hình >**/
+		lcdHolding = 0;
+	}
+
+	length = (lcdHead > lcdTail) ? (lcdHead - lcdTail) : (LCD_TX_BUFFER_SIZE - lcdTail);	//**< Đoạn liên tục >**/
+	if (length > LCD_I2C_CHUNK)
+		length = LCD_I2C_CHUNK;
+	if (lcdHoldPending && (uint16_t)((lcdHoldPos + LCD_TX_BUFFER_SIZE - lcdTail) % LCD_TX_BUFFER_SIZE) < length)
+		length = (lcdHoldPos + LCD_TX_BUFFER_SIZE - lcdTail) % LCD_TX_BUFFER_SIZE;	//**< Lệnh xóa kết thúc đoạn >**/
+
+	request.op         = I2C_MGR_WRITE;
+	request.address    = SLAVE_ADDRESS_LCD;
+	request.data       = &lcdTx[lcdTail];
+	request.length     = length;
+	request.deadlineUs = LCD_I2C_DEADLINE_US;
+	request.callback   = lcd_tx_done;
+
+	lcdInFlight = length;
+	if (I2C_Mgr_Submit(lcdClient, &request) != I2C_BUS_OK)
+	{
+		lcdInFlight = 0;
+		lcd_drop_frame();
+	}
+}
+
+/**
+ * @brief   Hàm nội bộ callback khi một đoạn dữ liệu LCD đã truyền xong (gọi trong ngắt)
+ * @param   client   Mã client LCD
+ * @param   status   Kết quả giao dịch
+ * @param   context  Không sử dụng
+ * @return  void
+ **/
+static void lcd_tx_done (uint8_t client, I2C_Bus_Status status, void *context)
+{
+	(void)client;
+	(void)context;
+
+	lcdTail = (lcdTail + lcdInFlight) % LCD_TX_BUFFER_SIZE;
+	lcdInFlight = 0;
+	if (lcdHoldPending && lcdTail == lcdHoldPos)
+	{
+		lcdHoldPending = 0;								//**< Lệnh xóa đã gửi: chờ LCD xóa xong >**/
+		lcdHolding     = 1;
+		lcdHoldStartUs = Timebase_Micros();
+	}
+	if (status != I2C_BUS_OK)
+	{
+		lcd_drop_frame();
+	}
+	lcd_kick();
+}
+
+/**
+ * @brief   Hàm nội bộ ghi 4 byte (2 nibble kèm xung EN) vào bộ đệm gửi LCD
+ * @details Hàm không chặn: dữ liệu được truyền bằng DMA qua i2c_manager.
+ *          Nếu khung hình đã bị bỏ hoặc bộ đệm đầy thì bỏ phần còn lại của khung hình.
+ * @param   data_t  Dữ liệu 4 byte cần gửi
+ * @return  void
+ **/
+static void lcd_write (uint8_t data_t[4])
+{
+	LCD_ENTER_CRITICAL();
+	uint16_t used = (lcdHead + LCD_TX_BUFFER_SIZE - lcdTail) % LCD_TX_BUFFER_SIZE;
+
+	if (!lcdFrameDropped)
+	{
+		if (LCD_TX_BUFFER_SIZE - 1 - used < 4)
+		{
+			lcd_drop_frame();							//**< Bus không kịp xả: bỏ khung hình >**/
+		}
+		else
+		{
+			for (uint8_t i = 0; i < 4; i++)
+			{
+				lcdTx[lcdHead] = data_t[i];
+				lcdHead = (lcdHead + 1) % LCD_TX_BUFFER_SIZE;
+			}
+			lcd_kick();
+		}
+	}
+	LCD_EXIT_CRITICAL();
+}
+
 /**
  * @brief   Hàm khởi tạo LCD I2C
  * @details Hàm này sẽ khởi tạo LCD I2C bằng cách gửi các lệnh cấu hình ban đầu đến LCD.
@@ -22,6 +163,9 @@
  **/
 void lcd_init (void)
 {
+	if (lcdClient == I2C_MGR_INVALID_CLIENT)
+		lcdClient = I2C_Mgr_RegisterClient(I2C_MGR_PRIORITY_LOW);	//**< LCD là client ưu tiên thấp >**/
+
 	HAL_Delay(50);  			//**< Đợi trên 40ms >**/
 	lcd_send_cmd (0x30);		//**< Gửi lệnh 0x30 >**/
 	HAL_Delay(5);  				//**< Đợi trên 4.1ms >**/
@@ -65,7 +209,7 @@ void lcd_send_cmd (char cmd)
 	data_t[1] = data_u|0x08;  		//**<en=0, rs=0 >**/
 	data_t[2] = data_l|0x0C;  		//**<en=1, rs=0 >**/
 	data_t[3] = data_l|0x08;  		//**<en=0, rs=0 >**/
-	HAL_I2C_Master_Transmit (&hi2c1, SLAVE_ADDRESS_LCD,(uint8_t *) data_t, 4, 100);
+	lcd_write(data_t);
 }
 
 /**
@@ -87,25 +231,33 @@ void lcd_send_data (char data)
 	data_t[1] = data_u|0x09;  			//**<en=0, rs=1 >**/
 	data_t[2] = data_l|0x0D;  			//**<en=1, rs=1 >**/
 	data_t[3] = data_l|0x09;  			//**<en=0, rs=1 >**/
-	HAL_I2C_Master_Transmit (&hi2c1, SLAVE_ADDRESS_LCD,(uint8_t *) data_t, 4, 100);
+	lcd_write(data_t);
 }
 
 
 /**
  * @brief   Hàm xóa màn hình LCD I2C
- * @details Hàm này sẽ gửi dữ liệu đến LCD I2C bằng cách sử dụng giao thức I2C.
- * 		 	Nó sẽ gửi dữ liệu toàn bộ là khoảng trống
+ * @details Hàm này gửi lệnh Clear display 0x01 (4 byte thay vì 100 khoảng trống = 400 byte),
+ *          đoạn I2C chứa lệnh kết thúc ngay sau lệnh và dữ liệu tiếp theo chờ LCD_CLEAR_HOLD_US.
+ *          Chỉ có 1 vị trí chờ: nếu lệnh xóa trước chưa gửi xong thì phần chưa gửi của khung hình trước
+ *          bị bỏ (tính là khung hình bị bỏ). Lệnh xóa trước đang truyền thì được dùng lại cho khung hình mới.
  * @note    Hàm này sẽ được gọi để xóa dữ liệu trên LCD.
  * @param   void
  * @return  void
  **/
 void lcd_clear (void)
 {
-	lcd_send_cmd (0x00);
-	for (int i=0; i<100; i++)
+	LCD_ENTER_CRITICAL();
+	if (lcdHoldPending)
+		lcd_drop_frame();				//**< Khung hình trước chưa gửi hết lệnh xóa: bỏ phần còn lại >**/
+	lcdFrameDropped = 0;			//**< Bắt đầu khung hình mới >**/
+	if (!lcdHoldPending)
 	{
-		lcd_send_data (' ');
+		lcdHoldPos     = (lcdHead + 4) % LCD_TX_BUFFER_SIZE;	//**< Giữ dữ liệu sau lệnh đến khi LCD xóa xong >**/
+		lcdHoldPending = 1;
+		lcd_send_cmd (0x01);
 	}
+	LCD_EXIT_CRITICAL();
 }
 
 
@@ -150,3 +302,38 @@ void lcd_send_string (char *str)
 }
 
 
+/**
+ * @brief   Hàm kiểm tra khung hình hiện tại có bị bỏ hay không
+ * @param   void
+ * @return  uint8_t     1 nếu khung hình hiện tại đã bị bỏ
+ **/
+uint8_t lcd_frame_dropped (void)
+{
+	return lcdFrameDropped;
+}
+
+
+/**
+ * @brief   Hàm tiếp tục gửi dữ liệu sau thời gian chờ lệnh xóa màn hình
+ * @param   void
+ * @return  void
+ **/
+void lcd_service (void)
+{
+	if (!lcdHolding)
+		return;
+	LCD_ENTER_CRITICAL();
+	lcd_kick();
+	LCD_EXIT_CRITICAL();
+}
+
+
+/**
+ * @brief   Hàm đọc số khung hình LCD đã bị bỏ
+ * @param   void
+ * @return  uint32_t    Số khung hình đã bị bỏ kể từ khi khởi động
+ **/
+uint32_t lcd_dropped_frames (void)
+{
+	return lcdDroppedFrames;
+}
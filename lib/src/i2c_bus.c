@@ -0,0 +1,211 @@
+/*********************************************************************************************************************
+ * @file    i2c_bus.c
+ * @brief   Thư viện truy cập bus I2C với thời gian chặn giới hạn
+ * @details Triển khai các hàm truyền dữ liệu I2C với deadline tính bằng micro giây, thử lại khi lỗi,
+ *          bộ đếm lỗi và tự động giải phóng bus (đảo chân SCL) khi bus bị treo.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "i2c_bus.h"                    //**< Thư viện truy cập bus I2C >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+static I2C_Bus_Stats busStats = {0};            //**< Bộ đếm thống kê của bus           >**/
+static uint8_t  busSuspended = 0;               //**< Cờ bus đang tạm ngưng             >**/
+static uint32_t busSuspendStart = 0;            //**< Thời điểm bắt đầu tạm ngưng (us)  >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ ghi lại thời gian chặn của một giao dịch
+ * @param   start   Thời điểm bắt đầu giao dịch (us)
+ * @return  void
+ **/
+static void I2C_Bus_RecordBlock(uint32_t start)
+{
+    busStats.lastBlockUs = TIMEBASE_ELAPSED(Timebase_Micros(), start);
+    if (busStats.lastBlockUs > busStats.maxBlockUs) {
+        busStats.maxBlockUs = busStats.lastBlockUs;
+    }
+}
+
+
+/**
+ * @brief   Hàm nội bộ cấu hình chân GPIO khi giải phóng bus
+ * @param   port    Port GPIO của chân cần cấu hình
+ * @param   pin     Chân GPIO cần cấu hình
+ * @param   mode    Chế độ GPIO (GPIO_MODE_OUTPUT_OD hoặc GPIO_MODE_INPUT)
+ * @return  void
+ **/
+static void I2C_Bus_ConfigPin(GPIO_TypeDef *port, uint16_t pin, uint32_t mode)
+{
+    GPIO_InitTypeDef gpio = {0};
+
+    gpio.Pin   = pin;
+    gpio.Mode  = mode;
+    gpio.Pull  = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(port, &gpio);
+}
+
+
+/**
+ * @brief   Hàm giải phóng bus I2C bị treo
+ * @details Hàm này tắt ngoại vi I2C, đảo chân SCL tối đa I2C_BUS_RECOVERY_CLOCKS lần
+ *          cho đến khi thiết bị slave nhả SDA, tạo điều kiện STOP rồi khởi tạo lại ngoại vi.
+ *          Thời gian thực hiện tối đa khoảng 2 * I2C_BUS_RECOVERY_CLOCKS * I2C_BUS_HALF_PERIOD_US.
+ * @param   void
+ * @return  uint8_t     1 nếu SDA đã được nhả, 0 nếu bus vẫn bị giữ
+ **/
+uint8_t I2C_Bus_Recover(void)
+{
+    uint8_t released;
+
+    busStats.recoveries++;
+    HAL_I2C_DeInit(&I2C_BUS_HANDLE);                                        //**< Trả chân về GPIO          >**/
+
+    HAL_GPIO_WritePin(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, GPIO_PIN_SET);
+    I2C_Bus_ConfigPin(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, GPIO_MODE_OUTPUT_OD);
+    I2C_Bus_ConfigPin(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, GPIO_MODE_INPUT);
+
+    for (uint8_t i = 0; i < I2C_BUS_RECOVERY_CLOCKS; i++) {                //**< Đảo SCL đến khi SDA được nhả >**/
+        if (HAL_GPIO_ReadPin(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN) == GPIO_PIN_SET)
+            break;
+        HAL_GPIO_WritePin(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, GPIO_PIN_RESET);
+        Timebase_DelayUs(I2C_BUS_HALF_PERIOD_US);
+        HAL_GPIO_WritePin(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, GPIO_PIN_SET);
+        Timebase_DelayUs(I2C_BUS_HALF_PERIOD_US);
+    }
+    released = (HAL_GPIO_ReadPin(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN) == GPIO_PIN_SET);
+
+    HAL_GPIO_WritePin(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, GPIO_PIN_RESET);  //**< Tạo điều kiện STOP:       >**/
+    I2C_Bus_ConfigPin(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, GPIO_MODE_OUTPUT_OD);
+    Timebase_DelayUs(I2C_BUS_HALF_PERIOD_US);                               //**< SDA lên khi SCL đang cao  >**/
+    HAL_GPIO_WritePin(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, GPIO_PIN_SET);
+    Timebase_DelayUs(I2C_BUS_HALF_PERIOD_US);
+
+    I2C_BUS_HANDLE.Instance->CR1 |= I2C_CR1_SWRST;                          //**< Reset logic của ngoại vi  >**/
+    I2C_BUS_HANDLE.Instance->CR1 &= ~I2C_CR1_SWRST;
+    HAL_I2C_Init(&I2C_BUS_HANDLE);                                          //**< MspInit cấu hình lại AF   >**/
+
+    if (!released) {                                                        //**< Slave vẫn giữ bus: tạm ngưng >**/
+        busSuspended = 1;
+        busSuspendStart = Timebase_Micros();
+    }
+    return released;
+}
+
+
+/**
+ * @brief   Hàm kiểm tra bus có sẵn sàng nhận giao dịch hay không
+ * @param   void
+ * @return  uint8_t     1 nếu bus sẵn sàng, 0 nếu đang tạm ngưng
+ **/
+uint8_t I2C_Bus_IsAvailable(void)
+{
+    if (busSuspended && TIMEBASE_ELAPSED(Timebase_Micros(), busSuspendStart) >= I2C_BUS_BACKOFF_US) {
+        busSuspended = 0;                                                   //**< Hết thời gian tạm ngưng, thử lại >**/
+    }
+    return !busSuspended;
+}
+
+
+/**
+ * @brief   Hàm truyền dữ liệu I2C với deadline micro giây
+ * @details Hàm này khởi động truyền bằng ngắt (HAL_I2C_Master_Transmit_IT) và chờ tối đa deadlineUs.
+ *          Khi NACK sẽ thử lại trong phạm vi deadline; khi mất quyền điều khiển bus, lỗi bus
+ *          hoặc hết deadline sẽ hủy giao dịch và giải phóng bus.
+ * @param   address     Địa chỉ I2C 8 bit của thiết bị
+ * @param   data        Dữ liệu cần truyền
+ * @param   length      Số byte cần truyền
+ * @param   deadlineUs  Thời gian chặn tối đa (us)
+ * @return  I2C_Bus_Status  Kết quả truyền
+ **/
+I2C_Bus_Status I2C_Bus_Transmit(uint16_t address, uint8_t *data, uint16_t length, uint32_t deadlineUs)
+{
+    uint32_t start = Timebase_Micros();
+    uint32_t error = HAL_I2C_ERROR_NONE;
+
+    if (!I2C_Bus_IsAvailable()) {
+        busStats.dropped++;
+        return I2C_BUS_DROPPED;
+    }
+    if (HAL_I2C_GetState(&I2C_BUS_HANDLE) != HAL_I2C_STATE_READY) {        //**< Giao dịch trước chưa kết thúc >**/
+        I2C_Bus_Recover();
+    }
+
+    for (uint8_t attempt = 0; attempt <= I2C_BUS_RETRIES; attempt++) {
+        if (attempt > 0) {
+            busStats.retries++;
+        }
+        if (HAL_I2C_Master_Transmit_IT(&I2C_BUS_HANDLE, address, data, length) != HAL_OK) {
+            busStats.busErrors++;
+            error = HAL_I2C_ERROR_BERR;
+            I2C_Bus_Recover();
+            break;
+        }
+
+        while (HAL_I2C_GetState(&I2C_BUS_HANDLE) != HAL_I2C_STATE_READY) {
+            if (TIMEBASE_ELAPSED(Timebase_Micros(), start) >= deadlineUs) {    //**< Hết deadline >**/
+                busStats.timeouts++;
+                HAL_I2C_Master_Abort_IT(&I2C_BUS_HANDLE, address);
+                I2C_Bus_Recover();
+                I2C_Bus_RecordBlock(start);
+                return I2C_BUS_TIMEOUT;
+            }
+#ifdef HOST_SIM
+            Timebase_SimAdvance(1);                                         //**< Đồng hồ ảo không tự chạy khi chờ bận >**/
+#endif
+        }
+
+        error = HAL_I2C_GetError(&I2C_BUS_HANDLE);
+        if (error == HAL_I2C_ERROR_NONE) {
+            busStats.transfers++;
+            I2C_Bus_RecordBlock(start);
+            return I2C_BUS_OK;
+        }
+
+        if (error & HAL_I2C_ERROR_AF) {                                     //**< NACK: thử lại nếu còn thời gian >**/
+            busStats.nacks++;
+            if (TIMEBASE_ELAPSED(Timebase_Micros(), start) >= deadlineUs) {
+                I2C_Bus_RecordBlock(start);
+                return I2C_BUS_NACK;
+            }
+            continue;
+        }
+
+        if (error & HAL_I2C_ERROR_ARLO) {                                   //**< Mất quyền điều khiển bus >**/
+            busStats.arbitrationLost++;
+        } else {
+            busStats.busErrors++;
+        }
+        I2C_Bus_Recover();
+        break;
+    }
+
+    I2C_Bus_RecordBlock(start);
+    return (error & HAL_I2C_ERROR_AF) ? I2C_BUS_NACK : I2C_BUS_ERROR;
+}
+
+
+/**
+ * @brief   Hàm đọc bộ đếm thống kê của bus I2C
+ * @param   void
+ * @return  const I2C_Bus_Stats*    Con trỏ đến bộ đếm thống kê
+ **/
+const I2C_Bus_Stats *I2C_Bus_GetStats(void)
+{
+    return &busStats;
+}
+
+
+/**
+ * @brief   Hàm xóa bộ đếm thống kê của bus I2C
+ * @param   void
+ * @return  void
+ **/
+void I2C_Bus_ResetStats(void)
+{
+    I2C_Bus_Stats empty = {0};
+    busStats = empty;
+}
@@ -0,0 +1,378 @@
+/*********************************************************************************************************************
+ * @file    i2c_manager.c
+ * @brief   Thư viện quản lý giao dịch trên bus I2C1 dùng chung
+ * @details Triển khai hàng đợi giao dịch có độ ưu tiên và deadline, thực hiện bằng DMA.
+ *          Giao dịch tiếp theo được chọn trong ngắt hoàn thành của giao dịch trước,
+ *          vì vậy client ưu tiên cao chỉ phải chờ tối đa một giao dịch đang chạy.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "i2c_manager.h"                //**< Thư viện quản lý bus I2C dùng chung >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define I2C_MGR_NO_SLOT         0xFF    //**< Không có giao dịch đang chạy >**/
+
+#define I2C_MGR_ENTER_CRITICAL()    uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define I2C_MGR_EXIT_CRITICAL()     __set_PRIMASK(primask)
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Trạng thái của một ô trong hàng đợi
+ **/
+typedef enum {
+    SLOT_FREE    = 0,                   //**< Ô trống                   >**/
+    SLOT_PENDING = 1,                   //**< Giao dịch đang chờ        >**/
+    SLOT_ACTIVE  = 2                    //**< Giao dịch đang chạy DMA   >**/
+} I2C_Mgr_SlotState;
+
+/**
+ * @brief   Một ô trong hàng đợi giao dịch
+ **/
+typedef struct {
+    I2C_Mgr_Request     request;        //**< Thông tin giao dịch               >**/
+    uint8_t             client;         //**< Client sở hữu giao dịch           >**/
+    volatile uint8_t    state;          //**< Trạng thái ô (I2C_Mgr_SlotState)  >**/
+    uint32_t            enqueueUs;      //**< Thời điểm vào hàng đợi (us)       >**/
+    uint32_t            startUs;        //**< Thời điểm bắt đầu DMA (us)        >**/
+} I2C_Mgr_Slot;
+
+static I2C_Mgr_Slot        slots[I2C_MGR_QUEUE_SIZE];               //**< Hàng đợi giao dịch            >**/
+static I2C_Mgr_ClientStats clientStats[I2C_MGR_MAX_CLIENTS];        //**< Thống kê từng client          >**/
+static uint8_t             clientPriority[I2C_MGR_MAX_CLIENTS];     //**< Độ ưu tiên từng client        >**/
+static uint8_t             clientCount = 0;                         //**< Số client đã đăng ký          >**/
+
+static volatile uint8_t    activeSlot = I2C_MGR_NO_SLOT;            //**< Ô đang chạy DMA               >**/
+static volatile uint8_t    recoverPending = 0;                      //**< Cần giải phóng bus            >**/
+static volatile uint8_t    scheduling = 0;                          //**< Chống gọi lồng bộ lập lịch    >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ kết thúc một giao dịch: cập nhật thống kê, giải phóng ô và gọi callback
+ * @param   index   Vị trí ô trong hàng đợi
+ * @param   status  Kết quả giao dịch
+ * @return  void
+ **/
+static void I2C_Mgr_Finish(uint8_t index, I2C_Bus_Status status)
+{
+    I2C_Mgr_Slot *slot = &slots[index];
+    I2C_Mgr_ClientStats *stats = &clientStats[slot->client];
+    I2C_Mgr_Callback callback = slot->request.callback;
+    void *context = slot->request.context;
+    uint8_t client = slot->client;
+    uint32_t latency = TIMEBASE_ELAPSED(Timebase_Micros(), slot->enqueueUs);
+
+    if (status == I2C_BUS_OK) {
+        stats->completed++;
+        stats->lastLatencyUs = latency;
+        stats->sumLatencyUs += latency;
+        if (latency > stats->maxLatencyUs)
+            stats->maxLatencyUs = latency;
+        if (latency > slot->request.deadlineUs)
+            stats->deadlineMisses++;
+    } else if (status == I2C_BUS_TIMEOUT && slot->state == SLOT_PENDING) {
+        stats->expired++;                                   //**< Chưa kịp chạy đã hết deadline >**/
+    } else {
+        stats->failed++;
+    }
+
+    slot->state = SLOT_FREE;                                //**< Giải phóng trước để callback gửi tiếp được >**/
+    if (callback != NULL)
+        callback(client, status, context);
+}
+
+
+/**
+ * @brief   Hàm nội bộ khởi động DMA cho một giao dịch
+ * @param   request     Thông tin giao dịch
+ * @return  HAL_StatusTypeDef   Kết quả khởi động của HAL
+ **/
+static HAL_StatusTypeDef I2C_Mgr_StartDMA(const I2C_Mgr_Request *request)
+{
+    switch (request->op) {
+        case I2C_MGR_WRITE:
+            return HAL_I2C_Master_Transmit_DMA(&I2C_BUS_HANDLE, request->address, request->data, request->length);
+        case I2C_MGR_READ:
+            return HAL_I2C_Master_Receive_DMA(&I2C_BUS_HANDLE, request->address, request->data, request->length);
+        case I2C_MGR_MEM_WRITE:
+            return HAL_I2C_Mem_Write_DMA(&I2C_BUS_HANDLE, request->address, request->memAddress,
+                                         request->memAddressSize, request->data, request->length);
+        case I2C_MGR_MEM_READ:
+            return HAL_I2C_Mem_Read_DMA(&I2C_BUS_HANDLE, request->address, request->memAddress,
+                                        request->memAddressSize, request->data, request->length);
+        default:
+            return HAL_ERROR;
+    }
+}
+
+
+/**
+ * @brief   Hàm nội bộ chọn giao dịch tiếp theo
+ * @details Chọn giao dịch có độ ưu tiên cao nhất; cùng độ ưu tiên thì chọn deadline còn lại ngắn nhất.
+ * @param   now     Thời điểm hiện tại (us)
+ * @return  uint8_t Vị trí ô được chọn, I2C_MGR_NO_SLOT nếu hàng đợi trống
+ **/
+static uint8_t I2C_Mgr_SelectNext(uint32_t now)
+{
+    uint8_t best = I2C_MGR_NO_SLOT;
+    uint8_t bestPriority = 0xFF;
+    int32_t bestSlack = INT32_MAX;
+
+    for (uint8_t i = 0; i < I2C_MGR_QUEUE_SIZE; i++) {
+        if (slots[i].state != SLOT_PENDING)
+            continue;
+        uint8_t priority = clientPriority[slots[i].client];
+        int32_t slack = (int32_t)(slots[i].request.deadlineUs - TIMEBASE_ELAPSED(now, slots[i].enqueueUs));
+        if (priority < bestPriority || (priority == bestPriority && slack < bestSlack)) {
+            best = i;
+            bestPriority = priority;
+            bestSlack = slack;
+        }
+    }
+    return best;
+}
+
+
+/**
+ * @brief   Hàm nội bộ khởi động giao dịch tiếp theo nếu bus đang rảnh
+ * @note    Gọi trong ngắt hoặc trong vùng tới hạn (đã tắt ngắt).
+ * @param   void
+ * @return  void
+ **/
+static void I2C_Mgr_StartNext(void)
+{
+    if (scheduling || recoverPending)
+        return;
+    scheduling = 1;
+
+    while (activeSlot == I2C_MGR_NO_SLOT) {
+        uint32_t now = Timebase_Micros();
+        uint8_t next = I2C_Mgr_SelectNext(now);
+        if (next == I2C_MGR_NO_SLOT)
+            break;
+
+        I2C_Mgr_Slot *slot = &slots[next];
+        if (TIMEBASE_ELAPSED(now, slot->enqueueUs) >= slot->request.deadlineUs) {
+            I2C_Mgr_Finish(next, I2C_BUS_TIMEOUT);          //**< Hết deadline khi còn trong hàng đợi >**/
+            continue;
+        }
+        if (!I2C_Bus_IsAvailable()) {
+            I2C_Mgr_Finish(next, I2C_BUS_DROPPED);          //**< Bus đang tạm ngưng >**/
+            continue;
+        }
+
+        slot->state = SLOT_ACTIVE;
+        slot->startUs = now;
+        activeSlot = next;
+        if (I2C_Mgr_StartDMA(&slot->request) != HAL_OK) {
+            activeSlot = I2C_MGR_NO_SLOT;
+            I2C_Mgr_Finish(next, I2C_BUS_ERROR);
+        }
+    }
+
+    scheduling = 0;
+}
+
+
+/**
+ * @brief   Hàm nội bộ xử lý khi giao dịch đang chạy kết thúc (gọi trong ngắt)
+ * @param   status  Kết quả giao dịch
+ * @return  void
+ **/
+static void I2C_Mgr_Complete(I2C_Bus_Status status)
+{
+    uint8_t index = activeSlot;
+
+    if (index == I2C_MGR_NO_SLOT)                           //**< Giao dịch không thuộc bộ quản lý >**/
+        return;
+    activeSlot = I2C_MGR_NO_SLOT;
+    I2C_Mgr_Finish(index, status);
+    I2C_Mgr_StartNext();
+}
+
+
+/**
+ * @brief   Hàm khởi tạo bộ quản lý bus I2C
+ * @param   void
+ * @return  void
+ **/
+void I2C_Mgr_Init(void)
+{
+    for (uint8_t i = 0; i < I2C_MGR_QUEUE_SIZE; i++) {
+        slots[i].state = SLOT_FREE;
+    }
+    clientCount = 0;
+    activeSlot = I2C_MGR_NO_SLOT;
+    recoverPending = 0;
+    I2C_Mgr_ResetStats();
+}
+
+
+/**
+ * @brief   Hàm đăng ký client mới trên bus
+ * @param   priority    Độ ưu tiên (I2C_MGR_PRIORITY_HIGH ... I2C_MGR_PRIORITY_LOW)
+ * @return  uint8_t     Mã client, hoặc I2C_MGR_INVALID_CLIENT nếu đã đủ client
+ **/
+uint8_t I2C_Mgr_RegisterClient(uint8_t priority)
+{
+    if (clientCount >= I2C_MGR_MAX_CLIENTS)
+        return I2C_MGR_INVALID_CLIENT;
+    clientPriority[clientCount] = priority;
+    return clientCount++;
+}
+
+
+/**
+ * @brief   Hàm gửi một giao dịch vào hàng đợi
+ * @param   client      Mã client đã đăng ký
+ * @param   request     Thông tin giao dịch (được sao chép vào hàng đợi)
+ * @return  I2C_Bus_Status  I2C_BUS_OK nếu đã vào hàng đợi, I2C_BUS_DROPPED nếu hàng đợi đầy
+ **/
+I2C_Bus_Status I2C_Mgr_Submit(uint8_t client, const I2C_Mgr_Request *request)
+{
+    I2C_Bus_Status status = I2C_BUS_DROPPED;
+
+    if (client >= clientCount)
+        return I2C_BUS_ERROR;
+
+    I2C_MGR_ENTER_CRITICAL();
+    for (uint8_t i = 0; i < I2C_MGR_QUEUE_SIZE; i++) {
+        if (slots[i].state == SLOT_FREE) {
+            slots[i].request   = *request;
+            slots[i].client    = client;
+            slots[i].enqueueUs = Timebase_Micros();
+            slots[i].state     = SLOT_PENDING;
+            status = I2C_BUS_OK;
+            break;
+        }
+    }
+    if (status == I2C_BUS_OK) {
+        I2C_Mgr_StartNext();
+    } else {
+        clientStats[client].rejected++;
+    }
+    I2C_MGR_EXIT_CRITICAL();
+
+    return status;
+}
+
+
+/**
+ * @brief   Hàm phục vụ bộ quản lý, gọi trong vòng lặp chính
+ * @param   void
+ * @return  void
+ **/
+void I2C_Mgr_Service(void)
+{
+    uint8_t stuck = I2C_MGR_NO_SLOT;
+
+    {
+        I2C_MGR_ENTER_CRITICAL();
+        if (activeSlot != I2C_MGR_NO_SLOT &&
+            TIMEBASE_ELAPSED(Timebase_Micros(), slots[activeSlot].startUs) >= I2C_MGR_TRANSFER_TIMEOUT_US) {
+            stuck = activeSlot;                             //**< DMA treo: chiếm quyền giao dịch >**/
+            activeSlot = I2C_MGR_NO_SLOT;
+            recoverPending = 1;
+        }
+        I2C_MGR_EXIT_CRITICAL();
+    }
+
+    if (recoverPending) {                                   //**< Giải phóng bus ngoài vùng tới hạn >**/
+        if (I2C_BUS_HANDLE.hdmatx != NULL)
+            HAL_DMA_Abort(I2C_BUS_HANDLE.hdmatx);
+        if (I2C_BUS_HANDLE.hdmarx != NULL)
+            HAL_DMA_Abort(I2C_BUS_HANDLE.hdmarx);
+        I2C_Bus_Recover();
+        if (stuck != I2C_MGR_NO_SLOT)
+            I2C_Mgr_Finish(stuck, I2C_BUS_TIMEOUT);
+    }
+
+    {
+        I2C_MGR_ENTER_CRITICAL();
+        recoverPending = 0;
+        I2C_Mgr_StartNext();                                //**< Loại giao dịch hết hạn và chạy tiếp >**/
+        I2C_MGR_EXIT_CRITICAL();
+    }
+}
+
+
+/**
+ * @brief   Hàm đếm số giao dịch đang chờ hoặc đang chạy của một client
+ * @param   client      Mã client
+ * @return  uint8_t     Số giao dịch
+ **/
+uint8_t I2C_Mgr_Pending(uint8_t client)
+{
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < I2C_MGR_QUEUE_SIZE; i++) {
+        if (slots[i].state != SLOT_FREE && slots[i].client == client)
+            count++;
+    }
+    return count;
+}
+
+
+/**
+ * @brief   Hàm đọc thống kê độ trễ của một client
+ * @param   client      Mã client
+ * @return  const I2C_Mgr_ClientStats*  Con trỏ đến thống kê, NULL nếu client không hợp lệ
+ **/
+const I2C_Mgr_ClientStats *I2C_Mgr_GetStats(uint8_t client)
+{
+    if (client >= clientCount)
+        return NULL;
+    return &clientStats[client];
+}
+
+
+/**
+ * @brief   Hàm xóa thống kê độ trễ của tất cả client
+ * @param   void
+ * @return  void
+ **/
+void I2C_Mgr_ResetStats(void)
+{
+    I2C_Mgr_ClientStats empty = {0};
+
+    for (uint8_t i = 0; i < I2C_MGR_MAX_CLIENTS; i++) {
+        clientStats[i] = empty;
+    }
+}
+
+
+/* ==========================================[ HAL CALLBACKS ]==========================================*/
+/**
+ * @brief   Các hàm callback của HAL khi giao dịch DMA hoàn thành
+ * @param   hi2c    Handle I2C phát sinh ngắt
+ * @return  void
+ **/
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c) { if (hi2c->Instance == I2C_BUS_HANDLE.Instance) I2C_Mgr_Complete(I2C_BUS_OK); }
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c) { if (hi2c->Instance == I2C_BUS_HANDLE.Instance) I2C_Mgr_Complete(I2C_BUS_OK); }
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)    { if (hi2c->Instance == I2C_BUS_HANDLE.Instance) I2C_Mgr_Complete(I2C_BUS_OK); }
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)    { if (hi2c->Instance == I2C_BUS_HANDLE.Instance) I2C_Mgr_Complete(I2C_BUS_OK); }
+
+
+/**
+ * @brief   Hàm callback của HAL khi giao dịch lỗi
+ * @details NACK chỉ kết thúc giao dịch (HAL đã tạo STOP); mất quyền điều khiển bus hoặc lỗi bus
+ *          sẽ yêu cầu giải phóng bus trong I2C_Mgr_Service.
+ * @param   hi2c    Handle I2C phát sinh ngắt
+ * @return  void
+ **/
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    uint32_t error;
+
+    if (hi2c->Instance != I2C_BUS_HANDLE.Instance)
+        return;
+
+    error = HAL_I2C_GetError(hi2c);
+    if (error & HAL_I2C_ERROR_AF) {
+        I2C_Mgr_Complete(I2C_BUS_NACK);
+    } else {
+        recoverPending = 1;                                 //**< Dừng lập lịch đến khi giải phóng bus >**/
+        I2C_Mgr_Complete(I2C_BUS_ERROR);
+    }
+}
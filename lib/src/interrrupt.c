@@ -9,6 +9,9 @@
  **********************************************************************************/
 /* ============================================[ INCLUDE FILE ]============================================*/
 #include "interrrupt.h"
+#include "ps2.h"						//**< Polling PS2 nền theo Timer >**/
+#include "HCSR05.h"						//**< Đo khoảng cách liên tục theo Timer >**/
+#include "line_event.h"					//**< Lấy mẫu cảm biến line theo Timer >**/
 
 /* ============================================[ FUNCTION PROTOTYPES ]========================================*/
 /**
@@ -53,3 +56,15 @@ extern void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin){
 }
 
 
+/**
+ * @brief   Hàm xử lý ngắt tràn (update) của các Timer
+ * @details Hàm này phân phối ngắt update đến các module sử dụng Timer làm nhịp nền,
+ *          mỗi module tự kiểm tra htim có phải Timer của mình hay không.
+ * @param   htim    Handle Timer phát sinh ngắt
+ * @return  void
+ **/
+extern void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim){
+	PS2_Poll_TimerHandler(htim);		// PS2 polling nen
+	HCSR05_TimerHandler(htim);			// HCSR05 phat Trigger, kiem tra mat Echo
+	Line_Event_TimerHandler(htim);		// lay mau cam bien line vao lich su chong nhieu
+}
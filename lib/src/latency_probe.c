@@ -0,0 +1,185 @@
+/*********************************************************************************************************************
+ * @file    latency_probe.c
+ * @brief   Thư viện đo độ trễ từ tay cầm PS2 đến động cơ
+ * @details Triển khai ghi nhãn thời gian từng giai đoạn bằng Timebase_Cycles và histogram theo chế độ.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "latency_probe.h"              //**< Thư viện đo độ trễ >**/
+#include <string.h>                     //**< Thư viện sử dụng hàm memset >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#ifndef HOST_SIM
+#define LATENCY_ENTER_CRITICAL()    uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define LATENCY_EXIT_CRITICAL()     __set_PRIMASK(primask)
+#else
+#define LATENCY_ENTER_CRITICAL()    do { } while (0)        //**< Mô phỏng chạy 1 luồng, không có ngắt >**/
+#define LATENCY_EXIT_CRITICAL()     do { } while (0)
+#endif
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+static Latency_ModeStats modeStats[LATENCY_MODES];         //**< Thống kê theo chế độ          >**/
+static uint32_t          stageCycles[LATENCY_STAGES];       //**< Nhãn thời gian mẫu đang đo    >**/
+static volatile uint8_t  stageDone = 0;                     //**< Số giai đoạn đã ghi (0: rảnh)  >**/
+static uint8_t           currentMode = 0;                   //**< Chế độ hiện tại               >**/
+static uint32_t          missedSamples = 0;                 //**< Số mẫu bị bỏ qua / hủy        >**/
+static uint32_t          sampleFrame = 0;                   //**< Số khung của mẫu đang đo      >**/
+static volatile uint8_t  probeEnabled = 1;                  //**< 1: đang bật đo                >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ đưa mẫu vừa kết thúc vào thống kê
+ * @param   void
+ * @return  void
+ **/
+static void Latency_Probe_Record(void)
+{
+    Latency_ModeStats *stats = &modeStats[currentMode];
+    uint32_t totalUs = Timebase_CyclesToMicros(stageCycles[LATENCY_STAGE_COMMIT] - stageCycles[LATENCY_STAGE_RESPONSE]);
+    uint32_t bin = totalUs / LATENCY_HIST_BIN_US;
+
+    for (uint8_t i = 0; i < LATENCY_STAGES - 1; i++) {
+        uint32_t stageUs = Timebase_CyclesToMicros(stageCycles[i + 1] - stageCycles[i]);
+        if (stageUs > stats->stageMaxUs[i])
+            stats->stageMaxUs[i] = stageUs;
+    }
+
+    if (stats->count == 0 || totalUs < stats->minUs)
+        stats->minUs = totalUs;
+    if (totalUs > stats->maxUs)
+        stats->maxUs = totalUs;
+    stats->sumUs += totalUs;
+    stats->count++;
+    stats->bins[(bin < LATENCY_HIST_BINS) ? bin : (LATENCY_HIST_BINS - 1)]++;
+}
+
+
+/**
+ * @brief   Hàm xóa toàn bộ thống kê và hủy mẫu đang đo
+ * @param   void
+ * @return  void
+ **/
+void Latency_Probe_Reset(void)
+{
+    memset(modeStats, 0, sizeof(modeStats));
+    stageDone = 0;
+    missedSamples = 0;
+}
+
+
+/**
+ * @brief   Hàm bắt đầu một mẫu tại giai đoạn LATENCY_STAGE_RESPONSE
+ * @param   cycles  Thời điểm nhận xong khung (Timebase_Cycles)
+ * @param   frame   Số thứ tự khung của ảnh chụp chứa thay đổi (PS2_Snapshot.frame)
+ * @return  void
+ **/
+void Latency_Probe_Start(uint32_t cycles, uint32_t frame)
+{
+    if (!probeEnabled)
+        return;
+    if (stageDone != 0) {
+        if (Timebase_CyclesToMicros(cycles - stageCycles[LATENCY_STAGE_RESPONSE]) < LATENCY_SAMPLE_TIMEOUT_US) {
+            missedSamples++;                                    //**< Đang đo mẫu khác          >**/
+            return;
+        }
+        missedSamples++;                                        //**< Mẫu cũ không kết thúc: hủy >**/
+    }
+    stageCycles[LATENCY_STAGE_RESPONSE] = cycles;
+    sampleFrame = frame;
+    stageDone = LATENCY_STAGE_RESPONSE + 1;
+}
+
+
+/**
+ * @brief   Hàm ghi nhãn thời gian cho một giai đoạn của mẫu đang đo
+ * @param   stage   Giai đoạn cần ghi
+ * @return  void
+ **/
+void Latency_Probe_Stamp(Latency_Stage stage)
+{
+    if (stageDone != (uint8_t)stage)                            //**< Sai thứ tự hoặc không có mẫu >**/
+        return;
+
+    LATENCY_ENTER_CRITICAL();                                   //**< Ngắt DMA có thể bắt đầu mẫu mới >**/
+    if (stageDone == (uint8_t)stage) {
+        stageCycles[stage] = Timebase_Cycles();
+        stageDone = stage + 1;
+        if (stage == LATENCY_STAGE_COMMIT) {
+            Latency_Probe_Record();
+            stageDone = 0;
+        }
+    }
+    LATENCY_EXIT_CRITICAL();
+}
+
+
+/**
+ * @brief   Hàm ghi nhãn LATENCY_STAGE_MOTION khi bộ điều khiển xử lý 1 ảnh chụp tay cầm
+ * @param   frame   Số thứ tự khung của ảnh chụp đang xử lý (PS2_Snapshot.frame)
+ * @return  void
+ **/
+void Latency_Probe_Motion(uint32_t frame)
+{
+    if (stageDone != LATENCY_STAGE_MOTION)
+        return;
+
+    LATENCY_ENTER_CRITICAL();
+    if (stageDone == LATENCY_STAGE_MOTION && (int32_t)(frame - sampleFrame) >= 0) {   //**< Ảnh chụp cũ: chưa thấy thay đổi >**/
+        stageCycles[LATENCY_STAGE_MOTION] = Timebase_Cycles();
+        stageDone = LATENCY_STAGE_MOTION + 1;
+    }
+    LATENCY_EXIT_CRITICAL();
+}
+
+
+/**
+ * @brief   Hàm bật / tắt đo độ trễ
+ * @param   enable  1: bật (tay cầm điều khiển động cơ), 0: tắt
+ * @return  void
+ **/
+void Latency_Probe_Enable(uint8_t enable)
+{
+    if (enable == probeEnabled)
+        return;
+    probeEnabled = enable;
+    if (!enable)
+        stageDone = 0;                                          //**< Mẫu của chế độ cũ không bao giờ kết thúc >**/
+}
+
+
+/**
+ * @brief   Hàm đặt chế độ hiện tại để phân loại các mẫu
+ * @param   mode    Chế độ (0 - LATENCY_MODES - 1)
+ * @return  void
+ **/
+void Latency_Probe_SetMode(uint8_t mode)
+{
+    if (mode < LATENCY_MODES)
+        currentMode = mode;
+}
+
+
+/**
+ * @brief   Hàm đọc thống kê độ trễ của một chế độ
+ * @param   mode    Chế độ (0 - LATENCY_MODES - 1)
+ * @return  const Latency_ModeStats*    Con trỏ đến thống kê, NULL nếu mode không hợp lệ
+ **/
+const Latency_ModeStats *Latency_Probe_GetStats(uint8_t mode)
+{
+    if (mode >= LATENCY_MODES)
+        return NULL;
+    return &modeStats[mode];
+}
+
+
+/**
+ * @brief   Hàm đọc số mẫu bị bỏ qua (đang đo mẫu khác) hoặc bị hủy (quá thời gian)
+ * @param   void
+ * @return  uint32_t    Số mẫu
+ **/
+uint32_t Latency_Probe_Missed(void)
+{
+    return missedSamples;
+}
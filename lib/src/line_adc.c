@@ -0,0 +1,226 @@
+/*********************************************************************************************************************
+ * @file    line_adc.c
+ * @brief   Thư viện đọc cảm biến line dạng analog bằng ADC quét + DMA vòng
+ * @details Triển khai bộ đệm DMA vòng, hiệu chỉnh min / max và nội suy vị trí line bằng số nguyên.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "line_adc.h"                   //**< Thư viện cảm biến line analog >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+#if LINE_ADC_ENABLE && defined(LINE_ADC_TIM)
+extern TIM_HandleTypeDef LINE_ADC_TIM;                      //**< Timer kích ADC                >**/
+#endif
+
+static const int16_t sensorWeight[LINE_ADC_CHANNELS] = {    //**< Vị trí LINE1 ... LINE5 (trái dương) >**/
+    2000, 1000, 0, -1000, -2000
+};
+#if LINE_ADC_ENABLE
+static volatile uint16_t adcBuffer[LINE_ADC_SCANS * LINE_ADC_CHANNELS];     //**< Bộ đệm DMA vòng >**/
+#endif
+static LineAdc_Calibration calibration;                     //**< Kết quả hiệu chỉnh            >**/
+static uint8_t  calibrating = 0;                            //**< Đang hiệu chỉnh               >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm bắt đầu quét ADC bằng DMA vòng
+ * @param   void
+ * @return  HAL_StatusTypeDef   HAL_OK nếu thành công
+ **/
+HAL_StatusTypeDef LineAdc_Start(void)
+{
+#if LINE_ADC_ENABLE
+    HAL_StatusTypeDef status;
+
+#ifdef LINE_ADC_TIM
+    if ((LINE_ADC_TIM.Instance->CR1 & TIM_CR1_CEN) || LINE_ADC_TIM.State != HAL_TIM_STATE_READY)
+        return HAL_BUSY;                                        //**< Timer đã có chủ: không ghi đè ARR >**/
+#endif
+    status = HAL_ADC_Start_DMA(&LINE_ADC_HANDLE, (uint32_t *)adcBuffer, LINE_ADC_SCANS * LINE_ADC_CHANNELS);
+    if (status != HAL_OK)
+        return status;
+#ifdef LINE_ADC_TIM
+    __HAL_TIM_SET_AUTORELOAD(&LINE_ADC_TIM, 1000000UL / LINE_ADC_RATE_HZ - 1);  //**< Tick Timer 1 us >**/
+    __HAL_TIM_SET_COUNTER(&LINE_ADC_TIM, 0);
+    status = HAL_TIM_Base_Start(&LINE_ADC_TIM);
+#endif
+    return status;
+#else
+    return HAL_ERROR;                                           //**< Chưa nối mảng analog vào ADC >**/
+#endif
+}
+
+
+/**
+ * @brief   Hàm dừng quét ADC
+ * @param   void
+ * @return  void
+ **/
+void LineAdc_Stop(void)
+{
+#if LINE_ADC_ENABLE
+#ifdef LINE_ADC_TIM
+    HAL_TIM_Base_Stop(&LINE_ADC_TIM);
+#endif
+    HAL_ADC_Stop_DMA(&LINE_ADC_HANDLE);
+#endif
+}
+
+
+/**
+ * @brief   Hàm đọc giá trị thô trung bình của các kênh
+ * @details DMA vẫn ghi trong lúc đọc; mỗi phần tử 16 bit được ghi nguyên vẹn
+ *          nên trung bình chỉ lẫn mẫu của 2 lượt quét liền nhau.
+ * @param   raw     Mảng LINE_ADC_CHANNELS phần tử (LINE1 ... LINE5)
+ * @return  void
+ **/
+void LineAdc_Read(uint16_t *raw)
+{
+    uint32_t sum[LINE_ADC_CHANNELS] = { 0 };
+
+#if LINE_ADC_ENABLE
+    for (uint8_t scan = 0; scan < LINE_ADC_SCANS; scan++) {
+        for (uint8_t ch = 0; ch < LINE_ADC_CHANNELS; ch++) {
+            sum[ch] += adcBuffer[scan * LINE_ADC_CHANNELS + ch];
+        }
+    }
+#endif
+    for (uint8_t ch = 0; ch < LINE_ADC_CHANNELS; ch++) {
+        raw[ch] = (uint16_t)(sum[ch] / LINE_ADC_SCANS);
+    }
+}
+
+
+/**
+ * @brief   Hàm bắt đầu hiệu chỉnh (xóa min / max)
+ * @param   void
+ * @return  void
+ **/
+void LineAdc_CalibrateStart(void)
+{
+    for (uint8_t ch = 0; ch < LINE_ADC_CHANNELS; ch++) {
+        calibration.min[ch] = 0xFFFF;
+        calibration.max[ch] = 0;
+    }
+    calibration.valid = 0;
+    calibrating = LINE_ADC_ENABLE;                              //**< Module tắt: không bao giờ hợp lệ >**/
+}
+
+
+/**
+ * @brief   Hàm cập nhật min / max từ giá trị hiện tại, gọi thường xuyên khi xe quét qua line
+ * @param   void
+ * @return  void
+ **/
+void LineAdc_CalibrateUpdate(void)
+{
+    uint16_t raw[LINE_ADC_CHANNELS];
+
+    if (!calibrating)
+        return;
+    LineAdc_Read(raw);
+    for (uint8_t ch = 0; ch < LINE_ADC_CHANNELS; ch++) {
+        if (raw[ch] < calibration.min[ch])
+            calibration.min[ch] = raw[ch];
+        if (raw[ch] > calibration.max[ch])
+            calibration.max[ch] = raw[ch];
+    }
+}
+
+
+/**
+ * @brief   Hàm kết thúc hiệu chỉnh
+ * @param   void
+ * @return  uint8_t     1 nếu mọi kênh đủ chênh lệch (đã thấy cả nền và line), 0 nếu chưa
+ **/
+uint8_t LineAdc_CalibrateFinish(void)
+{
+    calibrating = 0;
+    calibration.valid = LINE_ADC_ENABLE;
+    for (uint8_t ch = 0; ch < LINE_ADC_CHANNELS; ch++) {
+        if (calibration.max[ch] < calibration.min[ch] + LINE_ADC_CAL_MIN_SPAN)
+            calibration.valid = 0;
+    }
+    return calibration.valid;
+}
+
+
+/**
+ * @brief   Hàm kiểm tra đã có hiệu chỉnh hợp lệ
+ * @param   void
+ * @return  uint8_t     1 nếu đã hiệu chỉnh, 0 nếu chưa
+ **/
+uint8_t LineAdc_Calibrated(void)
+{
+    return calibration.valid && !calibrating;
+}
+
+
+/**
+ * @brief   Hàm đọc kết quả hiệu chỉnh
+ * @param   result  Nơi lưu kết quả
+ * @return  void
+ **/
+void LineAdc_GetCalibration(LineAdc_Calibration *result)
+{
+    *result = calibration;
+}
+
+
+/**
+ * @brief   Hàm chuẩn hóa giá trị thô theo hiệu chỉnh
+ * @param   raw     Giá trị thô (LINE_ADC_CHANNELS phần tử)
+ * @param   norm    Nơi lưu giá trị chuẩn hóa 0 - 1000 (1000: trên line)
+ * @return  void
+ **/
+void LineAdc_Normalize(const uint16_t *raw, uint16_t *norm)
+{
+    for (uint8_t ch = 0; ch < LINE_ADC_CHANNELS; ch++) {
+        uint16_t low  = calibration.min[ch];
+        uint16_t high = calibration.max[ch];
+        uint32_t value;
+
+        if (high <= low) {
+            norm[ch] = 0;
+            continue;
+        }
+        if (raw[ch] <= low)
+            value = 0;
+        else if (raw[ch] >= high)
+            value = 1000;
+        else
+            value = (uint32_t)(raw[ch] - low) * 1000 / (high - low);
+        norm[ch] = (uint16_t)(LINE_ADC_LINE_HIGH ? value : 1000 - value);
+    }
+}
+
+
+/**
+ * @brief   Hàm tính vị trí line nội suy từ giá trị analog
+ * @details Trọng tâm của các giá trị chuẩn hóa đã trừ mức nền LINE_ADC_NOISE,
+ *          độ phân giải tốt hơn nhiều so với 5 mức của cảm biến số.
+ * @param   found   Nơi lưu 1 nếu thấy line, 0 nếu không
+ * @return  int16_t     Vị trí (1/1000 bước cảm biến, trái dương), 0 nếu không thấy line
+ **/
+int16_t LineAdc_Position(uint8_t *found)
+{
+    uint16_t raw[LINE_ADC_CHANNELS], norm[LINE_ADC_CHANNELS];
+    int32_t  weighted = 0;
+    uint32_t total = 0;
+    uint16_t peak = 0;
+
+    LineAdc_Read(raw);
+    LineAdc_Normalize(raw, norm);
+    for (uint8_t ch = 0; ch < LINE_ADC_CHANNELS; ch++) {
+        uint16_t value = (norm[ch] > LINE_ADC_NOISE) ? norm[ch] - LINE_ADC_NOISE : 0;
+
+        weighted += (int32_t)sensorWeight[ch] * value;
+        total    += value;
+        if (norm[ch] > peak)
+            peak = norm[ch];
+    }
+    *found = (peak >= LINE_ADC_FOUND) && (total != 0);
+    return *found ? (int16_t)(weighted / (int32_t)total) : 0;
+}
@@ -0,0 +1,237 @@
+/*********************************************************************************************************************
+ * @file    line_event.c
+ * @brief   Thư viện lọc cảm biến line và nhận dạng ngã rẽ, ngã ba, ngã tư
+ * @details Triển khai lịch sử dịch bit từng cảm biến trong ngắt và máy trạng thái phân loại trong vòng lặp chính.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "line_event.h"                 //**< Thư viện sự kiện line >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define LINE_EVENT_SENSORS      5
+#define LINE_DEBOUNCE_MASK      ((1UL << LINE_EVENT_DEBOUNCE) - 1)
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+static uint32_t         history[LINE_EVENT_SENSORS];        //**< Lịch sử từng cảm biến (bit 0 mới nhất) >**/
+static volatile uint8_t stableOnLine = 0;                   //**< Mẫu đã lọc, bit = 1: thấy line >**/
+static uint8_t          lastOnLine = 0xFF;                  //**< Mẫu đã phân loại lần trước    >**/
+static uint8_t          lastType = LINE_EVENT_LOST;         //**< Loại sự kiện gần nhất         >**/
+static uint8_t          lastArms = 0;                       //**< Các nhánh của sự kiện gần nhất >**/
+static uint8_t          inJunction = 0;                     //**< Đang đi qua giao lộ           >**/
+static uint8_t          junctionArms = 0;                   //**< Các nhánh ngang đã thấy       >**/
+
+static Line_Event       eventQueue[LINE_EVENT_QUEUE_SIZE];  //**< Hàng đợi vòng sự kiện         >**/
+static uint8_t          eventHead = 0;                      //**< Vị trí ghi                    >**/
+static uint8_t          eventTail = 0;                      //**< Vị trí đọc                    >**/
+static uint32_t         eventDropped = 0;                   //**< Số sự kiện bị mất             >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ đưa sự kiện vào hàng đợi
+ * @param   type    Loại sự kiện
+ * @param   arms    Các nhánh
+ * @param   onLine  Mẫu đã lọc
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+static void Line_Event_Push(Line_EventType type, uint8_t arms, uint8_t onLine, uint32_t nowMs)
+{
+    uint8_t next = (eventHead + 1) & (LINE_EVENT_QUEUE_SIZE - 1);
+
+    lastType = (uint8_t)type;
+    lastArms = arms;
+    if (next == eventTail) {                                    //**< Hàng đợi đầy >**/
+        eventDropped++;
+        return;
+    }
+    eventQueue[eventHead].type   = (uint8_t)type;
+    eventQueue[eventHead].arms   = arms;
+    eventQueue[eventHead].onLine = onLine;
+    eventQueue[eventHead].timeMs = nowMs;
+    eventHead = next;
+}
+
+
+/**
+ * @brief   Hàm khởi tạo bộ lọc và hàng đợi sự kiện
+ * @param   void
+ * @return  void
+ **/
+void Line_Event_Init(void)
+{
+    uint32_t primask = __get_PRIMASK();                         //**< Ngắt Timer lấy mẫu cùng ghi lịch sử >**/
+
+    __disable_irq();
+    for (uint8_t i = 0; i < LINE_EVENT_SENSORS; i++) {
+        history[i] = 0;
+    }
+    stableOnLine = 0;
+    __set_PRIMASK(primask);
+    lastOnLine   = 0xFF;
+    lastType     = LINE_EVENT_LOST;
+    lastArms     = 0;
+    inJunction   = 0;
+    junctionArms = 0;
+    eventHead    = eventTail = 0;
+    eventDropped = 0;
+}
+
+
+/**
+ * @brief   Hàm bắt đầu lấy mẫu theo ngắt Timer với tần số LINE_EVENT_RATE_HZ
+ * @param   void
+ * @return  HAL_StatusTypeDef   HAL_OK nếu thành công
+ **/
+HAL_StatusTypeDef Line_Event_Start(void)
+{
+    __HAL_TIM_SET_AUTORELOAD(&LINE_EVENT_TIM, 1000000UL / LINE_EVENT_RATE_HZ - 1);    //**< Tick Timer 1 us >**/
+    __HAL_TIM_SET_COUNTER(&LINE_EVENT_TIM, 0);
+    return HAL_TIM_Base_Start_IT(&LINE_EVENT_TIM);
+}
+
+
+/**
+ * @brief   Hàm đưa 1 mẫu vào lịch sử và cập nhật trạng thái đã lọc (gọi trong ngắt)
+ * @param   pattern Mẫu 5 bit của detect_Line_Read
+ * @return  void
+ **/
+void Line_Event_Sample(uint8_t pattern)
+{
+    uint8_t onLine = LINE_ACTIVE_LOW ? (uint8_t)(~pattern & 0x1F) : (uint8_t)(pattern & 0x1F);
+    uint8_t stable = stableOnLine;
+
+    for (uint8_t i = 0; i < LINE_EVENT_SENSORS; i++) {
+        uint32_t recent;
+
+        history[i] = (history[i] << 1) | ((onLine >> i) & 1U);
+        recent = history[i] & LINE_DEBOUNCE_MASK;
+        if (recent == LINE_DEBOUNCE_MASK)                       //**< Đủ số mẫu giống nhau mới đổi trạng thái >**/
+            stable |= (uint8_t)(1U << i);
+        else if (recent == 0)
+            stable &= (uint8_t)~(1U << i);
+    }
+    stableOnLine = stable;
+}
+
+
+/**
+ * @brief   Hàm xử lý ngắt update của Timer lấy mẫu, gọi trong HAL_TIM_PeriodElapsedCallback
+ * @param   htim    Handle Timer phát sinh ngắt
+ * @return  void
+ **/
+void Line_Event_TimerHandler(TIM_HandleTypeDef *htim)
+{
+    if (htim->Instance != LINE_EVENT_TIM.Instance)
+        return;
+    Line_Event_Sample(detect_Line_Read());
+}
+
+
+/**
+ * @brief   Hàm phân loại mẫu đã lọc và tạo sự kiện, gọi thường xuyên trong vòng lặp chính
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+void Line_Event_Update(uint32_t nowMs)
+{
+    uint8_t onLine = stableOnLine;
+    uint8_t edges = onLine & (LINE_MASK_LEFT | LINE_MASK_RIGHT);
+    uint8_t middle = onLine & LINE_MASK_MIDDLE;
+
+    if (onLine == lastOnLine)
+        return;
+    lastOnLine = onLine;
+
+    // nhanh ngang: cam bien bien thay line cung luc voi cam bien giua
+    if (edges && middle) {
+        inJunction = 1;
+        if (onLine & LINE_MASK_LEFT)
+            junctionArms |= LINE_ARM_LEFT;
+        if (onLine & LINE_MASK_RIGHT)
+            junctionArms |= LINE_ARM_RIGHT;
+        return;
+    }
+    if (inJunction) {
+        if (edges)                                              //**< Còn ở mép giao lộ >**/
+            return;
+        if (onLine & LINE_MASK_CENTER)
+            junctionArms |= LINE_ARM_STRAIGHT;
+        if (junctionArms == (LINE_ARM_LEFT | LINE_ARM_STRAIGHT | LINE_ARM_RIGHT))
+            Line_Event_Push(LINE_EVENT_CROSS, junctionArms, onLine, nowMs);
+        else if (junctionArms & (junctionArms - 1))             //**< 2 nhánh >**/
+            Line_Event_Push(LINE_EVENT_T_JUNCTION, junctionArms, onLine, nowMs);
+        else                                                    //**< Chỉ 1 nhánh ngang: góc cua >**/
+            Line_Event_Push(LINE_EVENT_CURVE, junctionArms, onLine, nowMs);
+        inJunction   = 0;
+        junctionArms = 0;
+        if (onLine)
+            return;
+    }
+
+    if (onLine == 0) {
+        if (lastType == LINE_EVENT_STRAIGHT)
+            Line_Event_Push(LINE_EVENT_END, 0, onLine, nowMs);
+        else if (lastType != LINE_EVENT_END && lastType != LINE_EVENT_LOST)
+            Line_Event_Push(LINE_EVENT_LOST, 0, onLine, nowMs);
+    } else if (onLine & LINE_MASK_CENTER) {
+        if (lastType != LINE_EVENT_STRAIGHT)
+            Line_Event_Push(LINE_EVENT_STRAIGHT, LINE_ARM_STRAIGHT, onLine, nowMs);
+    } else {                                                    //**< Chỉ cảm biến biên thấy line >**/
+        uint8_t arms = (onLine & LINE_MASK_LEFT) ? LINE_ARM_LEFT : LINE_ARM_RIGHT;
+
+        if (lastType != LINE_EVENT_CURVE || lastArms != arms)
+            Line_Event_Push(LINE_EVENT_CURVE, arms, onLine, nowMs);
+    }
+}
+
+
+/**
+ * @brief   Hàm lấy sự kiện tiếp theo trong hàng đợi
+ * @param   event   Nơi lưu sự kiện
+ * @return  uint8_t     1 nếu có sự kiện, 0 nếu hàng đợi trống
+ **/
+uint8_t Line_Event_Get(Line_Event *event)
+{
+    if (eventTail == eventHead)
+        return 0;
+    *event = eventQueue[eventTail];
+    eventTail = (eventTail + 1) & (LINE_EVENT_QUEUE_SIZE - 1);
+    return 1;
+}
+
+
+/**
+ * @brief   Hàm đọc mẫu đã lọc theo định dạng của detect_Line_Read
+ * @param   void
+ * @return  uint8_t     Mẫu 5 bit (LINE1 = bit 4 ... LINE5 = bit 0)
+ **/
+uint8_t Line_Event_Pattern(void)
+{
+    uint8_t onLine = stableOnLine;
+
+    return LINE_ACTIVE_LOW ? (uint8_t)(~onLine & 0x1F) : onLine;
+}
+
+
+/**
+ * @brief   Hàm kiểm tra xe đang đi qua giao lộ
+ * @param   void
+ * @return  uint8_t     1 nếu cảm biến biên đang thấy nhánh ngang, 0 nếu không
+ **/
+uint8_t Line_Event_InJunction(void)
+{
+    return inJunction;
+}
+
+
+/**
+ * @brief   Hàm đọc số sự kiện bị mất do hàng đợi đầy
+ * @param   void
+ * @return  uint32_t    Số sự kiện bị mất
+ **/
+uint32_t Line_Event_Dropped(void)
+{
+    return eventDropped;
+}
@@ -0,0 +1,450 @@
+/*********************************************************************************************************************
+ * @file    line_follow.c
+ * @brief   Thư viện dò line liên tục bằng bộ điều khiển PID
+ * @details Triển khai tính vị trí line bằng trọng tâm, nhớ phía mất line, PID chu kỳ cố định bằng số nguyên
+ *          và lập lịch tốc độ theo độ cong có giới hạn gia tốc.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "line_follow.h"                //**< Thư viện dò line PID >**/
+#include "mecanum.h"                    //**< Thư viện chứa các hàm điều khiển động cơ Mecanum >**/
+#include <stdio.h>                      //**< Thư viện sử dụng hàm snprintf >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+static const int16_t sensorWeight[LINE_SENSORS] = {         //**< Vị trí LINE5 ... LINE1 (bit 0 ... 4) >**/
+    -2 * LINE_PITCH, -LINE_PITCH, 0, LINE_PITCH, 2 * LINE_PITCH
+};
+static int16_t    baseSpeed = LINE_SPEED_BASE;              //**< Tốc độ tiến cơ bản (%)        >**/
+static int32_t    integral = 0;                             //**< Tích phân sai số              >**/
+static int16_t    lastError = 0;                            //**< Sai số chu kỳ trước           >**/
+static int8_t     lastSide = -1;                            //**< Phía thấy line cuối (1: trái, -1: phải) >**/
+static uint32_t   lastControlMs = 0;                        //**< Thời điểm điều khiển trước    >**/
+static uint8_t    calibrationStep = 0;                      //**< Lần quay hiệu chỉnh (0: không hiệu chỉnh) >**/
+static uint32_t   calibrationStepMs = 0;                    //**< Thời điểm bắt đầu lần quay    >**/
+static int8_t     travelDirection = 1;                      //**< Chiều đi (1: tiến, -1: lùi)   >**/
+static uint8_t    switchCycles = 0;                         //**< Số chu kỳ còn chờ sau khi đổi mảng >**/
+static Line_State lineState;                                //**< Trạng thái chu kỳ gần nhất    >**/
+
+static int16_t    outputHistory[LINE_CURVE_WINDOW];         //**< Đầu ra PID các chu kỳ gần nhất >**/
+static int16_t    errorHistory[LINE_CURVE_WINDOW];          //**< Sai số các chu kỳ gần nhất    >**/
+static uint8_t    historyIndex = 0;                         //**< Vị trí ghi (mục cũ nhất)      >**/
+static int32_t    outputSum = 0;                            //**< Tổng đầu ra trong cửa sổ      >**/
+static int16_t    scheduledSpeed = LINE_SPEED_MIN * 10;     //**< Tốc độ sau giới hạn gia tốc (1/10 %) >**/
+
+static Line_LogEntry logBuffer[LINE_LOG_SIZE];              //**< Nhật ký lịch tốc độ (vòng)    >**/
+static uint8_t    logHead = 0;                              //**< Vị trí ghi                    >**/
+static uint8_t    logTail = 0;                              //**< Vị trí đọc                    >**/
+static uint8_t    logDivider = 0;                           //**< Đếm chu kỳ giữa 2 lần ghi     >**/
+static uint32_t   logOverwritten = 0;                       //**< Số mục bị ghi đè              >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ giới hạn giá trị trong [-limit, limit]
+ * @param   value   Giá trị
+ * @param   limit   Giới hạn (> 0)
+ * @return  int32_t Giá trị đã giới hạn
+ **/
+static int32_t Line_Clamp(int32_t value, int32_t limit)
+{
+    if (value > limit)
+        return limit;
+    if (value < -limit)
+        return -limit;
+    return value;
+}
+
+
+/**
+ * @brief   Hàm khởi tạo bộ dò line (xóa tích phân và bộ nhớ mất line)
+ * @param   void
+ * @return  void
+ **/
+void Line_Init(void)
+{
+    integral  = 0;
+    lastError = 0;
+    lastSide  = -1;                                             //**< Như trước: mặc định quay đầu phải >**/
+    for (uint8_t i = 0; i < LINE_CURVE_WINDOW; i++) {
+        outputHistory[i] = 0;
+        errorHistory[i]  = 0;
+    }
+    historyIndex   = 0;
+    outputSum      = 0;
+    scheduledSpeed = LINE_SPEED_MIN * 10;                       //**< Bắt đầu chậm, tăng tốc theo LINE_ACCEL >**/
+}
+
+
+/**
+ * @brief   Hàm đặt tốc độ tiến cơ bản
+ * @param   speed   Tốc độ khi đúng giữa line (0 - 100 %)
+ * @return  void
+ **/
+void Line_SetSpeed(int16_t speed)
+{
+    baseSpeed = (int16_t)Line_Clamp(speed, 100);
+}
+
+
+/**
+ * @brief   Hàm nội bộ gửi lệnh trong lineState (hệ chiều đi) cho xe
+ * @param   void
+ * @return  void
+ **/
+static void Line_Drive(void)
+{
+    carMoveVector((int16_t)(lineState.vx * travelDirection), (int16_t)(lineState.vy * travelDirection), lineState.omega);
+}
+
+
+/**
+ * @brief   Hàm đặt chiều đi dọc line
+ * @param   direction   1: tiến (mảng trước), -1: lùi (mảng sau)
+ * @return  void
+ **/
+void Line_SetDirection(int8_t direction)
+{
+    direction = (direction < 0) ? -1 : 1;
+    if (direction == travelDirection)
+        return;
+    travelDirection = direction;
+    detect_Line_Select((direction > 0) ? LINE_ARRAY_FRONT : LINE_ARRAY_REAR);
+    Line_Event_Init();                                          //**< Lịch sử chống nhiễu thuộc mảng cũ >**/
+    Line_Init();
+    switchCycles = LINE_SWITCH_CYCLES;
+}
+
+
+/**
+ * @brief   Hàm đọc chiều đi dọc line
+ * @param   void
+ * @return  int8_t      1: tiến, -1: lùi
+ **/
+int8_t Line_GetDirection(void)
+{
+    return travelDirection;
+}
+
+
+/**
+ * @brief   Hàm nội bộ ước lượng độ cong từ lịch sử sai số và đầu ra PID
+ * @details Đầu ra trung bình lớn: xe đang quay đều theo cua. Sai số trôi nhiều trong cửa sổ:
+ *          line bắt đầu lệch khỏi giữa, tức sắp vào cua, nên giảm tốc trước khi đầu ra PID kịp tăng.
+ * @param   error   Sai số chu kỳ này
+ * @param   output  Đầu ra PID chu kỳ này
+ * @return  int16_t     Độ cong (0: thẳng ... 1000: cua gắt nhất)
+ **/
+static int16_t Line_Curvature(int16_t error, int16_t output)
+{
+    int32_t steer, drift;
+
+    drift = error - errorHistory[historyIndex];                 //**< So với LINE_CURVE_WINDOW chu kỳ trước >**/
+    outputSum += output - outputHistory[historyIndex];
+    outputHistory[historyIndex] = output;
+    errorHistory[historyIndex]  = error;
+    historyIndex = (historyIndex + 1) & (LINE_CURVE_WINDOW - 1);
+
+    steer = ((outputSum < 0) ? -outputSum : outputSum) * 1000 / (LINE_CURVE_WINDOW * LINE_OUTPUT_MAX);
+    drift = ((drift < 0) ? -drift : drift) * 1000 / LINE_CURVE_DRIFT;
+    if (drift > steer)
+        steer = drift;
+    return (int16_t)((steer > 1000) ? 1000 : steer);
+}
+
+
+/**
+ * @brief   Hàm nội bộ đưa tốc độ thực về tốc độ theo lịch trong giới hạn gia tốc
+ * @param   target  Tốc độ theo lịch (%)
+ * @param   elapsed Thời gian từ chu kỳ trước (ms)
+ * @return  int32_t     Tốc độ gửi cho xe (%)
+ **/
+static int32_t Line_Schedule(int32_t target, uint32_t elapsed)
+{
+    int32_t step;
+
+    target *= 10;
+    if (target > scheduledSpeed) {
+        step = (int32_t)(LINE_ACCEL * elapsed / 100);           //**< % / s x ms -> 1/10 % >**/
+        scheduledSpeed = (int16_t)((target - scheduledSpeed > step) ? scheduledSpeed + step : target);
+    } else {
+        step = (int32_t)(LINE_DECEL * elapsed / 100);
+        scheduledSpeed = (int16_t)((scheduledSpeed - target > step) ? scheduledSpeed - step : target);
+    }
+    return (scheduledSpeed + 5) / 10;
+}
+
+
+/**
+ * @brief   Hàm nội bộ ghi 1 mục nhật ký lịch tốc độ mỗi LINE_LOG_DIVIDER chu kỳ
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+static void Line_Log_Push(uint32_t nowMs)
+{
+    uint8_t next = (logHead + 1) & (LINE_LOG_SIZE - 1);
+
+    if (++logDivider < LINE_LOG_DIVIDER)
+        return;
+    logDivider = 0;
+    if (next == logTail) {                                      //**< Đầy: bỏ mục cũ nhất >**/
+        logTail = (logTail + 1) & (LINE_LOG_SIZE - 1);
+        logOverwritten++;
+    }
+    logBuffer[logHead].timeMs    = nowMs;
+    logBuffer[logHead].error     = lineState.error;
+    logBuffer[logHead].output    = lineState.output;
+    logBuffer[logHead].curvature = lineState.curvature;
+    logBuffer[logHead].target    = lineState.target;
+    logBuffer[logHead].speed     = scheduledSpeed;
+    logHead = next;
+}
+
+
+/**
+ * @brief   Hàm nội bộ quay xe qua lại trong lúc hiệu chỉnh cảm biến analog
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+static void Line_Calibrate(uint32_t nowMs)
+{
+    uint8_t  half = (calibrationStep == 1) || (calibrationStep == LINE_CAL_SWEEPS + 1);
+
+    LineAdc_CalibrateUpdate();
+    if (nowMs - calibrationStepMs >= (half ? LINE_CAL_SWEEP_MS / 2 : LINE_CAL_SWEEP_MS)) {
+        calibrationStepMs = nowMs;                              //**< Lần đầu và cuối quay nửa quãng: về vị trí ban đầu >**/
+        if (++calibrationStep > LINE_CAL_SWEEPS + 1) {
+            calibrationStep = 0;
+            LineAdc_CalibrateFinish();
+            Line_Init();
+            carMoveVector(0, 0, 0);
+            return;
+        }
+    }
+    lineState.vx    = 0;
+    lineState.vy    = 0;
+    lineState.omega = (calibrationStep & 1) ? LINE_CAL_SPEED : -LINE_CAL_SPEED;
+    Line_Drive();
+}
+
+
+/**
+ * @brief   Hàm bắt đầu hiệu chỉnh cảm biến analog
+ * @param   void
+ * @return  void
+ **/
+void Line_StartCalibration(void)
+{
+    if (!LINE_ADC_ENABLE)                                       //**< Không có mảng analog: không quay xe vô ích >**/
+        return;
+    LineAdc_CalibrateStart();
+    calibrationStep   = 1;
+    calibrationStepMs = lastControlMs;
+}
+
+
+/**
+ * @brief   Hàm tính vị trí line từ mẫu cảm biến
+ * @param   pattern Mẫu 5 bit (LINE1 = bit 4 ... LINE5 = bit 0)
+ * @param   found   Nơi lưu 1 nếu có cảm biến thấy line, 0 nếu không
+ * @return  int16_t     Vị trí trọng tâm (1/1000 bước, trái dương), 0 nếu không thấy line
+ **/
+int16_t Line_Position(uint8_t pattern, uint8_t *found)
+{
+    uint8_t onLine = LINE_ACTIVE_LOW ? (uint8_t)(~pattern & 0x1F) : (uint8_t)(pattern & 0x1F);
+    int32_t sum = 0;
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < LINE_SENSORS; i++) {
+        if (onLine & (1U << i)) {
+            sum += sensorWeight[i];
+            count++;
+        }
+    }
+    *found = count != 0;
+    return count ? (int16_t)(sum / count) : 0;
+}
+
+
+/**
+ * @brief   Hàm dò line, gọi thường xuyên trong vòng lặp chính ở chế độ LINE
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  uint8_t     1 nếu đến chu kỳ điều khiển và lệnh đã được gửi, 0 nếu chưa
+ **/
+uint8_t Line_Update(uint32_t nowMs)
+{
+    uint32_t elapsed = nowMs - lastControlMs;
+    int32_t  error, output, speed, curveSpeed;
+    uint8_t  found;
+    Line_Event event;
+    Route_Command command;
+
+    if (elapsed < LINE_CONTROL_MS)
+        return 0;
+    if (elapsed > LINE_RESUME_MS) {                             //**< Vừa vào chế độ LINE: bỏ lịch sử PID >**/
+        Line_Init();
+        calibrationStepMs += elapsed;                           //**< Không tính thời gian ngoài chế độ LINE >**/
+    }
+    lastControlMs = nowMs;
+
+    Line_Event_Update(nowMs);
+    while (Line_Event_Get(&event)) {
+        lineState.event = event.type;
+        if (event.type == LINE_EVENT_T_JUNCTION || event.type == LINE_EVENT_CROSS) {
+            lineState.junctions++;
+            Route_OnJunction(event.arms, nowMs);                //**< Đếm giao lộ, chọn hành động của lộ trình >**/
+        }
+    }
+
+    lineState.pattern     = Line_Event_Pattern();              //**< Mẫu đã lọc nhiễu trong ngắt Timer >**/
+    lineState.direction   = travelDirection;
+    lineState.calibrating = calibrationStep != 0;
+    if (calibrationStep) {
+        Line_Calibrate(nowMs);
+        return 1;
+    }
+    if (switchCycles) {                                         //**< Vừa đổi mảng: chờ mẫu mới qua bộ lọc >**/
+        switchCycles--;
+        lineState.vx = lineState.vy = lineState.omega = 0;
+        Line_Drive();
+        return 1;
+    }
+    if (Route_Update(LINE_ACTIVE_LOW ? (uint8_t)(~lineState.pattern & 0x1F) : lineState.pattern, nowMs, &command)) {
+        integral  = 0;                                          //**< Lộ trình đang rẽ / dừng: PID bắt đầu lại trên nhánh mới >**/
+        lastError = 0;
+        scheduledSpeed = LINE_SPEED_MIN * 10;
+        lineState.output = 0;
+        lineState.vx     = command.vx;
+        lineState.vy     = command.vy;
+        lineState.omega  = command.omega;
+        Line_Drive();
+        return 1;
+    }
+    if (command.reverse) {                                      //**< Bước 'B': đi lùi bằng mảng còn lại >**/
+        Line_SetDirection((int8_t)-travelDirection);
+        lineState.vx = lineState.vy = lineState.omega = 0;
+        Line_Drive();
+        return 1;
+    }
+    lineState.analog = LineAdc_Calibrated() && travelDirection > 0;
+    error = lineState.analog ? LineAdc_Position(&found) : Line_Position(lineState.pattern, &found);
+    lineState.found = found;
+    if (found && Line_Event_InJunction())                      //**< Qua giao lộ: bỏ qua nhánh ngang >**/
+        error = 0;
+
+    if (!found) {                                               //**< Mất line: quay tại chỗ về phía thấy line cuối >**/
+        integral = 0;
+        lastError = (int16_t)(lastSide * LINE_LOST_ERROR);
+        scheduledSpeed = LINE_SPEED_MIN * 10;                   //**< Bắt lại line thì tăng tốc từ từ >**/
+        lineState.error  = lastError;
+        lineState.output = 0;
+        lineState.vx     = 0;
+        lineState.vy     = 0;
+        lineState.omega  = (int16_t)(lastSide * LINE_SEARCH_SPEED);
+        Line_Drive();
+        return 1;
+    }
+    if (error != 0)
+        lastSide = (error > 0) ? 1 : -1;
+
+    integral = Line_Clamp(integral + error, LINE_INTEGRAL_MAX);
+    output   = (LINE_KP * error + LINE_KI * integral / 16 + LINE_KD * (error - lastError)) / 1000;
+    output   = Line_Clamp(output, LINE_OUTPUT_MAX);
+    lastError = (int16_t)error;
+
+    // lich toc do: thang chay baseSpeed, cong lon giam ve LINE_SPEED_CURVE, lech nhieu giam them
+    lineState.curvature = Line_Curvature((int16_t)error, (int16_t)output);
+    curveSpeed = (baseSpeed < LINE_SPEED_CURVE) ? baseSpeed : LINE_SPEED_CURVE;
+    speed = baseSpeed - (baseSpeed - curveSpeed) * lineState.curvature / 1000
+          - LINE_SLOW_GAIN * ((error < 0) ? -error : error) / 1000;
+    if (speed < LINE_SPEED_MIN)
+        speed = LINE_SPEED_MIN;
+    lineState.target = (int16_t)speed;
+    speed = Line_Schedule(speed, elapsed);
+
+    // line lech trai (error > 0): quay trai va di ngang sang trai
+    lineState.error  = (int16_t)error;
+    lineState.output = (int16_t)output;
+    lineState.vx     = (int16_t)(-output * LINE_STRAFE_PERCENT / 100);
+    lineState.vy     = (int16_t)speed;
+    lineState.omega  = (int16_t)(output - output * LINE_STRAFE_PERCENT / 100);
+    Line_Drive();
+    Line_Log_Push(nowMs);
+    return 1;
+}
+
+
+/**
+ * @brief   Hàm đọc trạng thái của chu kỳ điều khiển gần nhất
+ * @param   state   Nơi lưu trạng thái
+ * @return  void
+ **/
+void Line_GetState(Line_State *state)
+{
+    *state = lineState;
+}
+
+
+/**
+ * @brief   Hàm lấy mục nhật ký lịch tốc độ cũ nhất
+ * @param   entry   Nơi lưu mục nhật ký
+ * @return  uint8_t     1 nếu có mục, 0 nếu nhật ký trống
+ **/
+uint8_t Line_Log_Get(Line_LogEntry *entry)
+{
+    if (logTail == logHead)
+        return 0;
+    *entry = logBuffer[logTail];
+    logTail = (logTail + 1) & (LINE_LOG_SIZE - 1);
+    return 1;
+}
+
+
+/**
+ * @brief   Hàm đọc số mục nhật ký bị ghi đè trước khi được đọc
+ * @param   void
+ * @return  uint32_t    Số mục bị ghi đè
+ **/
+uint32_t Line_Log_Overwritten(void)
+{
+    return logOverwritten;
+}
+
+
+/**
+ * @brief   Hàm gửi 1 mục nhật ký, mặc định 1 dòng CSV qua ITM kênh 0 (SWO)
+ * @param   entry   Mục nhật ký
+ * @return  uint8_t     1 nếu đã gửi, 0 nếu debugger chưa bật ITM
+ **/
+__weak uint8_t Line_Log_Write(const Line_LogEntry *entry)
+{
+    char buf[48];
+    int  length;
+
+    if (!(ITM->TCR & ITM_TCR_ITMENA_Msk) || !(ITM->TER & 1UL))
+        return 0;
+    length = snprintf(buf, sizeof(buf), "%lu,%d,%d,%d,%d,%d\n", (unsigned long)entry->timeMs, entry->error,
+                      entry->output, entry->curvature, entry->target, entry->speed);
+    for (int i = 0; i < length && i < (int)sizeof(buf) - 1; i++)
+        ITM_SendChar(buf[i]);
+    return 1;
+}
+
+
+/**
+ * @brief   Hàm gửi nhật ký lịch tốc độ ra ngoài, gọi trong vòng lặp chính ở chế độ LINE
+ * @param   void
+ * @return  uint8_t     Số mục đã gửi
+ **/
+uint8_t Line_Log_Dump(void)
+{
+    uint8_t sent = 0;
+
+    while (sent < LINE_LOG_DUMP_MAX && logTail != logHead) {
+        if (!Line_Log_Write(&logBuffer[logTail]))               //**< Đầu ra chưa sẵn sàng: giữ mục lại >**/
+            break;
+        logTail = (logTail + 1) & (LINE_LOG_SIZE - 1);
+        sent++;
+    }
+    return sent;
+}
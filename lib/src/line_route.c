@@ -0,0 +1,189 @@
+/*********************************************************************************************************************
+ * @file    line_route.c
+ * @brief   Thư viện chạy lộ trình theo số giao lộ khi dò line
+ * @details Triển khai máy trạng thái dò line - tiến vào giao lộ - quay tìm nhánh, không phụ thuộc HAL.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "line_route.h"                 //**< Thư viện lộ trình >**/
+#include <stddef.h>                     //**< Thư viện sử dụng NULL >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Thao tác tính sẵn của 1 hành động
+ **/
+typedef struct {
+    char     action;                    //**< Ký tự hành động                       >**/
+    uint8_t  requiredArm;               //**< Nhánh giao lộ phải có (0: không cần)  >**/
+    int8_t   turnSign;                  //**< Chiều quay (1: trái, -1: phải, 0: không quay) >**/
+    uint16_t advanceMs;                 //**< Thời gian tiến vào giữa giao lộ (ms)  >**/
+    uint16_t turnMinMs;                 //**< Thời gian quay tối thiểu (ms)         >**/
+    uint8_t  reverse;                   //**< 1: đổi chiều đi, không quay           >**/
+} Route_Manoeuvre;
+
+static const Route_Manoeuvre manoeuvres[] = {
+    { 'S', ROUTE_ARM_STRAIGHT,  0, 0,                0,                  0 },
+    { 'L', ROUTE_ARM_LEFT,      1, ROUTE_ADVANCE_MS, ROUTE_TURN_MIN_MS,  0 },
+    { 'R', ROUTE_ARM_RIGHT,    -1, ROUTE_ADVANCE_MS, ROUTE_TURN_MIN_MS,  0 },
+    { 'U', 0,                   1, ROUTE_ADVANCE_MS, ROUTE_UTURN_MIN_MS, 0 },
+    { 'B', 0,                   0, 0,                0,                  1 },
+    { 'X', 0,                   0, ROUTE_ADVANCE_MS, 0,                  0 }
+};
+
+static const Route_Program  *program = NULL;                //**< Lộ trình đang chạy            >**/
+static const Route_Manoeuvre *current = NULL;               //**< Thao tác đang thực hiện       >**/
+static Route_State  routeState = ROUTE_IDLE;                //**< Trạng thái hiện tại           >**/
+static uint8_t      stepIndex = 0;                          //**< Số giao lộ đã xử lý           >**/
+static uint8_t      stepCount = 0;                          //**< Số bước của lộ trình          >**/
+static uint8_t      lastArms = 0;                           //**< Các nhánh của giao lộ gần nhất >**/
+static uint32_t     phaseStartMs = 0;                       //**< Thời điểm bắt đầu pha         >**/
+static uint8_t      reversePending = 0;                     //**< Chờ báo đổi chiều đi          >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ tra thao tác tính sẵn của 1 hành động
+ * @param   action  Ký tự hành động
+ * @return  const Route_Manoeuvre*  Thao tác, NULL nếu ký tự không hợp lệ
+ **/
+static const Route_Manoeuvre *Route_Find(char action)
+{
+    for (uint8_t i = 0; i < sizeof(manoeuvres) / sizeof(manoeuvres[0]); i++) {
+        if (manoeuvres[i].action == action)
+            return &manoeuvres[i];
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief   Hàm nội bộ kết thúc 1 bước, chuyển sang chờ giao lộ tiếp theo
+ * @param   void
+ * @return  void
+ **/
+static void Route_NextStep(void)
+{
+    current = NULL;
+    routeState = (stepIndex < stepCount) ? ROUTE_FOLLOW : ROUTE_IDLE;   //**< Hết chuỗi không có 'X': chỉ dò line >**/
+}
+
+
+/**
+ * @brief   Hàm bắt đầu chạy lộ trình
+ * @param   newProgram  Lộ trình, NULL để dừng chạy lộ trình (chỉ dò line)
+ * @return  void
+ **/
+void Route_Start(const Route_Program *newProgram)
+{
+    program    = newProgram;
+    current    = NULL;
+    stepIndex  = 0;
+    stepCount  = 0;
+    lastArms   = 0;
+    reversePending = 0;
+    routeState = ROUTE_IDLE;
+    if (program == NULL || program->steps == NULL)
+        return;
+    while (program->steps[stepCount] != '\0' && stepCount < UINT8_MAX)
+        stepCount++;
+    if (stepCount != 0)
+        routeState = ROUTE_FOLLOW;
+}
+
+
+/**
+ * @brief   Hàm báo xe vừa đi qua 1 giao lộ (sự kiện ngã ba / ngã tư)
+ * @param   arms    Các nhánh của giao lộ (ROUTE_ARM_...)
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+void Route_OnJunction(uint8_t arms, uint32_t nowMs)
+{
+    if (routeState != ROUTE_FOLLOW)
+        return;
+    lastArms = arms;
+    current  = Route_Find(program->steps[stepIndex]);
+    stepIndex++;
+    if (current == NULL || (current->requiredArm && !(arms & current->requiredArm))) {
+        routeState = ROUTE_FAILED;                              //**< Sai bản đồ hoặc đếm nhầm giao lộ >**/
+        return;
+    }
+    if (current->advanceMs == 0) {                              //**< Đi thẳng / đổi chiều: bộ dò line tự giữ hướng >**/
+        reversePending = current->reverse;
+        Route_NextStep();
+        return;
+    }
+    phaseStartMs = nowMs;
+    routeState   = ROUTE_ADVANCE;
+}
+
+
+/**
+ * @brief   Hàm cập nhật thao tác, gọi mỗi chu kỳ điều khiển
+ * @param   onLine  Mẫu đã lọc, bit = 1: thấy line (LINE1 = bit 4)
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @param   command Nơi lưu lệnh chuyển động khi lộ trình điều khiển xe
+ * @return  uint8_t     1 nếu lộ trình điều khiển xe (dùng command), 0 nếu để bộ dò line điều khiển
+ **/
+uint8_t Route_Update(uint8_t onLine, uint32_t nowMs, Route_Command *command)
+{
+    uint32_t elapsed = nowMs - phaseStartMs;
+
+    command->vx = command->vy = command->omega = 0;
+    command->reverse = reversePending;
+    reversePending = 0;
+    switch (routeState) {
+    case ROUTE_ADVANCE:
+        if (elapsed < current->advanceMs) {
+            command->vy = ROUTE_ADVANCE_SPEED;
+            return 1;
+        }
+        if (current->turnSign == 0) {                           //**< 'X': dừng tại tâm giao lộ >**/
+            routeState = ROUTE_DONE;
+            return 1;
+        }
+        phaseStartMs = nowMs;
+        routeState   = ROUTE_TURN;
+        command->omega = (int16_t)(current->turnSign * ROUTE_TURN_SPEED);
+        return 1;
+
+    case ROUTE_TURN:
+        if (elapsed >= current->turnMinMs && (onLine & ROUTE_MASK_MIDDLE)) {
+            Route_NextStep();                                   //**< Bắt được nhánh mới >**/
+            return 0;
+        }
+        if (elapsed > ROUTE_TURN_MAX_MS) {
+            routeState = ROUTE_FAILED;
+            return 1;
+        }
+        command->omega = (int16_t)(current->turnSign * ROUTE_TURN_SPEED);
+        return 1;
+
+    case ROUTE_DONE:
+    case ROUTE_FAILED:
+        return 1;                                               //**< Đứng yên chờ lộ trình mới >**/
+
+    default:
+        return 0;
+    }
+}
+
+
+/**
+ * @brief   Hàm đọc tiến độ lộ trình
+ * @param   progress    Nơi lưu tiến độ
+ * @return  void
+ **/
+void Route_GetProgress(Route_Progress *progress)
+{
+    progress->name   = (program != NULL) ? program->name : NULL;
+    progress->state  = (uint8_t)routeState;
+    progress->step   = stepIndex;
+    progress->total  = stepCount;
+    progress->arms   = lastArms;
+    if (current != NULL)
+        progress->action = current->action;
+    else
+        progress->action = (stepIndex < stepCount) ? program->steps[stepIndex] : '\0';
+}
@@ -12,6 +12,10 @@
 /* ===============================================[ INCLUDE FILE ]============================================*/
 #include "mecanum.h"                          //**< Thư viện chứa các hàm điều khiển động cơ Mecanum >**/
 #include <stm32f4xx_hal.h>                    //**< Thư viện HAL cho STM32F4 >**/
+#include "latency_probe.h"                    //**< Thư viện đo độ trễ tay cầm - động cơ >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+static int16_t motorCommand[4] = {0, 0, 0, 0};               //**< Công suất 4 bánh đã ra lệnh gần nhất >**/
 
 /* ============================================[ FUNCTION PROTOTYPES ]========================================*/
 /**
@@ -181,6 +185,7 @@ void carSetMotors(int16_t power0, int16_t power1, int16_t power2, int16_t power3
     int16_t PWM[4];                                              //**< PWM động cơ            >**/
 
     for (uint8_t i = 0; i < 4; i++) {
+        motorCommand[i] = power[i];
         dir[i] = power[i] > 0;
 
         if (MOTOR_DIRECTIONS[i])                                //**< Nếu motor đảo chiều, thay đổi hướng >**/
@@ -204,6 +209,7 @@ void carSetMotors(int16_t power0, int16_t power1, int16_t power2, int16_t power3
         //delayMs(200);
     }
 		DirControlMotorUpdate();                                    //**< Cập nhật dữ liệu điều khiển động cơ >**/
+    Latency_Probe_Stamp(LATENCY_STAGE_COMMIT);                  //**< CCR và 74HC595 đã được ghi >**/
 }
 
 
@@ -264,4 +270,52 @@ void carMove(int16_t angle, int16_t power, int8_t rot, uint8_t drift) {
 }
 
 
+/**
+ * @brief   Hàm điều khiển xe theo vector vận tốc
+ * @details Hàm này trộn vận tốc tịnh tiến và vận tốc quay cho 4 bánh Mecanum bằng số nguyên,
+ *          chuẩn hóa về 100 % nếu có bánh vượt quá rồi gọi carSetMotors.
+ * @param   vx      Vận tốc sang ngang (-100 - 100 %, sang phải dương)
+ * @param   vy      Vận tốc tiến lùi (-100 - 100 %, tiến lên dương)
+ * @param   omega   Vận tốc quay (-100 - 100 %, quay trái dương)
+ * @return  void
+ **/
+void carMoveVector(int16_t vx, int16_t vy, int16_t omega) {
+    int32_t power[4];                                            //**< Công suất động cơ      >**/
+    int32_t peak = 0;                                            //**< Công suất lớn nhất     >**/
+
+    power[0] = (int32_t)vy + vx - omega;
+    power[1] = (int32_t)vy - vx + omega;
+    power[2] = (int32_t)vy + vx + omega;
+    power[3] = (int32_t)vy - vx - omega;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        int32_t magnitude = (power[i] < 0) ? -power[i] : power[i];
+        if (magnitude > peak)
+            peak = magnitude;
+    }
+    if (peak > 100) {                                            //**< Giữ tỉ lệ giữa các bánh >**/
+        for (uint8_t i = 0; i < 4; i++)
+            power[i] = power[i] * 100 / peak;
+    }
 
+    carSetMotors(power[0], power[1], power[2], power[3]);        //**< Gọi hàm điều khiển động cơ >**/
+}
+
+
+/**
+ * @brief   Hàm đọc vector vận tốc đã ra lệnh gần nhất
+ * @details Hàm này suy ngược vector từ công suất 4 bánh của lần gọi carSetMotors gần nhất
+ *          (dùng được cho mọi hàm carXxx): vy = (p0 + p1 + p2 + p3) / 4,
+ *          vx = (p0 - p1 + p2 - p3) / 4, omega = (-p0 + p1 + p2 - p3) / 4.
+ * @param   vx      Nơi lưu vận tốc sang ngang (%, sang phải dương)
+ * @param   vy      Nơi lưu vận tốc tiến lùi (%, tiến lên dương)
+ * @param   omega   Nơi lưu vận tốc quay (%, quay trái dương)
+ * @return  void
+ **/
+void carGetVector(int16_t *vx, int16_t *vy, int16_t *omega) {
+    int16_t p0 = motorCommand[0], p1 = motorCommand[1], p2 = motorCommand[2], p3 = motorCommand[3];
+
+    *vx    = ( p0 - p1 + p2 - p3) / 4;
+    *vy    = ( p0 + p1 + p2 + p3) / 4;
+    *omega = (-p0 + p1 + p2 - p3) / 4;
+}
@@ -0,0 +1,382 @@
+/*********************************************************************************************************************
+ * @file    occupancy_grid.c
+ * @brief   Thư viện bản đồ chiếm chỗ cục bộ quanh xe
+ * @details Triển khai bản đồ log-odds cuộn theo xe, odometry theo lệnh và chiếu tia Bresenham bằng số nguyên.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "occupancy_grid.h"             //**< Thư viện bản đồ chiếm chỗ >**/
+#include <string.h>                     //**< Thư viện sử dụng hàm memset >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define GRID_MASK               (GRID_SIZE - 1)
+#define GRID_CLEARANCE_STEP_MM  (GRID_CELL_MM / 2)  //**< Bước dò khoảng trống (mm) >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Bảng sin 0 - 90 độ (x 16384)
+ **/
+static const int16_t sinTable[91] = {
+        0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+     2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+     5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+     8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384
+};
+
+static int8_t   cells[GRID_SIZE][GRID_SIZE];                //**< Log-odds, chỉ số [y & MASK][x & MASK] >**/
+static int32_t  originX = -GRID_SIZE / 2;                   //**< Ô góc dưới trái của bản đồ (x)    >**/
+static int32_t  originY = -GRID_SIZE / 2;                   //**< Ô góc dưới trái của bản đồ (y)    >**/
+
+static int32_t  poseXUm = 0;                                //**< Tọa độ x (um)                     >**/
+static int32_t  poseYUm = 0;                                //**< Tọa độ y (um)                     >**/
+static int32_t  headingMdeg = 0;                            //**< Hướng xe (0 - 359999 mili độ)     >**/
+static uint32_t lastOdometryMs = 0;                         //**< Thời điểm tích phân trước         >**/
+static uint8_t  odometryStarted = 0;                        //**< Đã có mốc thời gian               >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm tra sin theo độ bằng bảng
+ * @param   deg     Góc (độ, bất kỳ)
+ * @return  int16_t sin x 16384
+ **/
+int16_t Grid_Sin(int16_t deg)
+{
+    deg %= 360;
+    if (deg < 0)
+        deg += 360;
+    if (deg <= 90)
+        return sinTable[deg];
+    if (deg <= 180)
+        return sinTable[180 - deg];
+    if (deg <= 270)
+        return -sinTable[deg - 180];
+    return -sinTable[360 - deg];
+}
+
+
+/**
+ * @brief   Hàm nội bộ tra cos theo độ
+ * @param   deg     Góc (độ, bất kỳ)
+ * @return  int16_t cos x 16384
+ **/
+static int16_t Grid_Cos(int16_t deg)
+{
+    return Grid_Sin(deg + 90);
+}
+
+
+/**
+ * @brief   Hàm nội bộ đổi tọa độ mm sang chỉ số ô (làm tròn xuống cả với số âm)
+ * @param   mm      Tọa độ (mm)
+ * @return  int32_t Chỉ số ô
+ **/
+static int32_t Grid_ToCell(int32_t mm)
+{
+    return (mm >= 0) ? mm / GRID_CELL_MM : -((-mm + GRID_CELL_MM - 1) / GRID_CELL_MM);
+}
+
+
+/**
+ * @brief   Hàm nội bộ trả về con trỏ đến ô nếu ô nằm trong bản đồ
+ * @param   cx      Chỉ số ô x
+ * @param   cy      Chỉ số ô y
+ * @return  int8_t* Con trỏ đến ô, NULL nếu ngoài bản đồ
+ **/
+static int8_t *Grid_Cell(int32_t cx, int32_t cy)
+{
+    if (cx < originX || cx >= originX + GRID_SIZE || cy < originY || cy >= originY + GRID_SIZE)
+        return NULL;
+    return &cells[cy & GRID_MASK][cx & GRID_MASK];
+}
+
+
+/**
+ * @brief   Hàm nội bộ cộng log-odds vào ô, có giới hạn
+ * @param   cell    Ô cần cập nhật
+ * @param   delta   Giá trị cộng
+ * @return  void
+ **/
+static void Grid_Accumulate(int8_t *cell, int8_t delta)
+{
+    int16_t value = *cell + delta;
+
+    if (value > GRID_LOGODDS_LIMIT)
+        value = GRID_LOGODDS_LIMIT;
+    else if (value < -GRID_LOGODDS_LIMIT)
+        value = -GRID_LOGODDS_LIMIT;
+    *cell = (int8_t)value;
+}
+
+
+/**
+ * @brief   Hàm nội bộ cuộn bản đồ để xe nằm gần tâm
+ * @details Chỉ các cột / hàng mới đi vào bản đồ được xóa; các ô còn lại giữ nguyên vị trí lưu trữ.
+ * @param   void
+ * @return  void
+ **/
+static void Grid_Recenter(void)
+{
+    int32_t robotX = Grid_ToCell(poseXUm / 1000);
+    int32_t robotY = Grid_ToCell(poseYUm / 1000);
+    int32_t newX = robotX - GRID_SIZE / 2;
+    int32_t newY = robotY - GRID_SIZE / 2;
+    int32_t from, to;
+
+    if (newX - originX > GRID_RECENTER_CELLS || originX - newX > GRID_RECENTER_CELLS) {
+        from = (newX > originX) ? originX + GRID_SIZE : newX;   //**< Các cột mới đi vào >**/
+        to   = (newX > originX) ? newX + GRID_SIZE : originX;
+        if (to - from > GRID_SIZE)
+            from = to - GRID_SIZE;
+        for (int32_t cx = from; cx < to; cx++) {
+            for (uint8_t row = 0; row < GRID_SIZE; row++)
+                cells[row][cx & GRID_MASK] = 0;
+        }
+        originX = newX;
+    }
+
+    if (newY - originY > GRID_RECENTER_CELLS || originY - newY > GRID_RECENTER_CELLS) {
+        from = (newY > originY) ? originY + GRID_SIZE : newY;   //**< Các hàng mới đi vào >**/
+        to   = (newY > originY) ? newY + GRID_SIZE : originY;
+        if (to - from > GRID_SIZE)
+            from = to - GRID_SIZE;
+        for (int32_t cy = from; cy < to; cy++)
+            memset(cells[cy & GRID_MASK], 0, GRID_SIZE);
+        originY = newY;
+    }
+}
+
+
+/**
+ * @brief   Hàm xóa bản đồ và đặt xe về gốc tọa độ
+ * @param   void
+ * @return  void
+ **/
+void Grid_Init(void)
+{
+    memset(cells, 0, sizeof(cells));
+    originX = originY = -GRID_SIZE / 2;
+    poseXUm = poseYUm = 0;
+    headingMdeg = 0;
+    odometryStarted = 0;
+}
+
+
+/**
+ * @brief   Hàm cập nhật vị trí xe từ vector vận tốc đã ra lệnh
+ * @param   vx      Vận tốc sang ngang (-100 - 100 %, sang phải dương)
+ * @param   vy      Vận tốc tiến lùi (-100 - 100 %, tiến lên dương)
+ * @param   omega   Vận tốc quay (-100 - 100 %, quay trái dương)
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+void Grid_Odometry(int16_t vx, int16_t vy, int16_t omega, uint32_t nowMs)
+{
+    uint32_t dtMs;
+    int32_t  forwardUm, rightUm;
+    int16_t  heading, sinH, cosH;
+
+    if (!odometryStarted) {
+        odometryStarted = 1;
+        lastOdometryMs  = nowMs;
+        return;
+    }
+    dtMs = nowMs - lastOdometryMs;
+    lastOdometryMs = nowMs;
+    if (dtMs == 0)
+        return;
+    if (dtMs > GRID_ODOM_MAX_DT_MS)
+        dtMs = GRID_ODOM_MAX_DT_MS;
+
+    // % x (mm/s) x ms / 100 = um, % x (do/s) x ms / 100 = mili do
+    forwardUm = (int32_t)vy * GRID_SPEED_MM_S * (int32_t)dtMs / 100;
+    rightUm   = (int32_t)vx * GRID_SPEED_MM_S * (int32_t)dtMs / 100;
+    heading   = (int16_t)(headingMdeg / 1000);
+    sinH      = Grid_Sin(heading);
+    cosH      = Grid_Cos(heading);
+
+    // phai cua xe la huong (heading - 90): (sin, -cos)
+    poseXUm += (int32_t)(((int64_t)forwardUm * cosH + (int64_t)rightUm * sinH) >> 14);
+    poseYUm += (int32_t)(((int64_t)forwardUm * sinH - (int64_t)rightUm * cosH) >> 14);
+
+    headingMdeg += (int32_t)omega * GRID_TURN_DEG_S * (int32_t)dtMs / 100;
+    headingMdeg %= 360000;
+    if (headingMdeg < 0)
+        headingMdeg += 360000;
+
+    Grid_Recenter();
+}
+
+
+/**
+ * @brief   Hàm cập nhật bản đồ từ 1 mẫu khoảng cách
+ * @details Tia Bresenham từ ô của xe đến ô cuối; mỗi mẫu cập nhật tối đa GRID_RAY_MAX_MM / GRID_CELL_MM ô.
+ * @param   bearingDeg  Hướng cảm biến so với đầu xe (độ, trái dương)
+ * @param   distanceMm  Khoảng cách đo được (mm)
+ * @param   valid       1: có vật cản tại distanceMm, 0: ngoài tầm (chỉ đánh dấu trống)
+ * @return  void
+ **/
+void Grid_AddRange(int16_t bearingDeg, uint16_t distanceMm, uint8_t valid)
+{
+    int16_t angle = (int16_t)(headingMdeg / 1000) + bearingDeg;
+    int32_t xMm = poseXUm / 1000, yMm = poseYUm / 1000;
+    int32_t x0, y0, x1, y1, dx, dy, sx, sy, err;
+    uint8_t hit = valid;
+
+    if (!valid || distanceMm > GRID_RAY_MAX_MM) {               //**< Ngoài tầm tin cậy: chỉ đánh dấu trống >**/
+        distanceMm = GRID_RAY_MAX_MM;
+        hit = 0;
+    }
+
+    x0 = Grid_ToCell(xMm);
+    y0 = Grid_ToCell(yMm);
+    x1 = Grid_ToCell(xMm + (((int32_t)distanceMm * Grid_Cos(angle)) >> 14));
+    y1 = Grid_ToCell(yMm + (((int32_t)distanceMm * Grid_Sin(angle)) >> 14));
+    dx = (x1 > x0) ? x1 - x0 : x0 - x1;
+    dy = (y1 > y0) ? y0 - y1 : y1 - y0;                         //**< -|dy| >**/
+    sx = (x1 > x0) ? 1 : -1;
+    sy = (y1 > y0) ? 1 : -1;
+    err = dx + dy;
+
+    for (;;) {
+        int8_t *cell = Grid_Cell(x0, y0);
+        int32_t e2;
+
+        if (cell == NULL)                                       //**< Tia ra khỏi bản đồ >**/
+            return;
+        if (x0 == x1 && y0 == y1) {
+            Grid_Accumulate(cell, hit ? GRID_LOGODDS_HIT : GRID_LOGODDS_FREE);
+            return;
+        }
+        Grid_Accumulate(cell, GRID_LOGODDS_FREE);
+
+        e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0  += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0  += sy;
+        }
+    }
+}
+
+
+/**
+ * @brief   Hàm tính khoảng trống theo 1 hướng
+ * @param   bearingDeg  Hướng so với đầu xe (độ, trái dương)
+ * @return  uint16_t    Khoảng cách đến ô có vật cản đầu tiên (mm), tối đa GRID_RAY_MAX_MM
+ **/
+uint16_t Grid_Clearance(int16_t bearingDeg)
+{
+    int16_t angle = (int16_t)(headingMdeg / 1000) + bearingDeg;
+    int32_t xMm = poseXUm / 1000, yMm = poseYUm / 1000;
+    int16_t sinA = Grid_Sin(angle), cosA = Grid_Cos(angle);
+
+    for (uint16_t d = GRID_CLEARANCE_STEP_MM; d <= GRID_RAY_MAX_MM; d += GRID_CLEARANCE_STEP_MM) {
+        int8_t *cell = Grid_Cell(Grid_ToCell(xMm + (((int32_t)d * cosA) >> 14)),
+                                 Grid_ToCell(yMm + (((int32_t)d * sinA) >> 14)));
+        if (cell == NULL)                                       //**< Hết bản đồ: coi như trống >**/
+            return d;
+        if (*cell > GRID_OCCUPIED)
+            return d - GRID_CLEARANCE_STEP_MM;
+    }
+    return GRID_RAY_MAX_MM;
+}
+
+
+/**
+ * @brief   Hàm tìm hướng có khoảng trống lớn nhất
+ * @param   fromDeg     Hướng bắt đầu (độ, trái dương)
+ * @param   toDeg       Hướng kết thúc (độ, >= fromDeg)
+ * @param   stepDeg     Bước góc (độ, > 0)
+ * @param   clearanceMm Nơi lưu khoảng trống của hướng tìm được, NULL nếu không cần
+ * @return  int16_t     Hướng có khoảng trống lớn nhất (độ)
+ **/
+int16_t Grid_BestDirection(int16_t fromDeg, int16_t toDeg, uint8_t stepDeg, uint16_t *clearanceMm)
+{
+    int16_t  bestDeg = fromDeg;
+    uint16_t bestMm = 0;
+
+    if (stepDeg == 0)
+        stepDeg = 1;
+    for (int16_t deg = fromDeg; deg <= toDeg; deg += stepDeg) {
+        uint16_t clearance = Grid_Clearance(deg);
+        int16_t  absDeg = (deg < 0) ? -deg : deg;
+        int16_t  absBest = (bestDeg < 0) ? -bestDeg : bestDeg;
+
+        if (clearance > bestMm || (clearance == bestMm && absDeg < absBest)) {
+            bestMm  = clearance;
+            bestDeg = deg;
+        }
+    }
+    if (clearanceMm != NULL)
+        *clearanceMm = bestMm;
+    return bestDeg;
+}
+
+
+/**
+ * @brief   Hàm duyệt các ô có log-odds > 0 trong bán kính quanh xe
+ * @param   radiusMm    Bán kính (mm)
+ * @param   visitor     Hàm được gọi với mỗi ô
+ * @return  void
+ **/
+void Grid_ForEachOccupied(uint16_t radiusMm, Grid_CellVisitor visitor)
+{
+    int32_t xMm = poseXUm / 1000, yMm = poseYUm / 1000;
+    int32_t radius2 = (int32_t)radiusMm * radiusMm;
+
+    for (int32_t cy = originY; cy < originY + GRID_SIZE; cy++) {
+        int32_t dy = cy * GRID_CELL_MM + GRID_CELL_MM / 2 - yMm;
+        const int8_t *row = cells[cy & GRID_MASK];
+
+        if (dy * dy > radius2)
+            continue;
+        for (int32_t cx = originX; cx < originX + GRID_SIZE; cx++) {
+            int8_t  value = row[cx & GRID_MASK];
+            int32_t dx;
+
+            if (value <= 0)
+                continue;
+            dx = cx * GRID_CELL_MM + GRID_CELL_MM / 2 - xMm;
+            if (dx * dx + dy * dy <= radius2)
+                visitor(dx, dy, value);
+        }
+    }
+}
+
+
+/**
+ * @brief   Hàm đọc vị trí xe hiện tại
+ * @param   pose    Nơi lưu vị trí
+ * @return  void
+ **/
+void Grid_GetPose(Grid_Pose *pose)
+{
+    pose->xMm        = poseXUm / 1000;
+    pose->yMm        = poseYUm / 1000;
+    pose->headingDeg = (int16_t)(headingMdeg / 1000);
+}
+
+
+/**
+ * @brief   Hàm đọc log-odds của ô chứa 1 điểm
+ * @param   xMm     Tọa độ x (mm)
+ * @param   yMm     Tọa độ y (mm)
+ * @return  int8_t  Log-odds, 0 nếu điểm nằm ngoài bản đồ
+ **/
+int8_t Grid_CellAt(int32_t xMm, int32_t yMm)
+{
+    int8_t *cell = Grid_Cell(Grid_ToCell(xMm), Grid_ToCell(yMm));
+
+    return (cell != NULL) ? *cell : 0;
+}
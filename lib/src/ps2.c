@@ -10,10 +10,83 @@
  *********************************************************************************************************************/
 /* ============================================[ INCLUDE FILE ]============================================*/
 #include "ps2.h"            //**< Thư viện đọc điều khiển tay cầm PS2 bằng STM32 >**/
+#include <string.h>         //**< Thư viện sử dụng hàm memset >**/
+#include "latency_probe.h"  //**< Đo độ trễ tay cầm - động cơ >**/
 
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/*
+ * NON-CONFIG MODE
+ */
+/* Main polling command */
+static const uint8_t main_polling_42[9] = { 0x01, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 
+/* Exit Config Mode */
+static const uint8_t exit_config_43[9] = { 0x01, 0x43, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A };
 
+/*
+ * CONFIG MODE RESPONSES
+ */
+/* Find out what buttons are included in poll responses. */
+static const uint8_t find_polling_41[9] = { 0x01, 0x41, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A };
+
+/* Enter Config Mode, */
+static const uint8_t enter_config_43[9] = { 0x01, 0x43, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+/* Switch modes between digital and analog */
+static const uint8_t switch_mode_44[9] = { 0x01, 0x44, 0x00, 0x01, 0x03, 0x00, 0x00, 0x00, 0x00 };
+
+/* Get more status info */
+static const uint8_t read_more_info_45[9] = { 0x01, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+/* Read an unknown constant value from controller */
+static const uint8_t type_read_46[2][9] = {{ 0x01, 0x46, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A },
+                                           { 0x01, 0x46, 0x00, 0x01, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A }};
+
+/* Read an unknown constant value from controller */
+static const uint8_t type_read_47[9] = { 0x01, 0x47, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A };
+
+/* Read an unknown constant value from controller */
+static const uint8_t type_read_4c[2][9] = {{ 0x01, 0x4C, 0x00, 0x00, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A },
+                                           { 0x01, 0x4C, 0x00, 0x01, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A }};
+
+static const uint8_t enable_rumble_4d[9] = { 0x01, 0x4D, 0x00, 0x00, 0x01, 0xFF, 0xFF, 0xFF, 0xFF };
+
+static const uint8_t set_bytes_large_4f[9] = { 0x01, 0x4F, 0x00, 0xFF, 0xFF, 0x03, 0x00, 0x00, 0x00 };
 
+/**
+ * @brief   1 khung của chuỗi cấu hình tay cầm
+ **/
+typedef struct {
+    const uint8_t *command;             //**< Khung lệnh                            >**/
+    uint8_t        length;              //**< Số byte của khung                     >**/
+    uint8_t        feature;             //**< Chỉ gửi khi bật PS2_FEATURE_... (0: luôn gửi) >**/
+} PS2_ConfigStep;
+
+/* 0x42 -> 0x43 (vào CONFIG) -> 0x44 (ANALOG) [-> 0x4D] [-> 0x4F] -> 0x42 -> 0x43 (thoát CONFIG) -> 0x42 đọc ID */
+static const PS2_ConfigStep configSteps[] = {
+    { main_polling_42,    5, 0                    },
+    { enter_config_43,    5, 0                    },
+    { switch_mode_44,     9, 0                    },
+    { enable_rumble_4d,   9, PS2_FEATURE_RUMBLE   },        //**< byte 3: động cơ nhỏ, byte 4: động cơ lớn >**/
+    { set_bytes_large_4f, 9, PS2_FEATURE_PRESSURE },        //**< khung 21 byte có áp lực nút >**/
+    { main_polling_42,    5, 0                    },
+    { exit_config_43,     9, 0                    },
+    { main_polling_42,    9, 0                    },        //**< Chọn độ dài khung theo ID tay cầm trả về >**/
+};
+#define PS2_CONFIG_STEPS    (sizeof(configSteps) / sizeof(configSteps[0]))
+
+
+static PS2_Driver * volatile transferDriver = NULL;     //**< Tay cầm của khung đang truyền (NULL: rảnh) >**/
+static uint8_t              transferLength = 0;         //**< Số byte của khung hiện tại    >**/
+static PS2_TransferCallback transferCallback = NULL;    //**< Callback của khung hiện tại   >**/
+
+static PS2_Driver          *pollDrivers[PS2_MAX_CONTROLLERS];  //**< Danh sách tay cầm được polling >**/
+static uint8_t              pollCount = 0;              //**< Số tay cầm đã đăng ký         >**/
+static uint8_t              pollCursor = 0;             //**< Tay cầm tiếp theo trong chu kỳ polling >**/
+static volatile uint32_t    pollOverruns = 0;           //**< Số chu kỳ polling bị bỏ qua   >**/
+static uint8_t              pollRunning = 0;            //**< Polling nền đang chạy         >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
 /**
  * @brief   Hàm sử dụng để tạo độ trễ trong micro giây      
  * @details Hàm này sẽ tạo độ trễ trong khoảng thời gian được chỉ định bằng micro giây.  
@@ -29,19 +102,20 @@ void delay_us(uint16_t us) {
 /**
  * @brief   Hàm nội bộ Truyền và nhận dữ liệu thông qua SPI  
  * @details Hàm này sẽ truyền dự liệu băng SPI với data được cấu hình sẵn theo từng yêu cầu
- *          Sau đó sẽ nhận dữ liệu phản hồi từ SP2 và lưu vào ps2_response
+ *          Sau đó sẽ nhận dữ liệu phản hồi từ SP2 và lưu vào driver->response
+ * @param   driver    Đối tượng tay cầm
  * @param   command   Mảng dữ liệu cấu hình sẵn cho 1 chức năng nhất định
  * @param   length    Kích thước dữ liệu truyền
  * @return  void
  **/
-static void PS2_SendCommand(const uint8_t command[], uint8_t length){
-    CS_LOW;
+static void PS2_SendCommand(PS2_Driver *driver, const uint8_t command[], uint8_t length){
+    PS2_CS_LOW(driver);
     delay_us(15);  
     for (uint8_t i = 0; i < length; i++) {
-        HAL_SPI_TransmitReceive(&hspi1, (uint8_t*)&command[i], &ps2_response[i], sizeof(uint8_t), 1);
+        HAL_SPI_TransmitReceive(driver->hspi, (uint8_t*)&command[i], &driver->response[i], sizeof(uint8_t), 1);
 	    delay_us(15);
     }
-    CS_HIGH;      
+    PS2_CS_HIGH(driver);      
 }
 
 // Các hàm truyền lệnh đặc thù cho từng CMD
@@ -50,83 +124,525 @@ static void PS2_SendCommand(const uint8_t command[], uint8_t length){
  * @details Các hàm này sẽ truyền lệnh đặc thù để giao tiếp với SP2 
  *          Như: cấu hình PS2, chuyển đổi trạng thái, đọc dữ liệu điều khiển,..
  * @note    Hàm này sẽ gọi Truyền và nhận dữ liệu thông qua SPI 
+ * @param   driver  Đối tượng tay cầm
  * @param   mode    Chế độ đọc TYPEREAD
- * @param   void
  * @return  void
  **/
-static void PS2_MainPolling(void)       { PS2_SendCommand(main_polling_42,9);       }
-static void PS2_Polling(void)           { PS2_SendCommand(main_polling_42, 5);      }
-static void PS2_ExitConfig(void)        { PS2_SendCommand(exit_config_43, 9);       }
-static void PS2_FindPolling(void)       { PS2_SendCommand(find_polling_41, 9);      }
-static void PS2_EnterConfig(void)       { PS2_SendCommand(enter_config_43, 5);      }
-static void PS2_SwitchMode(void)        { PS2_SendCommand(switch_mode_44, 9);       }
-static void PS2_ReadMoreInfo(void)      { PS2_SendCommand(read_more_info_45, 9);    }
-static void PS2_TypeRead46(uint8_t mode){ PS2_SendCommand(type_read_46[mode], 9);   }
-static void PS2_TypeRead47(void)        { PS2_SendCommand(type_read_47, 9);         }
-static void PS2_TypeRead4C(uint8_t mode){ PS2_SendCommand(type_read_4c[mode], 9);   }
-static void PS2_EnableRumble4D(void)    { PS2_SendCommand(enable_rumble_4d, 9);     }
-static void PS2_SetBytesLarge4F(void)   { PS2_SendCommand(set_bytes_large_4f, 9);   }
+static void PS2_FindPolling(PS2_Driver *d)          { PS2_SendCommand(d, find_polling_41, 9);      }
+static void PS2_ReadMoreInfo(PS2_Driver *d)         { PS2_SendCommand(d, read_more_info_45, 9);    }
+static void PS2_TypeRead46(PS2_Driver *d, uint8_t mode){ PS2_SendCommand(d, type_read_46[mode], 9); }
+static void PS2_TypeRead47(PS2_Driver *d)           { PS2_SendCommand(d, type_read_47, 9);         }
+static void PS2_TypeRead4C(PS2_Driver *d, uint8_t mode){ PS2_SendCommand(d, type_read_4c[mode], 9); }
 
 
 /**
- * @brief   Hàm khởi tạo giao tiếp PS2
- * @details Hàm này sẽ truyền các lệnh setup và cấu hình chế độ PS2
- *          0x42 (READ_DATA) -> 0X43 (ENTER_CONFIG_MODE) -> 0X44 (ANALOG_MODE) -> 0X43 (EXIT_CONFIG_MODE)
+ * @brief   Hàm nội bộ dừng Timer tạo nhịp và tắt các yêu cầu DMA của khung hiện tại
+ * @param   driver  Tay cầm của khung hiện tại
+ * @return  void
+ **/
+static void PS2_Transfer_Stop(PS2_Driver *driver){
+    __HAL_TIM_DISABLE_DMA(&PS2_TIM_PACER, TIM_DMA_UPDATE);
+    HAL_TIM_Base_Stop(&PS2_TIM_PACER);
+    HAL_DMA_Abort(PS2_TIM_PACER.hdma[TIM_DMA_ID_UPDATE]);       //**< Trả DMA Timer về READY    >**/
+    CLEAR_BIT(driver->hspi->Instance->CR2, SPI_CR2_RXDMAEN);
+    PS2_CS_HIGH(driver);
+}
+
+
+/**
+ * @brief   Hàm nội bộ callback khi DMA nhận của SPI nhận đủ khung (gọi trong ngắt DMA)
+ * @param   hdma    Handle DMA nhận của SPI
+ * @return  void
+ **/
+static void PS2_Transfer_RxCplt(DMA_HandleTypeDef *hdma){
+    PS2_Driver *driver = transferDriver;
+    PS2_TransferCallback callback = transferCallback;
+
+    (void)hdma;
+    if (driver == NULL)
+        return;
+    PS2_Transfer_Stop(driver);
+    driver->frameUs = TIMEBASE_ELAPSED(Timebase_Micros(), driver->frameStartUs);
+    if (driver->frameUs > driver->frameMaxUs) {                 //**< Đo thời gian thực tế mỗi khung >**/
+        driver->frameMaxUs = driver->frameUs;
+    }
+    transferDriver = NULL;
+    if (callback != NULL) {
+        callback(driver, transferLength);
+    }
+}
+
+
+/**
+ * @brief   Hàm nội bộ callback khi DMA nhận của SPI lỗi (gọi trong ngắt DMA)
+ * @param   hdma    Handle DMA nhận của SPI
+ * @return  void
+ **/
+static void PS2_Transfer_RxError(DMA_HandleTypeDef *hdma){
+    (void)hdma;
+    if (transferDriver == NULL)
+        return;
+    PS2_Transfer_Stop(transferDriver);
+    transferDriver = NULL;
+}
+
+
+/**
+ * @brief   Hàm bắt đầu truyền một khung lệnh PS2 bằng SPI DMA
+ * @details Byte đầu tiên được ghi ở sự kiện update đầu tiên, tức là sau PS2_BYTE_PERIOD_US
+ *          kể từ khi kéo CS xuống, đảm bảo thời gian thiết lập CS như delay_us(15) trước đây.
+ * @param   driver      Đối tượng tay cầm
+ * @param   command     Khung lệnh cần gửi
+ * @param   length      Số byte của khung (tối đa PS2_FRAME_MAX)
+ * @param   callback    Hàm gọi khi hoàn thành (có thể NULL)
+ * @return  HAL_StatusTypeDef   HAL_OK nếu đã bắt đầu, HAL_BUSY nếu khung trước chưa xong
+ **/
+HAL_StatusTypeDef PS2_Transfer_Start(PS2_Driver *driver, const uint8_t *command, uint8_t length, PS2_TransferCallback callback){
+    SPI_HandleTypeDef *hspi = driver->hspi;
+    SPI_TypeDef *spi = hspi->Instance;
+
+    if (transferDriver != NULL)
+        return HAL_BUSY;
+    if (length == 0 || length > PS2_FRAME_MAX)
+        return HAL_ERROR;
+
+    transferDriver   = driver;
+    transferLength   = length;
+    transferCallback = callback;
+    driver->frameStartUs = Timebase_Micros();
+
+    (void)spi->DR;                                              //**< Xóa dữ liệu cũ và cờ OVR  >**/
+    (void)spi->SR;
+    __HAL_SPI_ENABLE(hspi);
+
+    hspi->hdmarx->XferCpltCallback  = PS2_Transfer_RxCplt;
+    hspi->hdmarx->XferErrorCallback = PS2_Transfer_RxError;
+    if (HAL_DMA_Start_IT(hspi->hdmarx, (uint32_t)&spi->DR, (uint32_t)driver->response, length) != HAL_OK) {
+        transferDriver = NULL;
+        return HAL_ERROR;
+    }
+    SET_BIT(spi->CR2, SPI_CR2_RXDMAEN);
+
+    if (HAL_DMA_Start(PS2_TIM_PACER.hdma[TIM_DMA_ID_UPDATE], (uint32_t)command, (uint32_t)&spi->DR, length) != HAL_OK) {
+        HAL_DMA_Abort(hspi->hdmarx);
+        CLEAR_BIT(spi->CR2, SPI_CR2_RXDMAEN);
+        transferDriver = NULL;
+        return HAL_ERROR;
+    }
+
+    PS2_CS_LOW(driver);
+    __HAL_TIM_SET_AUTORELOAD(&PS2_TIM_PACER, PS2_BYTE_PERIOD_US - 1);
+    __HAL_TIM_SET_COUNTER(&PS2_TIM_PACER, 0);
+    __HAL_TIM_ENABLE_DMA(&PS2_TIM_PACER, TIM_DMA_UPDATE);       //**< Mỗi update ghi 1 byte vào SPI->DR >**/
+    HAL_TIM_Base_Start(&PS2_TIM_PACER);
+    return HAL_OK;
+}
+
+
+/**
+ * @brief   Hàm kiểm tra có khung SPI DMA đang truyền hay không
+ * @param   void
+ * @return  uint8_t     1 nếu đang truyền
+ **/
+uint8_t PS2_Transfer_Busy(void){
+    return transferDriver != NULL;
+}
+
+
+/**
+ * @brief   Hàm hủy khung SPI DMA đang truyền
  * @param   void
  * @return  void
  **/
-void PS2_Init(void){ 
-    PS2_Polling();
-    PS2_EnterConfig();                          //**< vào CONFIG MODE       >**/
-    PS2_SwitchMode();                           //**< ANALOG MODE           >**/
-	PS2_Polling();
-    PS2_ExitConfig();                           //**< thoát CONFIG MODE     >**/
+void PS2_Transfer_Abort(void){
+    PS2_Driver *driver = transferDriver;
+
+    if (driver == NULL)
+        return;
+    HAL_DMA_Abort(driver->hspi->hdmarx);
+    PS2_Transfer_Stop(driver);
+    transferDriver = NULL;
 }
 
+
 /**
- * @brief   Hàm đọc trạng thái của các nút bấm
- * @details Hàm này sẽ xử lý data trạng thái nút bấm được PS2 trả về trong ps2_response,
- *          sau đó lưu trạng thái nút vào ps2
+ * @brief   Hàm nội bộ công bố trạng thái PS2 vào bộ đệm kép (gọi trong ngắt)
+ * @param   driver          Tay cầm cần công bố
+ * @param   timestampUs     Thời điểm nhận xong khung (us)
+ * @return  void
+ **/
+static void PS2_Poll_Publish(PS2_Driver *driver, uint32_t timestampUs){
+    uint8_t next = driver->snapshotIndex ^ 1;
+
+    driver->snapshotSeq++;                                      //**< Lẻ: đang ghi              >**/
+    __DMB();
+    driver->snapshot[next].state       = driver->state;
+    driver->snapshot[next].mode        = driver->mode;
+    driver->snapshot[next].timestampUs = timestampUs;
+    driver->snapshot[next].frame       = driver->snapshot[driver->snapshotIndex].frame + 1;
+    driver->snapshotIndex = next;
+    __DMB();
+    driver->snapshotSeq++;                                      //**< Chẵn: đã công bố          >**/
+}
+
+
+/**
+ * @brief   Hàm nội bộ bỏ qua các khung cấu hình của tính năng không được bật
+ * @param   driver      Đối tượng tay cầm
+ * @param   step        Khung cấu hình bắt đầu tìm
+ * @return  uint8_t     Khung cấu hình cần gửi, PS2_CONFIG_STEPS nếu đã hết chuỗi
+ **/
+static uint8_t PS2_Config_Skip(PS2_Driver *driver, uint8_t step){
+    while (step < PS2_CONFIG_STEPS && configSteps[step].feature && !(driver->features & configSteps[step].feature))
+        step++;
+    return step;
+}
+
+
+/**
+ * @brief   Hàm nội bộ kết thúc chuỗi cấu hình khi đã nhận khung 0x42 cuối
+ * @details Giải mã khung cuối, ghi nhận ID tay cầm sau khi cấu hình và xóa cờ khởi tạo lại.
+ * @param   driver      Đối tượng tay cầm
+ * @return  void
+ **/
+static void PS2_Config_Finish(PS2_Driver *driver){
+    driver->frameLength = PS2_FRAME_ANALOG;
+    PS2_ButtonPressed(driver);
+    driver->link.expectedId = driver->link.consecutiveMisses ? 0 : driver->response[1];
+    driver->reinitPending   = 0;
+    driver->reinitUs        = Timebase_Micros();
+}
+
+
+static void PS2_Poll_Complete(PS2_Driver *driver, uint8_t length);
+static void PS2_Config_Complete(PS2_Driver *driver, uint8_t length);
+
+/**
+ * @brief   Hàm nội bộ khởi động khung polling của tay cầm tiếp theo trong chu kỳ
+ * @details Tay cầm đang khởi tạo lại gửi khung cấu hình tiếp theo thay cho khung polling trong lượt của nó,
+ *          các tay cầm khác vẫn được polling bình thường.
  * @param   void
  * @return  void
  **/
-void PS2_ButtonPressed(void){
-    if (ps2 == NULL) {                           //**< Chỉ cấp phát nếu ps2 chưa được cấp phát >**/
-        ps2 = (PS2 *)malloc(sizeof(PS2));
+static void PS2_Poll_Next(void){
+    while (pollCursor < pollCount) {
+        PS2_Driver *driver = pollDrivers[pollCursor++];
+        HAL_StatusTypeDef status;
+
+        if (driver->configStep) {
+            const PS2_ConfigStep *step = &configSteps[driver->configStep - 1];
+            status = PS2_Transfer_Start(driver, step->command, step->length, PS2_Config_Complete);
+        } else {
+            status = PS2_Transfer_Start(driver, driver->command, driver->frameLength, PS2_Poll_Complete);
+        }
+        if (status == HAL_OK)
+            return;
+        pollOverruns++;                                         //**< Bỏ qua tay cầm này, thử tay cầm sau >**/
+    }
+}
+
+
+/**
+ * @brief   Hàm nội bộ callback khung cấu hình trong lượt polling (gọi trong ngắt DMA)
+ * @details Mỗi lượt polling chỉ gửi 1 khung cấu hình; khung lỗi (DMA lỗi) không gọi callback
+ *          nên được gửi lại ở lượt sau.
+ * @param   driver      Tay cầm vừa nhận xong khung
+ * @param   length      Số byte đã nhận
+ * @return  void
+ **/
+static void PS2_Config_Complete(PS2_Driver *driver, uint8_t length){
+    uint8_t next = PS2_Config_Skip(driver, driver->configStep);
+
+    (void)length;
+    if (next >= PS2_CONFIG_STEPS) {
+        PS2_Config_Finish(driver);
+        PS2_Poll_Publish(driver, Timebase_Micros());
+        driver->configStep = 0;                                 //**< Lượt sau polling bình thường >**/
+    } else {
+        driver->configStep = next + 1;
+    }
+    PS2_Poll_Next();
+}
+
+
+/**
+ * @brief   Hàm nội bộ callback khung polling nền (gọi trong ngắt DMA)
+ * @param   driver      Tay cầm vừa nhận xong khung
+ * @param   length      Số byte đã nhận
+ * @return  void
+ **/
+static void PS2_Poll_Complete(PS2_Driver *driver, uint8_t length){
+    uint32_t timestampUs = Timebase_Micros();
+    uint32_t cycles = Timebase_Cycles();
+    uint16_t buttons = driver->state.data.buttonData;
+    uint16_t stickR  = driver->state.data.coordinatesR;
+    uint16_t stickL  = driver->state.data.coordinatesL;
+    uint8_t  changed;
+
+    (void)length;
+    PS2_ButtonPressed(driver);
+    changed = driver->state.data.buttonData != buttons ||
+              driver->state.data.coordinatesR != stickR || driver->state.data.coordinatesL != stickL;
+    PS2_Poll_Publish(driver, timestampUs);
+    if (driver->features & PS2_FEATURE_LATENCY) {               //**< Chỉ tay cầm lái xe được đo >**/
+        if (changed)                                            //**< Trạng thái thay đổi: bắt đầu đo, gắn số khung vừa công bố >**/
+            Latency_Probe_Start(cycles, driver->snapshot[driver->snapshotIndex].frame);
+        Latency_Probe_Stamp(LATENCY_STAGE_DECODE);
     }
-		if(ps2_response[1] == 0x73)
+    PS2_Poll_Next();                                            //**< Polling lần lượt các tay cầm >**/
+}
+
+
+/**
+ * @brief   Hàm nội bộ truyền chuỗi lệnh cấu hình cho tay cầm (chặn, không dùng DMA)
+ * @details 0x42 (READ_DATA) -> 0X43 (ENTER_CONFIG_MODE) -> 0X44 (ANALOG_MODE)
+ *          [-> 0x4D (ENABLE_RUMBLE)] [-> 0x4F (SET_BYTES_LARGE)] -> 0X43 (EXIT_CONFIG_MODE),
+ *          sau đó đọc 1 khung để biết ID tay cầm trả về. Chỉ dùng trong PS2_Init,
+ *          khởi tạo lại khi đang polling chạy bằng DMA trong lượt polling (PS2_Link_Service).
+ * @param   driver      Đối tượng tay cầm
+ * @return  void
+ **/
+static void PS2_Configure(PS2_Driver *driver){
+    PS2_CS_HIGH(driver);
+
+    for (uint8_t step = PS2_Config_Skip(driver, 0); step < PS2_CONFIG_STEPS; step = PS2_Config_Skip(driver, step + 1)) {
+        PS2_SendCommand(driver, configSteps[step].command, configSteps[step].length);
+    }
+    PS2_Config_Finish(driver);
+}
+
+
+/**
+ * @brief   Hàm khởi tạo giao tiếp PS2
+ * @details Hàm này sẽ truyền các lệnh setup và cấu hình chế độ PS2
+ *          0x42 (READ_DATA) -> 0X43 (ENTER_CONFIG_MODE) -> 0X44 (ANALOG_MODE)
+ *          [-> 0x4D (ENABLE_RUMBLE)] [-> 0x4F (SET_BYTES_LARGE)] -> 0X43 (EXIT_CONFIG_MODE)
+ * @param   driver      Đối tượng tay cầm (cấp phát tĩnh)
+ * @param   hspi        Handle SPI nối với tay cầm
+ * @param   csPort      Port chân CS
+ * @param   csPin       Chân CS
+ * @param   features    PS2_FEATURE_RUMBLE | PS2_FEATURE_PRESSURE | PS2_FEATURE_LATENCY, 0 để chỉ dùng analog
+ * @return  HAL_StatusTypeDef   HAL_OK, HAL_ERROR nếu đã đủ PS2_MAX_CONTROLLERS tay cầm
+ **/
+HAL_StatusTypeDef PS2_Init(PS2_Driver *driver, SPI_HandleTypeDef *hspi, GPIO_TypeDef *csPort, uint16_t csPin, uint8_t features){ 
+    uint8_t registered = 0;
+
+    for (uint8_t i = 0; i < pollCount; i++) {
+        if (pollDrivers[i] == driver)
+            registered = 1;
+    }
+    if (!registered && pollCount >= PS2_MAX_CONTROLLERS)
+        return HAL_ERROR;
+
+    memset(driver, 0, sizeof(PS2_Driver));
+    driver->hspi   = hspi;
+    driver->csPort = csPort;
+    driver->csPin  = csPin;
+    driver->features = features;
+    for (uint8_t i = 0; i < sizeof(main_polling_42); i++) {     //**< Phần còn lại của khung là 0x00 >**/
+        driver->command[i] = main_polling_42[i];
+    }
+    PS2_Configure(driver);
+
+    if (!registered) {
+        pollDrivers[pollCount++] = driver;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief   Hàm đọc trạng thái của các nút bấm
+ * @details Hàm này sẽ xử lý data trạng thái nút bấm được PS2 trả về trong driver->response,
+ *          sau đó lưu trạng thái nút vào driver->state
+ * @param   driver  Đối tượng tay cầm
+ * @return  void
+ **/
+void PS2_ButtonPressed(PS2_Driver *driver){
+    const uint8_t *response = driver->response;
+
+		if(response[1] == 0x79)
+		{
+			driver->mode = 2;
+		}
+		else if(response[1] == 0x73)
 		{
-			PS2_MODE = 1;
+			driver->mode = 1;
 		}
-		else if (ps2_response[1] != 0x73)
+		else
 		{
-			PS2_MODE= 0;
+			driver->mode = 0;
 		}
-    if(ps2_response[1] == 0x41 | ps2_response[1] == 0x73){
-        ps2->data.buttonData    = ~(ps2_response[3] | (ps2_response[4] << 8));
-        ps2->data.coordinatesR  = ps2_response[5] | (ps2_response[6] << 8);
-        ps2->data.coordinatesL  = ps2_response[7] | (ps2_response[8] << 8);
+    if(response[1] == 0x41 | response[1] == 0x73 | response[1] == 0x79){
+        driver->state.data.buttonData    = ~(response[3] | (response[4] << 8));
+        driver->state.data.coordinatesR  = response[5] | (response[6] << 8);
+        driver->state.data.coordinatesL  = response[7] | (response[8] << 8);
+
+        driver->link.validFrames++;
+        driver->link.consecutiveMisses = 0;
+        driver->link.lastGoodUs = Timebase_Micros();
+        if (response[1] != driver->link.expectedId) {          //**< Tay cầm xuất hiện lại / bị reset >**/
+            driver->reinitPending = 1;
+        }
+    } else {
+        driver->link.badIds++;                                  //**< Giữ trạng thái cũ, PS2_Link_Alive báo mất tín hiệu >**/
+        driver->link.consecutiveMisses++;
+    }
+
+    // Khung 0x79 chỉ được đọc đủ 21 byte khi đã bật PS2_FEATURE_PRESSURE, giới hạn thời gian mỗi khung
+    if (response[1] == 0x79 && (driver->features & PS2_FEATURE_PRESSURE)) {
+        if (driver->frameLength == PS2_FRAME_MAX) {
+            for (uint8_t i = 0; i < PS2_PRESSURE_COUNT; i++) {
+                driver->state.button.pressure[i] = response[PS2_FRAME_ANALOG + i];
+            }
+        }
+        driver->frameLength = PS2_FRAME_MAX;
+    } else {
+        driver->frameLength = PS2_FRAME_ANALOG;                 //**< Tay cầm khởi động lại / không hỗ trợ áp lực >**/
     }
 }
 
 
 /**
- * @brief   Hàm cập nhật trạng thái của PS2
- * @details Hàm này sẽ gửi lệnh để nhận trạng thái của PS2
- *          Sau đó sẽ gọi hàm đọc trạng thái nút để lưu lại
+ * @brief   Hàm đặt mức rung của tay cầm
+ * @param   driver  Đối tượng tay cầm
+ * @param   small   Động cơ nhỏ (0: tắt, khác 0: bật)
+ * @param   large   Động cơ lớn (0: tắt, 1 - 255: tốc độ, được đưa về PS2_RUMBLE_LARGE_MIN - 0xFF)
+ * @return  void
+ **/
+void PS2_SetRumble(PS2_Driver *driver, uint8_t small, uint8_t large){
+    if (!(driver->features & PS2_FEATURE_RUMBLE))
+        return;
+    if (large != 0) {
+        large = PS2_RUMBLE_LARGE_MIN + (uint16_t)large * (0xFF - PS2_RUMBLE_LARGE_MIN) / 0xFF;
+    }
+    driver->command[3] = small ? 0x01 : 0x00;                   //**< Byte ghi đơn, DMA không đọc được giá trị nửa vời >**/
+    driver->command[4] = large;
+}
+
+
+/**
+ * @brief   Hàm bắt đầu polling PS2 nền theo Timer
+ * @param   rateHz  Tần số polling (Hz), 0 để dùng PS2_POLL_RATE_HZ
+ * @return  void
+ **/
+void PS2_Poll_Start(uint16_t rateHz){
+    PS2_Poll_SetRate(rateHz ? rateHz : PS2_POLL_RATE_HZ);
+    __HAL_TIM_SET_COUNTER(&PS2_TIM_POLL, 0);
+    HAL_TIM_Base_Start_IT(&PS2_TIM_POLL);
+    pollRunning = 1;
+}
+
+
+/**
+ * @brief   Hàm dừng polling PS2 nền
  * @param   void
  * @return  void
  **/
-void PS2_Update(void){
-    PS2_MainPolling();
-    PS2_ButtonPressed();
-	HAL_Delay(10);
+void PS2_Poll_Stop(void){
+    HAL_TIM_Base_Stop_IT(&PS2_TIM_POLL);
+    pollRunning = 0;
+}
+
+
+/**
+ * @brief   Hàm thay đổi tần số polling PS2 nền
+ * @param   rateHz  Tần số polling (Hz)
+ * @return  void
+ **/
+void PS2_Poll_SetRate(uint16_t rateHz){
+    uint32_t periodUs, minUs;
+
+    if (rateHz == 0)
+        return;
+    periodUs = 1000000UL / rateHz;
+    minUs    = (uint32_t)PS2_BYTE_PERIOD_US * (PS2_FRAME_MAX + 1) * (pollCount ? pollCount : 1);
+    if (periodUs < minUs)                                       //**< Không ngắn hơn 1 lượt polling các tay cầm >**/
+        periodUs = minUs;
+    if (periodUs > PS2_POLL_PERIOD_MAX_US)                      //**< ARR 16 bit: tránh tràn thành tần số bất kỳ >**/
+        periodUs = PS2_POLL_PERIOD_MAX_US;
+    __HAL_TIM_SET_AUTORELOAD(&PS2_TIM_POLL, periodUs - 1);
+}
+
+
+/**
+ * @brief   Hàm đọc ảnh chụp trạng thái PS2 mới nhất
+ * @param   driver      Đối tượng tay cầm
+ * @param   snapshot    Nơi lưu ảnh chụp
+ * @param   ageUs       Tuổi của dữ liệu tính đến lúc đọc (us), có thể NULL
+ * @return  uint8_t     1 nếu đã có ít nhất 1 khung hợp lệ, 0 nếu chưa
+ **/
+uint8_t PS2_Poll_Read(PS2_Driver *driver, PS2_Snapshot *snapshot, uint32_t *ageUs){
+    uint32_t seq;
+
+    do {
+        seq = driver->snapshotSeq;
+        __DMB();
+        *snapshot = driver->snapshot[driver->snapshotIndex];
+        __DMB();
+    } while ((seq & 1U) || seq != driver->snapshotSeq);                 //**< Bị ngắt ghi đè giữa chừng: đọc lại >**/
+
+    if (ageUs != NULL) {
+        *ageUs = TIMEBASE_ELAPSED(Timebase_Micros(), snapshot->timestampUs);
+    }
+    return snapshot->frame != 0;
+}
+
+
+/**
+ * @brief   Hàm xử lý ngắt Timer polling PS2
+ * @param   htim    Handle Timer phát sinh ngắt
+ * @return  void
+ **/
+void PS2_Poll_TimerHandler(TIM_HandleTypeDef *htim){
+    if (htim->Instance != PS2_TIM_POLL.Instance)
+        return;
+    if (PS2_Transfer_Busy()) {                                  //**< Lượt trước chưa xong  >**/
+        pollOverruns++;
+        return;
+    }
+    pollCursor = 0;
+    PS2_Poll_Next();
 }
 
 
+/**
+ * @brief   Hàm kiểm tra liên kết với tay cầm còn hoạt động
+ * @param   driver      Đối tượng tay cầm
+ * @param   deadlineUs  Thời gian tối đa kể từ khung hợp lệ gần nhất (us)
+ * @return  uint8_t     1 nếu đã nhận khung hợp lệ trong deadlineUs, 0 nếu mất tín hiệu
+ **/
+uint8_t PS2_Link_Alive(PS2_Driver *driver, uint32_t deadlineUs){
+    if (driver->link.validFrames == 0)
+        return 0;
+    return TIMEBASE_ELAPSED(Timebase_Micros(), driver->link.lastGoodUs) < deadlineUs;
+}
 
 
+/**
+ * @brief   Hàm phục vụ liên kết PS2, gọi trong vòng lặp chính
+ * @param   void
+ * @return  void
+ **/
+void PS2_Link_Service(void){
+    for (uint8_t i = 0; i < pollCount; i++) {
+        PS2_Driver *driver = pollDrivers[i];
 
+        if (!driver->reinitPending || driver->configStep ||
+            TIMEBASE_ELAPSED(Timebase_Micros(), driver->reinitUs) < PS2_LINK_REINIT_INTERVAL_US)
+            continue;
 
+        driver->reinitUs = Timebase_Micros();                   //**< Chưa xong chuỗi cấu hình: thử lại sau khoảng cách tối thiểu >**/
+        driver->link.reinits++;
+        driver->configStep = PS2_Config_Skip(driver, 0) + 1;    //**< Ngắt polling gửi chuỗi cấu hình trong lượt của tay cầm này >**/
+    }
+}
 
 
+/**
+ * @brief   Hàm đọc số chu kỳ polling bị bỏ qua vì khung trước chưa xong
+ * @param   void
+ * @return  uint32_t    Số lần tràn
+ **/
+uint32_t PS2_Poll_Overruns(void){
+    return pollOverruns;
+}
@@ -0,0 +1,185 @@
+/*********************************************************************************************************************
+ * @file    ps2_event.c
+ * @brief   Thư viện tạo sự kiện nút bấm từ trạng thái tay cầm PS2
+ * @details Triển khai phát hiện cạnh bằng phép toán bit, máy trạng thái từng nút
+ *          và hàng đợi vòng các sự kiện nhấn / nhả / giữ lâu / lặp lại.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "ps2_event.h"                  //**< Thư viện sự kiện nút bấm PS2 >**/
+#include <stddef.h>                     //**< Định nghĩa NULL >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define BUTTON_FLAG_LONG        0x01    //**< Đã tạo sự kiện LONG_PRESS     >**/
+#define BUTTON_FLAG_REPEAT      0x02    //**< Đang trong giai đoạn lặp lại  >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Máy trạng thái của một nút (5 byte)
+ * @note    Thời gian lưu 16 bit thấp (ms), đủ cho thời gian giữ tới 65 s.
+ **/
+typedef struct {
+    uint16_t pressMs;                   //**< Thời điểm nhấn                    >**/
+    uint16_t lastRepeatMs;              //**< Thời điểm REPEAT gần nhất         >**/
+    uint8_t  flags;                     //**< BUTTON_FLAG_...                   >**/
+} PS2_ButtonState;
+
+static PS2_EventConfig eventConfig = {
+    PS2_EVENT_LONG_PRESS_MS, PS2_EVENT_REPEAT_DELAY_MS, PS2_EVENT_REPEAT_PERIOD_MS, 0xFFFF, 0x0000
+};
+static PS2_ButtonState buttonState[PS2_EVENT_BUTTONS];     //**< Trạng thái từng nút           >**/
+static uint16_t  previousButtons = 0;                       //**< buttonData lần đọc trước      >**/
+
+static PS2_Event eventQueue[PS2_EVENT_QUEUE_SIZE];          //**< Hàng đợi vòng sự kiện         >**/
+static uint8_t   eventHead = 0;                             //**< Vị trí ghi                    >**/
+static uint8_t   eventTail = 0;                             //**< Vị trí đọc                    >**/
+static uint32_t  eventDropped = 0;                          //**< Số sự kiện bị mất             >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ tìm vị trí bit 1 thấp nhất
+ * @param   bits    Giá trị khác 0
+ * @return  uint8_t Vị trí bit (0 - 15)
+ **/
+static uint8_t PS2_Event_LowestBit(uint16_t bits)
+{
+    uint8_t index = 0;
+
+    while (!(bits & 1U)) {
+        bits >>= 1;
+        index++;
+    }
+    return index;
+}
+
+
+/**
+ * @brief   Hàm nội bộ đưa một sự kiện vào hàng đợi
+ * @param   button  Vị trí bit của nút
+ * @param   type    Loại sự kiện
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+static void PS2_Event_Push(uint8_t button, PS2_EventType type, uint32_t nowMs)
+{
+    uint8_t next = (eventHead + 1) & (PS2_EVENT_QUEUE_SIZE - 1);
+
+    if (next == eventTail) {                                    //**< Hàng đợi đầy >**/
+        eventDropped++;
+        return;
+    }
+    eventQueue[eventHead].mask   = (uint16_t)(1U << button);
+    eventQueue[eventHead].type   = (uint8_t)type;
+    eventQueue[eventHead].button = button;
+    eventQueue[eventHead].timeMs = nowMs;
+    eventHead = next;
+}
+
+
+/**
+ * @brief   Hàm khởi tạo lớp sự kiện nút bấm
+ * @param   config  Cấu hình thời gian, NULL để dùng giá trị mặc định (không nút nào lặp lại)
+ * @return  void
+ **/
+void PS2_Event_Init(const PS2_EventConfig *config)
+{
+    if (config != NULL) {
+        eventConfig = *config;
+    }
+    for (uint8_t i = 0; i < PS2_EVENT_BUTTONS; i++) {
+        buttonState[i].flags = 0;
+    }
+    previousButtons = 0;
+    eventHead = eventTail = 0;
+}
+
+
+/**
+ * @brief   Hàm cập nhật trạng thái nút và tạo sự kiện
+ * @param   buttonData  Trạng thái 16 nút (bit = 1: đang nhấn), ps2->data.buttonData
+ * @param   nowMs       Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+void PS2_Event_Update(uint16_t buttonData, uint32_t nowMs)
+{
+    uint16_t changed  = buttonData ^ previousButtons;
+    uint16_t pressed  = changed & buttonData;                   //**< Cạnh lên  >**/
+    uint16_t released = changed & previousButtons;              //**< Cạnh xuống >**/
+    uint16_t held     = buttonData & previousButtons & (eventConfig.longPressMask | eventConfig.repeatMask);
+    uint16_t now16    = (uint16_t)nowMs;
+    uint8_t  i;
+
+    previousButtons = buttonData;
+
+    while (released) {
+        i = PS2_Event_LowestBit(released);
+        released &= released - 1;
+        buttonState[i].flags = 0;
+        PS2_Event_Push(i, PS2_EVENT_RELEASE, nowMs);
+    }
+
+    while (pressed) {
+        i = PS2_Event_LowestBit(pressed);
+        pressed &= pressed - 1;
+        buttonState[i].pressMs = now16;
+        buttonState[i].flags   = 0;
+        PS2_Event_Push(i, PS2_EVENT_PRESS, nowMs);
+    }
+
+    while (held) {                                              //**< Chỉ duyệt các nút đang giữ >**/
+        PS2_ButtonState *state;
+        uint16_t heldMs;
+
+        i = PS2_Event_LowestBit(held);
+        held &= held - 1;
+        state  = &buttonState[i];
+        heldMs = (uint16_t)(now16 - state->pressMs);
+
+        if (!(state->flags & BUTTON_FLAG_LONG) && (eventConfig.longPressMask & (1U << i)) &&
+            heldMs >= eventConfig.longPressMs) {
+            state->flags |= BUTTON_FLAG_LONG;
+            PS2_Event_Push(i, PS2_EVENT_LONG_PRESS, nowMs);
+        }
+
+        if (eventConfig.repeatMask & (1U << i)) {
+            if (!(state->flags & BUTTON_FLAG_REPEAT)) {
+                if (heldMs >= eventConfig.repeatDelayMs) {
+                    state->flags |= BUTTON_FLAG_REPEAT;
+                    state->lastRepeatMs = now16;
+                    PS2_Event_Push(i, PS2_EVENT_REPEAT, nowMs);
+                }
+            } else if ((uint16_t)(now16 - state->lastRepeatMs) >= eventConfig.repeatPeriodMs) {
+                state->lastRepeatMs += eventConfig.repeatPeriodMs;     //**< Giữ nhịp đều, không trôi >**/
+                PS2_Event_Push(i, PS2_EVENT_REPEAT, nowMs);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief   Hàm lấy sự kiện tiếp theo trong hàng đợi
+ * @param   event   Nơi lưu sự kiện
+ * @return  uint8_t     1 nếu có sự kiện, 0 nếu hàng đợi trống
+ **/
+uint8_t PS2_Event_Get(PS2_Event *event)
+{
+    if (eventTail == eventHead)
+        return 0;
+    *event = eventQueue[eventTail];
+    eventTail = (eventTail + 1) & (PS2_EVENT_QUEUE_SIZE - 1);
+    return 1;
+}
+
+
+/**
+ * @brief   Hàm đọc số sự kiện bị mất do hàng đợi đầy
+ * @param   void
+ * @return  uint32_t    Số sự kiện bị mất
+ **/
+uint32_t PS2_Event_Dropped(void)
+{
+    return eventDropped;
+}
@@ -0,0 +1,143 @@
+/*********************************************************************************************************************
+ * @file    ps2_stick.c
+ * @brief   Thư viện chuyển joystick analog PS2 thành vector chuyển động
+ * @details Triển khai bảng đường cong expo / rate tính sẵn và vùng chết hình tròn cho joystick.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "ps2_stick.h"                  //**< Thư viện joystick analog PS2 >**/
+#include <stddef.h>                     //**< Định nghĩa NULL >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+static PS2_StickConfig stickConfig = {
+    { PS2_STICK_DEADZONE, PS2_STICK_MOVE_EXPO, PS2_STICK_MOVE_RATE },
+    { PS2_STICK_DEADZONE, PS2_STICK_TURN_EXPO, PS2_STICK_TURN_RATE }
+};
+static int8_t moveTable[256];           //**< Bảng đường cong tịnh tiến theo giá trị thô    >**/
+static int8_t turnTable[256];           //**< Bảng đường cong quay theo giá trị thô         >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ tính bảng đường cong cho 1 joystick
+ * @details Độ lệch được co lại (|d| - dead) / (127 - dead) trước đường cong,
+ *          nên đầu ra bắt đầu từ 0 ngay tại biên vùng chết thay vì nhảy bậc.
+ * @param   table   Bảng 256 phần tử cần tính
+ * @param   curve   Thông số đường cong
+ * @param   dead    Vùng chết theo trục (0: vùng chết đã xử lý trước khi tra bảng)
+ * @return  void
+ **/
+static void PS2_Stick_BuildTable(int8_t table[256], const PS2_StickCurve *curve, int16_t dead)
+{
+    float expo = curve->expo / 100.0f;
+    float rate = curve->rate / 100.0f;
+
+    if (dead > 126)
+        dead = 126;
+    for (uint16_t raw = 0; raw < 256; raw++) {
+        int16_t offset = (int16_t)raw - PS2_STICK_CENTER;
+        float t, out;
+
+        if (offset < -127)                                      //**< Đối xứng 2 phía: -127 - 127 >**/
+            offset = -127;
+        if (offset > dead)
+            t = (offset - dead) / (float)(127 - dead);
+        else if (offset < -dead)
+            t = (offset + dead) / (float)(127 - dead);
+        else
+            t = 0.0f;
+        out = rate * ((1.0f - expo) * t + expo * t * t * t) * PS2_STICK_OUTPUT_MAX;
+        table[raw] = (int8_t)(out >= 0 ? out + 0.5f : out - 0.5f);
+    }
+}
+
+
+/**
+ * @brief   Hàm nội bộ tính căn bậc hai số nguyên (làm tròn xuống)
+ * @param   value   Số cần tính căn
+ * @return  uint16_t    Phần nguyên của căn bậc hai
+ **/
+static uint16_t PS2_Stick_Isqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > value)
+        bit >>= 2;
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint16_t)root;
+}
+
+
+/**
+ * @brief   Hàm nội bộ co 1 thành phần của joystick trái theo bán kính
+ * @param   d       Độ lệch của trục so với tâm
+ * @param   r       Bán kính của joystick (> dead)
+ * @param   dead    Bán kính vùng chết (0 - 126)
+ * @return  uint8_t     Giá trị thô sau khi co, dùng để tra bảng
+ **/
+static uint8_t PS2_Stick_Radial(int16_t d, int32_t r, int32_t dead)
+{
+    int32_t scaled = (int32_t)d * 127 * (r - dead) / ((127 - dead) * r);
+
+    if (scaled > 127)                                           //**< Góc joystick: r lớn hơn 127 >**/
+        scaled = 127;
+    if (scaled < -127)
+        scaled = -127;
+    return (uint8_t)(scaled + PS2_STICK_CENTER);
+}
+
+
+/**
+ * @brief   Hàm khởi tạo và tính bảng đường cong joystick
+ * @param   config  Cấu hình đường cong, NULL để dùng giá trị mặc định
+ * @return  void
+ **/
+void PS2_Stick_Init(const PS2_StickConfig *config)
+{
+    if (config != NULL) {
+        stickConfig = *config;
+    }
+    PS2_Stick_BuildTable(moveTable, &stickConfig.move, 0);     //**< Vùng chết tròn xử lý trong PS2_Stick_Map >**/
+    PS2_Stick_BuildTable(turnTable, &stickConfig.turn, stickConfig.turn.deadzone);
+}
+
+
+/**
+ * @brief   Hàm chuyển giá trị joystick thô thành vector chuyển động
+ * @details Joystick trái: bán kính r tính 1 lần, vector (dx, dy) được co theo bán kính
+ *          127 * (r - deadzone) / (127 - deadzone) giữ nguyên hướng, rồi mới tra bảng đường cong.
+ * @param   lx      Joystick trái, trục X (0x00: trái - 0xFF: phải)
+ * @param   ly      Joystick trái, trục Y (0x00: lên - 0xFF: xuống)
+ * @param   rx      Joystick phải, trục X (0x00: trái - 0xFF: phải)
+ * @param   command Nơi lưu vector chuyển động
+ * @return  uint8_t     1 nếu có ít nhất 1 thành phần khác 0
+ **/
+uint8_t PS2_Stick_Map(uint8_t lx, uint8_t ly, uint8_t rx, PS2_StickCommand *command)
+{
+    int16_t dx = (int16_t)lx - PS2_STICK_CENTER;
+    int16_t dy = (int16_t)ly - PS2_STICK_CENTER;
+    int32_t deadMove = (stickConfig.move.deadzone < 127) ? stickConfig.move.deadzone : 126;
+    int32_t r = PS2_Stick_Isqrt((int32_t)dx * dx + (int32_t)dy * dy);
+
+    if (r <= deadMove) {                                        //**< Vùng chết hình tròn >**/
+        command->vx = 0;
+        command->vy = 0;
+    } else {
+        command->vx =  moveTable[PS2_Stick_Radial(dx, r, deadMove)];
+        command->vy = -moveTable[PS2_Stick_Radial(dy, r, deadMove)];   //**< Trục Y của PS2 hướng xuống >**/
+    }
+
+    command->omega = -turnTable[rx];                            //**< Gạt trái: quay trái (dương), vùng chết nằm trong bảng >**/
+
+    return command->vx != 0 || command->vy != 0 || command->omega != 0;
+}
@@ -1,6 +1,21 @@
 
 #include "servo.h"
 
+#define SERVO_CD_MAX            18000                   //**< 180 độ theo đơn vị 1/100 độ                   >**/
+#define SERVO_SERVICE_MAX_MS    100                     //**< Bỏ qua khoảng nghỉ dài giữa 2 lần gọi (ms)    >**/
+
+static Servo_Callback servoCallback = NULL;             //**< Gọi khi Servo ổn định                         >**/
+static uint16_t servoSlew = SERVO_SLEW_DEG_S;           //**< Giới hạn tốc độ lệnh (độ / s), 0: không giới hạn >**/
+static int32_t  targetCd = SERVO_CD_MAX / 2;            //**< Góc đích (1/100 độ)                           >**/
+static int32_t  commandCd = SERVO_CD_MAX / 2;           //**< Góc đang ghi ra PWM (1/100 độ)                >**/
+static int32_t  hornCd = 0;                             //**< Góc ước lượng của trục Servo (1/100 độ)       >**/
+static uint8_t  slewRemainder = 0;                      //**< Phần lẻ bước lệnh chưa dùng (1/1000 độ)       >**/
+static uint8_t  hornRemainder = 0;                      //**< Phần lẻ bước trục chưa dùng (1/1000 độ)       >**/
+static uint32_t lastServiceMs = 0;                      //**< Thời điểm cập nhật trước (ms)                 >**/
+static uint32_t arrivedMs = 0;                          //**< Thời điểm trục ước lượng còn đang quay (ms)   >**/
+static uint8_t  settled = 0;                            //**< 1: đã ổn định tại góc đích                    >**/
+static uint8_t  notifyPending = 0;                      //**< Chờ gọi callback                              >**/
+
 /**
  * @brief   Hàm khởi tạo Servo
  * @details Hàm này sẽ bắt đầu xung PWM và chỉnh góc Servo về phía trước
@@ -9,6 +24,9 @@
  **/
 void PWM_Servo_Start(void){
 	HAL_TIM_PWM_Start(&SERVO_TIM_HANDLE, SERVO_TIM_CHANNEL);
+	hornCd = 0;											//**< Chưa biết vị trí: coi như quay xa nhất về phía trước >**/
+	commandCd = targetCd = 9000;
+	ServoWrite(90);
 	SERVO_FRONT;
 }
 
@@ -19,9 +37,165 @@ void PWM_Servo_Start(void){
  * @return  void
  **/
 void ServoTurn(uint8_t angle)
+{
+    Servo_SetTarget(angle);
+    while (!Servo_IsSettled())
+        Servo_Service();
+}
+
+/**
+ * @brief   Hàm đặt góc Servo không chờ
+ * @details Hàm này chỉ ghi dutyCycle, không chờ Servo quay xong
+ * @param   angle	Góc muốn xuay ( tính theo độ )
+ * @return  void
+ **/
+void ServoWrite(uint8_t angle)
 {
 	uint16_t dutyCycle = angle* (SERVO_ANGLE_180 - SERVO_ANGLE_0) / 180 + SERVO_ANGLE_0;
     __HAL_TIM_SET_COMPARE(&SERVO_TIM_HANDLE, SERVO_TIM_CHANNEL, dutyCycle);
-    HAL_Delay(SERVO_DELAY_TIME_MS);
 }
 
+/**
+ * @brief   Hàm nội bộ tiến giá trị về đích tối đa 1 bước
+ * @param   value   Giá trị hiện tại
+ * @param   target  Giá trị đích
+ * @param   step    Bước tối đa (> 0)
+ * @return  int32_t Giá trị mới
+ **/
+static int32_t ServoApproach(int32_t value, int32_t target, int32_t step)
+{
+    if (target - value > step)
+        return value + step;
+    if (value - target > step)
+        return value - step;
+    return target;
+}
+
+/**
+ * @brief   Hàm nội bộ tính bước quay trong 1 khoảng thời gian, giữ phần lẻ cho lần sau
+ * @details Tốc độ thấp và chu kỳ gọi ngắn (ví dụ < 10 độ / s, mỗi 1 ms) cho bước nhỏ hơn 1/100 độ;
+ *          phần lẻ được cộng dồn nên lệnh vẫn tiến đúng tốc độ thay vì đứng yên.
+ * @param   degPerS     Tốc độ (độ / s)
+ * @param   elapsed     Thời gian (ms)
+ * @param   remainder   Phần lẻ cộng dồn (1/1000 độ)
+ * @return  int32_t     Bước (1/100 độ)
+ **/
+static int32_t ServoStep(uint16_t degPerS, uint32_t elapsed, uint8_t *remainder)
+{
+    uint32_t total = (uint32_t)degPerS * elapsed + *remainder;  //**< Độ / s x ms = 1/1000 độ >**/
+
+    *remainder = (uint8_t)(total % 10);
+    return (int32_t)(total / 10);
+}
+
+/**
+ * @brief   Hàm đặt góc đích không chờ
+ * @param   angle	Góc đích (0 - 180 độ)
+ * @return  void
+ **/
+void Servo_SetTarget(uint8_t angle)
+{
+    if (angle > 180)
+        angle = 180;
+    targetCd = (int32_t)angle * 100;
+    if (servoSlew == 0 && commandCd != targetCd) {
+        commandCd = targetCd;
+        ServoWrite(angle);
+    }
+    if (settled)
+        lastServiceMs = HAL_GetTick();                  //**< Đang đứng yên: không tính khoảng nghỉ trước đó vào quãng đã quay >**/
+    if (hornCd != targetCd || commandCd != targetCd)
+        settled = 0;
+    notifyPending = 1;
+}
+
+/**
+ * @brief   Hàm đặt giới hạn tốc độ lệnh
+ * @param   degPerS Tốc độ lệnh tối đa (độ / s), 0: không giới hạn
+ * @return  void
+ **/
+void Servo_SetSlew(uint16_t degPerS)
+{
+    servoSlew = degPerS;
+}
+
+/**
+ * @brief   Hàm đăng ký callback khi Servo ổn định
+ * @param   callback    Hàm callback, NULL để hủy
+ * @return  void
+ **/
+void Servo_OnSettled(Servo_Callback callback)
+{
+    servoCallback = callback;
+}
+
+/**
+ * @brief   Hàm cập nhật lệnh và vị trí ước lượng, gọi thường xuyên trong vòng lặp chính
+ * @details Lệnh tiến về đích theo giới hạn tốc độ; vị trí trục ước lượng đuổi theo lệnh với SERVO_SPEED_DEG_S.
+ * @param   void
+ * @return  void
+ **/
+void Servo_Service(void)
+{
+    uint32_t nowMs = HAL_GetTick();
+    uint32_t elapsed = nowMs - lastServiceMs;
+
+    if (elapsed > SERVO_SERVICE_MAX_MS)
+        elapsed = SERVO_SERVICE_MAX_MS;
+    lastServiceMs = nowMs;
+
+    if (commandCd != targetCd && servoSlew != 0) {
+        int32_t next = ServoApproach(commandCd, targetCd, ServoStep(servoSlew, elapsed, &slewRemainder));
+
+        if ((next + 50) / 100 != (commandCd + 50) / 100)
+            ServoWrite((uint8_t)((next + 50) / 100));
+        commandCd = next;
+    } else {
+        slewRemainder = 0;
+    }
+    if (hornCd != commandCd)
+        hornCd = ServoApproach(hornCd, commandCd, ServoStep(SERVO_SPEED_DEG_S, elapsed, &hornRemainder));
+    else
+        hornRemainder = 0;
+
+    if (hornCd != targetCd || commandCd != targetCd) {
+        arrivedMs = nowMs;
+        settled = 0;
+    } else if (!settled && nowMs - arrivedMs >= SERVO_SETTLE_MARGIN_MS) {
+        settled = 1;
+    }
+    if (settled && notifyPending) {
+        notifyPending = 0;
+        if (servoCallback != NULL)
+            servoCallback((uint8_t)(targetCd / 100));
+    }
+}
+
+/**
+ * @brief   Hàm kiểm tra Servo đã ổn định tại góc đích
+ * @param   void
+ * @return  uint8_t     1 nếu đã ổn định, 0 nếu đang quay
+ **/
+uint8_t Servo_IsSettled(void)
+{
+    return settled;
+}
+
+/**
+ * @brief   Hàm ước lượng thời gian còn lại đến khi ổn định
+ * @param   void
+ * @return  uint32_t    Thời gian (ms), 0 nếu đã ổn định
+ **/
+uint32_t Servo_SettleRemainingMs(void)
+{
+    int32_t distance = targetCd - hornCd;
+    uint32_t speed = SERVO_SPEED_DEG_S;
+
+    if (settled)
+        return 0;
+    if (servoSlew != 0 && servoSlew < speed)
+        speed = servoSlew;
+    if (distance < 0)
+        distance = -distance;
+    return (uint32_t)distance * 10 / speed + SERVO_SETTLE_MARGIN_MS;
+}
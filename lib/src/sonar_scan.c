@@ -0,0 +1,280 @@
+/*********************************************************************************************************************
+ * @file    sonar_scan.c
+ * @brief   Thư viện quét khoảng cách bằng Servo và cảm biến siêu âm
+ * @details Triển khai máy trạng thái quay Servo - chờ ổn định - lấy mẫu, không chặn vòng lặp chính.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "sonar_scan.h"                 //**< Thư viện quét khoảng cách >**/
+#include "timebase.h"                   //**< Thư viện nguồn thời gian micro giây >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   Trạng thái dịch vụ quét
+ **/
+typedef enum {
+    SCAN_IDLE     = 0,                  //**< Servo ở vị trí nghỉ                   >**/
+    SCAN_MOVING   = 1,                  //**< Đang chờ Servo ổn định                >**/
+    SCAN_SAMPLING = 2                   //**< Đang chờ mẫu phát sau khi ổn định     >**/
+} Scan_State;
+
+static HCSR05_Sensor   *scanSensor = NULL;                  //**< Cảm biến gắn trên Servo       >**/
+static uint8_t          scanAngles[SCAN_MAX_ANGLES] = { SCAN_ANGLE_LEFT, SCAN_ANGLE_RIGHT };
+static uint8_t          scanCount = 2;                      //**< Số góc của bộ góc             >**/
+
+static Scan_Polar       working;                            //**< Lượt quét đang thực hiện      >**/
+static Scan_Polar       result;                             //**< Lượt quét hoàn chỉnh gần nhất >**/
+static Scan_State       scanState = SCAN_IDLE;              //**< Trạng thái hiện tại           >**/
+static uint8_t          continuousScan = 0;                 //**< Quét qua lại liên tục         >**/
+static uint8_t          parking = 0;                        //**< Đang đưa Servo về phía trước  >**/
+static int8_t           direction = 1;                      //**< Chiều duyệt bộ góc            >**/
+static uint8_t          stepIndex = 0;                      //**< Góc đang đo                   >**/
+static uint32_t         stepStartMs = 0;                    //**< Thời điểm bắt đầu bước        >**/
+static uint32_t         sweepStartMs = 0;                   //**< Thời điểm bắt đầu lượt quét   >**/
+static uint32_t         settledUs = 0;                      //**< Thời điểm Servo ổn định (us)  >**/
+static uint8_t          sampleReady = 0;                    //**< Đã có mẫu cho bước hiện tại   >**/
+static HCSR05_Sample    stepSample;                         //**< Mẫu của bước hiện tại         >**/
+static Scan_StepCallback stepCallback = NULL;              //**< Callback báo từng bước        >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ nhận mẫu mới từ HCSR05 (gọi trong HCSR05_update)
+ * @details Chỉ nhận mẫu của cảm biến trên Servo có xung Trigger phát sau khi Servo ổn định:
+ *          với Echo hợp lệ, Echo bắt đầu sau thời điểm ổn định; với mẫu ngoài tầm,
+ *          mẫu kết thúc sau ít nhất 1 chu kỳ đo kể từ thời điểm ổn định.
+ * @param   sample  Mẫu mới
+ * @return  void
+ **/
+static void Scan_OnSample(const HCSR05_Sample *sample)
+{
+    if (scanState != SCAN_SAMPLING || sampleReady || sample->sensor != scanSensor->index)
+        return;
+    if (sample->valid) {
+        if ((int32_t)(sample->timestampUs - sample->pulseUs - settledUs) < 0)
+            return;                                             //**< Đo khi Servo còn đang quay >**/
+    } else if (sample->timestampUs - settledUs < HCSR05_MIN_PERIOD_US) {
+        return;
+    }
+    stepSample  = *sample;
+    sampleReady = 1;
+}
+
+
+/**
+ * @brief   Hàm nội bộ quay Servo tới góc mới và bắt đầu chờ ổn định
+ * @param   angle   Góc Servo (độ)
+ * @return  void
+ **/
+static void Scan_MoveTo(uint8_t angle)
+{
+    stepStartMs = HAL_GetTick();
+    sampleReady = 0;
+    scanState   = SCAN_MOVING;
+    Servo_SetTarget(angle);                                     //**< Thời gian chờ theo góc quay của bước >**/
+}
+
+
+/**
+ * @brief   Hàm nội bộ nhận báo Servo đã ổn định (gọi trong Servo_Service), bắt đầu lấy mẫu ngay
+ * @param   angle   Góc Servo (độ)
+ * @return  void
+ **/
+static void Scan_OnServoSettled(uint8_t angle)
+{
+    (void)angle;
+    if (scanState != SCAN_MOVING)
+        return;
+    HCSR05_Filter_Init(&scanSensor->filter);                    //**< Mỗi góc lọc riêng, không trộn mẫu của góc trước >**/
+    settledUs   = Timebase_Micros();
+    stepStartMs = HAL_GetTick();
+    sampleReady = 0;
+    scanState   = SCAN_SAMPLING;
+}
+
+
+/**
+ * @brief   Hàm nội bộ chuyển sang góc tiếp theo, công bố kết quả khi hết lượt
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @return  void
+ **/
+static void Scan_NextStep(uint32_t nowMs)
+{
+    int16_t next = (int16_t)stepIndex + direction;
+
+    if (next < 0 || next >= scanCount) {                        //**< Hết lượt quét >**/
+        working.durationMs = nowMs - sweepStartMs;
+        working.sequence   = result.sequence + 1;
+        result = working;
+        sweepStartMs = nowMs;
+
+        if (!continuousScan) {
+            parking = 1;
+            Scan_MoveTo(SCAN_ANGLE_FRONT);
+            return;
+        }
+        direction = -direction;                                 //**< Quét ngược lại, giữ điểm đầu mút >**/
+        next = (scanCount > 1) ? (int16_t)stepIndex + direction : stepIndex;
+    }
+    stepIndex = (uint8_t)next;
+    Scan_MoveTo(scanAngles[stepIndex]);
+}
+
+
+/**
+ * @brief   Hàm khởi tạo dịch vụ quét
+ * @param   sensor  Cảm biến gắn trên Servo
+ * @return  void
+ **/
+void Scan_Init(HCSR05_Sensor *sensor)
+{
+    if (scanSensor == NULL)
+        HCSR05_Subscribe(Scan_OnSample);
+    Servo_OnSettled(Scan_OnServoSettled);
+    scanSensor = sensor;
+    scanState  = SCAN_IDLE;
+}
+
+
+/**
+ * @brief   Hàm đăng ký callback nhận kết quả từng bước quét
+ * @param   callback    Hàm callback, NULL để hủy đăng ký
+ * @return  void
+ **/
+void Scan_OnStep(Scan_StepCallback callback)
+{
+    stepCallback = callback;
+}
+
+
+/**
+ * @brief   Hàm đặt bộ góc quét
+ * @param   angles  Mảng góc theo thứ tự quét (độ)
+ * @param   count   Số góc (1 - SCAN_MAX_ANGLES)
+ * @return  uint8_t     1 nếu thành công, 0 nếu count không hợp lệ hoặc đang quét
+ **/
+uint8_t Scan_SetAngles(const uint8_t *angles, uint8_t count)
+{
+    if (count == 0 || count > SCAN_MAX_ANGLES || scanState != SCAN_IDLE)
+        return 0;
+    for (uint8_t i = 0; i < count; i++) {
+        scanAngles[i] = angles[i];
+    }
+    scanCount = count;
+    return 1;
+}
+
+
+/**
+ * @brief   Hàm bắt đầu quét
+ * @param   continuous  0: quét 1 lượt rồi quay về phía trước, 1: quét qua lại liên tục
+ * @return  void
+ **/
+void Scan_Start(uint8_t continuous)
+{
+    if (scanSensor == NULL)
+        return;
+    for (uint8_t i = 0; i < scanCount; i++) {
+        working.points[i].angle      = scanAngles[i];
+        working.points[i].valid      = 0;
+        working.points[i].distanceMm = HCSR05_MAX_RANGE_MM;
+        working.points[i].timeMs     = 0;
+    }
+    working.count  = scanCount;
+    continuousScan = continuous;
+    parking        = 0;
+    direction      = 1;
+    stepIndex      = 0;
+    sweepStartMs   = HAL_GetTick();
+    Scan_MoveTo(scanAngles[0]);
+}
+
+
+/**
+ * @brief   Hàm dừng quét và đưa Servo về phía trước
+ * @param   void
+ * @return  void
+ **/
+void Scan_Stop(void)
+{
+    if (scanState == SCAN_IDLE || parking)
+        return;
+    parking = 1;
+    Scan_MoveTo(SCAN_ANGLE_FRONT);
+}
+
+
+/**
+ * @brief   Hàm kiểm tra dịch vụ quét đang chạy
+ * @param   void
+ * @return  uint8_t     1 nếu Servo chưa về vị trí nghỉ hoặc chưa có mẫu mới ở vị trí nghỉ
+ **/
+uint8_t Scan_Busy(void)
+{
+    return scanState != SCAN_IDLE;
+}
+
+
+/**
+ * @brief   Hàm xử lý dịch vụ quét, gọi thường xuyên trong vòng lặp chính (sau HCSR05_update và Servo_Service)
+ * @param   void
+ * @return  void
+ **/
+void Scan_Service(void)
+{
+    uint32_t nowMs = HAL_GetTick();
+    Scan_Point parked;
+    Scan_Point *point;
+
+    switch (scanState) {
+    case SCAN_SAMPLING:
+        if (!sampleReady && nowMs - stepStartMs < SCAN_SAMPLE_TIMEOUT_MS)
+            return;
+        point = parking ? &parked : &working.points[stepIndex];
+        point->angle      = parking ? SCAN_ANGLE_FRONT : scanAngles[stepIndex];
+        point->valid      = sampleReady && stepSample.valid;
+        point->distanceMm = point->valid ? stepSample.rawMm : HCSR05_MAX_RANGE_MM;
+        point->timeMs     = nowMs;
+        if (stepCallback != NULL)                               //**< Báo ngay, không chờ hết lượt >**/
+            stepCallback(point, sampleReady ? &stepSample : NULL);
+        if (parking) {                                          //**< Đã có mẫu phía trước mới >**/
+            parking   = 0;
+            scanState = SCAN_IDLE;
+            return;
+        }
+        Scan_NextStep(nowMs);
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief   Hàm đọc kết quả lượt quét hoàn chỉnh gần nhất
+ * @param   polar   Nơi lưu kết quả
+ * @return  uint8_t     1 nếu đã có ít nhất 1 lượt quét, 0 nếu chưa
+ **/
+uint8_t Scan_Read(Scan_Polar *polar)
+{
+    *polar = result;
+    return polar->sequence != 0;
+}
+
+
+/**
+ * @brief   Hàm tra khoảng cách tại 1 góc của kết quả quét
+ * @param   polar   Kết quả quét
+ * @param   angle   Góc cần tra (độ)
+ * @return  uint16_t    Khoảng cách (mm), HCSR05_MAX_RANGE_MM nếu góc không có trong lượt quét
+ **/
+uint16_t Scan_DistanceAt(const Scan_Polar *polar, uint8_t angle)
+{
+    for (uint8_t i = 0; i < polar->count; i++) {
+        if (polar->points[i].angle == angle)
+            return polar->points[i].distanceMm;
+    }
+    return HCSR05_MAX_RANGE_MM;
+}
@@ -0,0 +1,117 @@
+/*********************************************************************************************************************
+ * @file    timebase.c
+ * @brief   Thư viện nguồn thời gian micro giây dùng chung
+ * @details Triển khai bộ đếm thời gian micro giây tự do (free-running) và bộ đếm chu kỳ CPU (DWT).
+ *          Khi biên dịch cho máy tính (định nghĩa HOST_SIM), thời gian là đồng hồ ảo.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "timebase.h"                   //**< Thư viện nguồn thời gian dùng chung >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#ifdef HOST_SIM
+#define TIMEBASE_SIM_CORE_MHZ   168U                //**< Tần số lõi giả lập khi chạy trên máy tính >**/
+#endif
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+#ifdef HOST_SIM
+static volatile uint32_t simMicros = 0;             //**< Đồng hồ ảo (us) >**/
+#endif
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm khởi tạo nguồn thời gian
+ * @details Hàm này sẽ khởi động Timer 32 bit chạy tự do (prescaler cấu hình cho 1 tick = 1 us)
+ *          và bật bộ đếm chu kỳ DWT->CYCCNT của lõi Cortex-M4.
+ * @param   void
+ * @return  void
+ **/
+void Timebase_Init(void)
+{
+#ifndef HOST_SIM
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     //**< Bật khối trace để dùng DWT   >**/
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                //**< Bật bộ đếm chu kỳ            >**/
+
+    HAL_TIM_Base_Start(&TIMEBASE_TIM_HANDLE);
+#else
+    simMicros = 0;
+#endif
+}
+
+
+/**
+ * @brief   Hàm đọc thời gian hiện tại tính bằng micro giây
+ * @param   void
+ * @return  uint32_t    Thời gian hiện tại (us)
+ **/
+uint32_t Timebase_Micros(void)
+{
+#ifndef HOST_SIM
+    return __HAL_TIM_GET_COUNTER(&TIMEBASE_TIM_HANDLE);
+#else
+    return simMicros;
+#endif
+}
+
+
+/**
+ * @brief   Hàm đọc bộ đếm chu kỳ CPU
+ * @param   void
+ * @return  uint32_t    Số chu kỳ CPU hiện tại
+ **/
+uint32_t Timebase_Cycles(void)
+{
+#ifndef HOST_SIM
+    return DWT->CYCCNT;
+#else
+    return simMicros * TIMEBASE_SIM_CORE_MHZ;
+#endif
+}
+
+
+/**
+ * @brief   Hàm quy đổi số chu kỳ CPU sang micro giây
+ * @param   cycles  Số chu kỳ CPU
+ * @return  uint32_t    Thời gian tương ứng (us)
+ **/
+uint32_t Timebase_CyclesToMicros(uint32_t cycles)
+{
+#ifndef HOST_SIM
+    return cycles / (SystemCoreClock / 1000000U);
+#else
+    return cycles / TIMEBASE_SIM_CORE_MHZ;
+#endif
+}
+
+
+/**
+ * @brief   Hàm tạo độ trễ ngắn tính bằng micro giây
+ * @details Trên máy tính, hàm này tăng đồng hồ ảo để thời gian chặn vẫn đo được.
+ * @param   us    Thời gian trễ cần tạo (us)
+ * @return  void
+ **/
+void Timebase_DelayUs(uint32_t us)
+{
+#ifndef HOST_SIM
+    uint32_t start = Timebase_Micros();
+    while (TIMEBASE_ELAPSED(Timebase_Micros(), start) < us);
+#else
+    simMicros += us;
+#endif
+}
+
+
+#ifdef HOST_SIM
+/**
+ * @brief   Hàm tăng đồng hồ ảo khi chạy mô phỏng trên máy tính
+ * @param   us    Thời gian cần tăng thêm (us)
+ * @return  void
+ **/
+void Timebase_SimAdvance(uint32_t us)
+{
+    simMicros += us;
+}
+#endif
@@ -0,0 +1,335 @@
+/*********************************************************************************************************************
+ * @file    vfh_avoid.c
+ * @brief   Thư viện tránh vật cản phản xạ bằng biểu đồ cực (Vector Field Histogram)
+ * @details Triển khai dựng biểu đồ cực từ bản đồ chiếm chỗ, tìm thung lũng và tính lệnh chuyển động Mecanum.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "vfh_avoid.h"                  //**< Thư viện tránh vật cản VFH >**/
+#include <string.h>                     //**< Thư viện sử dụng hàm memset >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+static uint32_t rawHistogram[VFH_SECTORS];                  //**< Biểu đồ chưa làm mượt         >**/
+static uint16_t histogram[VFH_SECTORS];                     //**< Biểu đồ đã làm mượt           >**/
+static int16_t  buildHeadingDeg = 0;                        //**< Hướng xe khi dựng biểu đồ     >**/
+static int16_t  targetDeg = 0;                              //**< Hướng mục tiêu so với đầu xe  >**/
+static uint16_t safeDistanceMm = 200;                       //**< Khoảng cách an toàn (mm)      >**/
+static uint32_t lastControlMs = 0;                          //**< Thời điểm điều khiển trước    >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm nội bộ tính căn bậc hai số nguyên
+ * @param   value   Giá trị
+ * @return  uint32_t    Phần nguyên của căn bậc hai
+ **/
+static uint32_t Vfh_Sqrt(uint32_t value)
+{
+    uint32_t root = 0, bit = 1UL << 30;
+
+    while (bit > value)
+        bit >>= 2;
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root   = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+
+/**
+ * @brief   Hàm nội bộ tính atan2 theo độ bằng số nguyên
+ * @details atan(r) ~ 45 r + 15.64 r (1 - r) độ với r = min / max trong [0, 1], sai số < 0.3 độ.
+ * @param   y       Thành phần y
+ * @param   x       Thành phần x
+ * @return  int16_t Góc (-180 - 180 độ)
+ **/
+static int16_t Vfh_Atan2(int32_t y, int32_t x)
+{
+    int32_t ax = (x < 0) ? -x : x;
+    int32_t ay = (y < 0) ? -y : y;
+    int32_t r, angle;
+
+    if (ax == 0 && ay == 0)
+        return 0;
+    r = (ax >= ay) ? (ay << 10) / ax : (ax << 10) / ay;             //**< Q10 >**/
+    angle = (45 * r + ((r * (1024 - r)) >> 10) * 1564 / 100 + 512) >> 10;
+    if (ay > ax)
+        angle = 90 - angle;
+    if (x < 0)
+        angle = 180 - angle;
+    return (int16_t)((y < 0) ? -angle : angle);
+}
+
+
+/**
+ * @brief   Hàm nội bộ đổi góc sang chỉ số hướng của biểu đồ
+ * @param   deg     Góc (độ, bất kỳ)
+ * @return  uint8_t Chỉ số hướng (0 - VFH_SECTORS - 1)
+ **/
+static uint8_t Vfh_Sector(int16_t deg)
+{
+    deg %= 360;
+    if (deg < 0)
+        deg += 360;
+    return (uint8_t)(((deg + VFH_SECTOR_DEG / 2) / VFH_SECTOR_DEG) % VFH_SECTORS);
+}
+
+
+/**
+ * @brief   Hàm nội bộ tính độ lệch có dấu giữa 2 hướng (a - b)
+ * @param   a       Chỉ số hướng
+ * @param   b       Chỉ số hướng
+ * @return  int8_t  Độ lệch (-VFH_SECTORS / 2 - VFH_SECTORS / 2)
+ **/
+static int8_t Vfh_SectorDiff(int16_t a, int16_t b)
+{
+    int16_t diff = (a - b) % VFH_SECTORS;
+
+    if (diff > VFH_SECTORS / 2)
+        diff -= VFH_SECTORS;
+    else if (diff < -VFH_SECTORS / 2)
+        diff += VFH_SECTORS;
+    return (int8_t)diff;
+}
+
+
+/**
+ * @brief   Hàm nội bộ cộng 1 ô có vật cản vào biểu đồ (callback của Grid_ForEachOccupied)
+ * @details Trọng số = log-odds x (R - d) / R; ô được nới rộng +-asin((bán kính xe + an toàn) / d),
+ *          ô nằm trong bán kính đó chặn nửa mặt phẳng về phía ô.
+ * @param   dxMm        Độ lệch x từ xe đến tâm ô (mm)
+ * @param   dyMm        Độ lệch y từ xe đến tâm ô (mm)
+ * @param   logOdds     Log-odds của ô
+ * @return  void
+ **/
+static void Vfh_AddCell(int32_t dxMm, int32_t dyMm, int8_t logOdds)
+{
+    uint32_t distance = Vfh_Sqrt((uint32_t)(dxMm * dxMm + dyMm * dyMm));
+    uint32_t radius = VFH_ROBOT_RADIUS_MM + safeDistanceMm;
+    uint32_t magnitude, spreadDeg;
+    uint8_t  center;
+    int8_t   spread;
+
+    if (distance >= VFH_WINDOW_MM)
+        return;
+    magnitude = (uint32_t)logOdds * (VFH_WINDOW_MM - distance) / VFH_WINDOW_MM;
+    center    = Vfh_Sector(Vfh_Atan2(dyMm, dxMm) - buildHeadingDeg);
+
+    spreadDeg = (distance <= radius) ? 90 : radius * 573 / (distance * 10);    //**< asin(x) ~ x rad >**/
+    if (spreadDeg > 90)
+        spreadDeg = 90;
+    spread = (int8_t)(spreadDeg / VFH_SECTOR_DEG);
+
+    for (int8_t k = -spread; k <= spread; k++) {
+        rawHistogram[(center + k + VFH_SECTORS) % VFH_SECTORS] += magnitude;
+    }
+}
+
+
+/**
+ * @brief   Hàm nội bộ dựng biểu đồ cực đã làm mượt từ bản đồ
+ * @param   void
+ * @return  void
+ **/
+static void Vfh_Build(void)
+{
+    Grid_Pose pose;
+
+    Grid_GetPose(&pose);
+    buildHeadingDeg = pose.headingDeg;
+    memset(rawHistogram, 0, sizeof(rawHistogram));
+    Grid_ForEachOccupied(VFH_WINDOW_MM, Vfh_AddCell);
+
+    for (int16_t k = 0; k < VFH_SECTORS; k++) {                 //**< Làm mượt có trọng số tam giác >**/
+        uint32_t sum = 0;
+
+        for (int8_t i = -VFH_SMOOTH; i <= VFH_SMOOTH; i++) {
+            uint8_t weight = VFH_SMOOTH + 1 - ((i < 0) ? -i : i);
+            sum += weight * rawHistogram[(k + i + VFH_SECTORS) % VFH_SECTORS];
+        }
+        sum /= 2 * VFH_SMOOTH + 1;
+        histogram[k] = (sum > 0xFFFF) ? 0xFFFF : (uint16_t)sum;
+    }
+}
+
+
+/**
+ * @brief   Hàm nội bộ chọn hướng đi trong các thung lũng
+ * @param   headingDeg  Nơi lưu hướng đi (độ, trái dương)
+ * @return  uint8_t     1 nếu tìm được hướng, 0 nếu mọi hướng đều bị chặn
+ **/
+static uint8_t Vfh_SelectHeading(int16_t *headingDeg)
+{
+    uint8_t target = Vfh_Sector(targetDeg);
+    int16_t blockedStart = -1;
+    int16_t bestSector = -1;
+    int16_t bestCost = VFH_SECTORS;
+    int16_t runStart = -1;
+
+    for (int16_t k = 0; k < VFH_SECTORS; k++) {
+        if (histogram[k] > VFH_THRESHOLD) {
+            blockedStart = k;
+            break;
+        }
+    }
+    if (blockedStart < 0) {                                     //**< Không có vật cản >**/
+        *headingDeg = targetDeg;
+        return 1;
+    }
+
+    // duyet vong tu huong bi chan, moi doan huong trong lien tiep la 1 thung lung
+    for (int16_t n = 1; n <= VFH_SECTORS; n++) {
+        int16_t k = (blockedStart + n) % VFH_SECTORS;
+        uint8_t isFree = histogram[k] <= VFH_THRESHOLD;
+        int16_t length, end, sector, cost;
+
+        if (isFree) {
+            if (runStart < 0)
+                runStart = n;
+            continue;
+        }
+        if (runStart < 0)
+            continue;
+
+        length   = n - runStart;                                //**< Thung lũng [runStart, n - 1] >**/
+        end      = (blockedStart + n - 1) % VFH_SECTORS;
+        runStart = (blockedStart + runStart) % VFH_SECTORS;
+
+        if ((target - runStart + VFH_SECTORS) % VFH_SECTORS < length) {
+            // muc tieu nam trong thung lung: di thang toi muc tieu neu thung lung rong
+            sector = (length >= VFH_WIDE_SECTORS) ? target : (runStart + (length - 1) / 2) % VFH_SECTORS;
+            cost   = 0;
+            if (length >= VFH_WIDE_SECTORS) {
+                *headingDeg = targetDeg;
+                return 1;
+            }
+        } else {
+            int8_t toStart = Vfh_SectorDiff(runStart, target);
+            int8_t toEnd   = Vfh_SectorDiff(end, target);
+            uint8_t nearStart = ((toStart < 0) ? -toStart : toStart) <= ((toEnd < 0) ? -toEnd : toEnd);
+
+            if (length >= VFH_WIDE_SECTORS)                     //**< Bám theo mép gần mục tiêu >**/
+                sector = nearStart ? runStart + VFH_WIDE_SECTORS / 2 : end - VFH_WIDE_SECTORS / 2;
+            else
+                sector = runStart + (length - 1) / 2;
+            sector = (sector + VFH_SECTORS) % VFH_SECTORS;
+            cost   = Vfh_SectorDiff(sector, target);
+            if (cost < 0)
+                cost = -cost;
+        }
+        if (cost < bestCost) {
+            bestCost   = cost;
+            bestSector = sector;
+        }
+        runStart = -1;
+    }
+
+    if (bestSector < 0)
+        return 0;
+    *headingDeg = Vfh_SectorDiff(bestSector, 0) * VFH_SECTOR_DEG;
+    return 1;
+}
+
+
+/**
+ * @brief   Hàm khởi tạo bộ tránh vật cản
+ * @param   void
+ * @return  void
+ **/
+void Vfh_Init(void)
+{
+    memset(histogram, 0, sizeof(histogram));
+    targetDeg = 0;
+    lastControlMs = 0;
+}
+
+
+/**
+ * @brief   Hàm đặt hướng mục tiêu
+ * @param   bearingDeg  Hướng mục tiêu so với đầu xe (độ, trái dương), mặc định 0
+ * @return  void
+ **/
+void Vfh_SetTarget(int16_t bearingDeg)
+{
+    targetDeg = bearingDeg;
+}
+
+
+/**
+ * @brief   Hàm đặt khoảng cách an toàn (cộng vào bán kính xe khi nới rộng vật cản)
+ * @param   distanceMm  Khoảng cách an toàn (mm)
+ * @return  void
+ **/
+void Vfh_SetSafeDistance(uint16_t distanceMm)
+{
+    safeDistanceMm = distanceMm;
+}
+
+
+/**
+ * @brief   Hàm tính lệnh chuyển động, gọi thường xuyên trong vòng lặp chính
+ * @param   nowMs   Thời điểm hiện tại (ms)
+ * @param   command Nơi lưu lệnh chuyển động
+ * @return  uint8_t     1 nếu đến chu kỳ điều khiển và command đã được cập nhật, 0 nếu chưa
+ **/
+uint8_t Vfh_Update(uint32_t nowMs, Vfh_Command *command)
+{
+    int16_t  heading, absHeading;
+    uint16_t density;
+    int32_t  speed;
+
+    if (nowMs - lastControlMs < VFH_CONTROL_MS)
+        return 0;
+    lastControlMs = nowMs;
+
+    Vfh_Build();
+    if (!Vfh_SelectHeading(&heading)) {                         //**< Bị bao vây: quay tại chỗ tìm lối ra >**/
+        command->vx = command->vy = 0;
+        command->omega      = VFH_TURN_SPEED;
+        command->headingDeg = 0;
+        command->blocked    = 1;
+        return 1;
+    }
+
+    density = histogram[Vfh_Sector(heading)];
+    if (density > VFH_DENSITY_MAX)
+        density = VFH_DENSITY_MAX;
+    speed = (int32_t)VFH_SPEED_MAX * (VFH_DENSITY_MAX - density) / VFH_DENSITY_MAX;
+    if (speed < VFH_SPEED_MIN)
+        speed = VFH_SPEED_MIN;
+
+    absHeading = (heading < 0) ? -heading : heading;
+    command->headingDeg = heading;
+    command->blocked    = 0;
+    if (absHeading > 90) {                                      //**< Lối ra phía sau: quay thân trước >**/
+        command->vx = command->vy = 0;
+        command->omega = (heading > 0) ? VFH_TURN_SPEED : -VFH_TURN_SPEED;
+        return 1;
+    }
+
+    // di ngang theo huong heading (trai duong): phai = -sin, tien = cos
+    command->vx    = (int16_t)(-(speed * Grid_Sin(heading)) >> 14);
+    command->vy    = (int16_t)((speed * Grid_Sin(heading + 90)) >> 14);
+    command->omega = 0;
+    if (absHeading > VFH_STRAFE_MAX_DEG)                        //**< Lệch lớn: vừa đi ngang vừa quay thân >**/
+        command->omega = (heading > 0) ? VFH_TURN_SPEED / 2 : -VFH_TURN_SPEED / 2;
+    return 1;
+}
+
+
+/**
+ * @brief   Hàm đọc biểu đồ cực đã làm mượt của chu kỳ gần nhất
+ * @param   void
+ * @return  const uint16_t*     Mảng VFH_SECTORS phần tử
+ **/
+const uint16_t *Vfh_Histogram(void)
+{
+    return histogram;
+}
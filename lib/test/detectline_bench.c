@@ -0,0 +1,234 @@
+/*********************************************************************************************************************
+ * @file    detectline_bench.c
+ * @brief   Đo thời gian giải mã mẫu cảm biến line trên máy tính (không cần vi điều khiển)
+ * @details So sánh bộ giải mã đang dùng với bộ giải mã cũ trên cả 32 mẫu 5 bit:
+ *          - Cũ: 5 lần HAL_GPIO_ReadPin + switch theo các mẫu LINE_GO_... (detect_Line trước khi dùng bảng),
+ *            chép lại trong file này làm mốc so sánh.
+ *          - Mới: detect_Line / detect_Line_Read của lib/src/detectline.c được biên dịch cùng, đọc port qua
+ *            main.h giả lập (lib/test/stub): mỗi port đọc IDR 1 lần, dịch + mặt nạ + bảng tra, bảng 32 hành động.
+ *          HAL_GPIO_ReadPin giả lập là 1 lần gọi hàm như thư viện HAL.
+ *          Chương trình kiểm tra 2 cách chọn cùng 1 hàm xử lý cho mọi mẫu (cả 2 hướng lệch trước đó),
+ *          kiểm tra mẫu đọc được của mảng sau (đảo chiều), sau đó in thời gian trung bình mỗi lần giải mã đo được.
+ *          Biên dịch và chạy:
+ *          gcc -O2 -std=gnu99 -Ilib/inc -Ilib/test/stub -o detectline_bench lib/test/detectline_bench.c lib/src/detectline.c && ./detectline_bench
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "detectline.h"                 //**< Bộ giải mã line đang dùng >**/
+#include <stdio.h>                      //**< Thư viện sử dụng hàm printf >**/
+#include <time.h>                       //**< Thư viện sử dụng clock_gettime >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define BENCH_ROUNDS            1000000 //**< Số vòng, mỗi vòng giải mã đủ 32 mẫu   >**/
+
+/* Các mẫu và cách đọc chân của bộ giải mã cũ */
+#define LINE_GO_HEAD1           0x19    // 11001
+#define LINE_GO_HEAD2           0x13    // 10011
+#define LINE_GO_HEAD3           0x11    // 10001
+#define LINE_GO_HEAD4           0x00    // 00000
+#define LINE_GO_HEAD5           0x1b    // 11011
+#define LINE_GO_LEFT_SLOW1      0x0f    // 01111
+#define LINE_GO_LEFT_SLOW2      0x07    // 00111
+#define LINE_GO_LEFT_SLOW3      0x03    // 00011
+#define LINE_GO_LEFT_SLOW4      0x01    // 00001
+#define LINE_GO_LEFT_SLOW5      0x17    // 10111
+#define LINE_GO_RIGHT_SLOW1     0x1c    // 11110
+#define LINE_GO_RIGHT_SLOW2     0x1e    // 11100
+#define LINE_GO_RIGHT_SLOW3     0x18    // 11000
+#define LINE_GO_RIGHT_SLOW4     0x10    // 10000
+#define LINE_GO_RIGHT_SLOW5     0x1d    // 11101
+#define LINE_GO_TURN            0x1f    // 11111
+
+#define READ_LINE1  HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_12)
+#define READ_LINE2  HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_14)
+#define READ_LINE3  HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_13)
+#define READ_LINE4  HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_15)
+#define READ_LINE5  HAL_GPIO_ReadPin(GPIOC, GPIO_PIN_7)
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+GPIO_TypeDef hostGpioB, hostGpioC, hostGpioE;               //**< Port giả lập (main.h giả lập) >**/
+
+extern State_Line stateLine;                                //**< Hướng lệch trước đó của detect_Line >**/
+static State_Line oldStateLine;                             //**< Hướng lệch trước đó của bộ giải mã cũ >**/
+static volatile uint8_t lastAction;                         //**< Hàm xử lý được gọi gần nhất   >**/
+
+static const GPIO_TypeDef *const frontPort[LINE_ARRAY_SENSORS] = LINE_FRONT_PORTS;
+static const uint16_t frontPin[LINE_ARRAY_SENSORS] = LINE_FRONT_PINS;
+static const uint16_t rearPin[LINE_ARRAY_SENSORS]  = LINE_REAR_PINS;
+
+static void onHead(void)      { lastAction = LINE_ACTION_HEAD; }
+static void onLeft(void)      { lastAction = LINE_ACTION_LEFT; }
+static void onRight(void)     { lastAction = LINE_ACTION_RIGHT; }
+static void onTurnLeft(void)  { lastAction = LINE_ACTION_TURN_LEFT; }
+static void onTurnRight(void) { lastAction = LINE_ACTION_TURN_RIGHT; }
+
+static void (*handleLine[5])(void) = { onHead, onLeft, onRight, onTurnLeft, onTurnRight };
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm giả lập HAL_GPIO_ReadPin (1 lần gọi hàm cho mỗi chân như thư viện HAL)
+ * @param   port    Port GPIO
+ * @param   pin     Chân GPIO
+ * @return  GPIO_PinState   GPIO_PIN_SET nếu chân ở mức cao
+ **/
+__attribute__((noinline)) GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin)
+{
+    return (port->IDR & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+
+/**
+ * @brief   Bộ giải mã cũ: 5 lần đọc chân + switch
+ **/
+__attribute__((noinline)) static void oldDetectLine(void (*handle[])(void))
+{
+    uint8_t detectLine = ((READ_LINE5 ? 1 : 0) | (READ_LINE4 ? 2 : 0) | (READ_LINE3 ? 4 : 0) | (READ_LINE2 ? 8 : 0) | (READ_LINE1 ? 16 : 0));
+
+    switch (detectLine) {
+    case LINE_GO_HEAD1:
+    case LINE_GO_HEAD2:
+    case LINE_GO_HEAD3:
+    case LINE_GO_HEAD4:
+    case LINE_GO_HEAD5:
+        handle[0]();
+        break;
+    case LINE_GO_LEFT_SLOW1:
+    case LINE_GO_LEFT_SLOW2:
+    case LINE_GO_LEFT_SLOW3:
+    case LINE_GO_LEFT_SLOW4:
+    case LINE_GO_LEFT_SLOW5:
+        handle[1]();
+        oldStateLine = STATE_LEFT;
+        break;
+    case LINE_GO_RIGHT_SLOW1:
+    case LINE_GO_RIGHT_SLOW2:
+    case LINE_GO_RIGHT_SLOW3:
+    case LINE_GO_RIGHT_SLOW4:
+    case LINE_GO_RIGHT_SLOW5:
+        handle[2]();
+        oldStateLine = STATE_RIGHT;
+        break;
+    case LINE_GO_TURN:
+    default:
+        if (oldStateLine == STATE_LEFT)
+            handle[3]();
+        else
+            handle[4]();
+        break;
+    }
+}
+
+
+/**
+ * @brief   Bộ đọc cũ: chỉ 5 lần đọc chân
+ **/
+__attribute__((noinline)) static uint8_t oldReadLine(void)
+{
+    return (READ_LINE5 ? 1 : 0) | (READ_LINE4 ? 2 : 0) | (READ_LINE3 ? 4 : 0) | (READ_LINE2 ? 8 : 0) | (READ_LINE1 ? 16 : 0);
+}
+
+
+/**
+ * @brief   Hàm đặt các port giả lập theo mẫu 5 bit (LINE1 = bit 4 với mảng trước, bit 0 với mảng sau)
+ * @details Các chân khác của port được đặt ở mức cao để kiểm tra mặt nạ.
+ * @param   pattern     Mẫu cần đặt
+ * @return  void
+ **/
+static void setPattern(uint8_t pattern)
+{
+    uint32_t b = 0x0F00, c = 0x0140, e = 0xF07F;
+
+    for (uint8_t i = 0; i < LINE_ARRAY_SENSORS; i++) {
+        if (pattern & (1U << (LINE_ARRAY_SENSORS - 1 - i))) {
+            if (frontPort[i] == GPIOB)
+                b |= frontPin[i];
+            else
+                c |= frontPin[i];
+        }
+        if (pattern & (1U << i))                                //**< Mảng sau lắp đảo chiều >**/
+            e |= rearPin[i];
+    }
+    hostGpioB.IDR = b;
+    hostGpioC.IDR = c;
+    hostGpioE.IDR = e;
+}
+
+
+/**
+ * @brief   Hàm đo thời gian trung bình 1 lần gọi
+ * @param   decode  Bộ giải mã (NULL: chỉ đọc mẫu)
+ * @param   read    Bộ đọc mẫu khi decode là NULL
+ * @return  double  Thời gian (ns)
+ **/
+static double benchRun(void (*decode)(void (*handle[])(void)), uint8_t (*read)(void))
+{
+    static uint32_t portB[32], portC[32];
+    struct timespec start, end;
+    volatile uint8_t sink = 0;
+
+    for (uint8_t p = 0; p < 32; p++) {
+        setPattern(p);
+        portB[p] = hostGpioB.IDR;
+        portC[p] = hostGpioC.IDR;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+        for (uint8_t p = 0; p < 32; p++) {
+            hostGpioB.IDR = portB[p];
+            hostGpioC.IDR = portC[p];
+            if (decode != NULL)
+                decode(handleLine);
+            else
+                sink = read();
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    (void)sink;
+    return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / (BENCH_ROUNDS * 32.0);
+}
+
+
+int main(void)
+{
+    int mismatches = 0;
+
+    detect_Line_Init();
+
+    for (uint8_t prior = 0; prior < 2; prior++) {               //**< Quay đầu phụ thuộc hướng lệch trước đó >**/
+        for (uint8_t p = 0; p < 32; p++) {
+            uint8_t expected;
+
+            setPattern(p);
+            oldStateLine = prior ? STATE_LEFT : STATE_RIGHT;
+            oldDetectLine(handleLine);
+            expected = lastAction;
+            stateLine = prior ? STATE_LEFT : STATE_RIGHT;
+            detect_Line(handleLine);
+            if (lastAction != expected) {
+                printf("mismatch: pattern %02X after %s: switch %u, table %u\n",
+                       p, prior ? "left" : "right", expected, lastAction);
+                mismatches++;
+            }
+        }
+    }
+
+    detect_Line_Select(LINE_ARRAY_REAR);
+    for (uint8_t p = 0; p < 32; p++) {
+        setPattern(p);
+        if (detect_Line_Read() != p) {
+            printf("mismatch: rear pattern %02X read as %02X\n", p, detect_Line_Read());
+            mismatches++;
+        }
+    }
+    detect_Line_Select(LINE_ARRAY_FRONT);
+
+    printf("patterns: 32, rounds: %u\n", BENCH_ROUNDS);
+    printf("5 x ReadPin          : %6.2f ns / read\n",   benchRun(NULL, oldReadLine));
+    printf("detect_Line_Read     : %6.2f ns / read\n",   benchRun(NULL, detect_Line_Read));
+    printf("5 x ReadPin + switch : %6.2f ns / decode\n", benchRun(oldDetectLine, NULL));
+    printf("detect_Line          : %6.2f ns / decode\n", benchRun(detect_Line, NULL));
+    printf("mismatches           : %d\n", mismatches);
+    return mismatches ? 1 : 0;
+}
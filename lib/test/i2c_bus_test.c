@@ -0,0 +1,206 @@
+/*********************************************************************************************************************
+ * @file    i2c_bus_test.c
+ * @brief   Kiểm tra thời gian chặn của bus I2C trên máy tính với HAL I2C giả lập
+ * @details Các hàm HAL I2C / GPIO được thay bằng bản giả lập theo kịch bản: mỗi lần truyền bận trong một số us
+ *          (hoặc treo mãi), kết thúc với mã lỗi định trước (NACK, mất quyền điều khiển bus, ...) và SDA có thể bị giữ.
+ *          Đồng hồ ảo chạy 1 us mỗi vòng chờ bận của I2C_Bus_Transmit và theo Timebase_DelayUs khi giải phóng bus.
+ *          Mỗi trường hợp kiểm tra kết quả, bộ đếm và thời gian chặn không vượt quá deadline
+ *          cộng thời gian giải phóng bus lớn nhất.
+ *          Biên dịch và chạy:
+ *          gcc -std=gnu99 -Wall -DHOST_SIM -Ilib/inc -Ilib/test/stub -o i2c_bus_test lib/test/i2c_bus_test.c lib/src/i2c_bus.c lib/src/timebase.c && ./i2c_bus_test
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "i2c_bus.h"                    //**< Thư viện truy cập bus I2C >**/
+#include <stdio.h>                      //**< Thư viện sử dụng hàm printf >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define SIM_HANG                0xFFFFFFFFU     //**< Giao dịch không bao giờ kết thúc          >**/
+#define SIM_DEADLINE_US         1000            //**< Deadline của mỗi giao dịch (us)           >**/
+#define SIM_ADDRESS             0x4E            //**< Địa chỉ thiết bị giả lập                  >**/
+
+/* Thời gian giải phóng bus lớn nhất: 9 xung SCL + điều kiện STOP */
+#define SIM_RECOVER_MAX_US      ((2 * I2C_BUS_RECOVERY_CLOCKS + 2) * I2C_BUS_HALF_PERIOD_US)
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   1 trường hợp kiểm tra
+ **/
+typedef struct {
+    const char        *title;           //**< Tên trường hợp                            >**/
+    uint32_t           busyUs;          //**< Thời gian bận của mỗi lần truyền (us)     >**/
+    uint32_t           errors[I2C_BUS_RETRIES + 1];   //**< Mã lỗi của từng lần truyền  >**/
+    HAL_StatusTypeDef  start;           //**< Kết quả HAL_I2C_Master_Transmit_IT        >**/
+    uint8_t            sdaStuck;        //**< Slave giữ SDA, giải phóng bus thất bại    >**/
+    I2C_Bus_Status     status;          //**< Kết quả mong đợi                          >**/
+    uint32_t           retries;         //**< Số lần thử lại mong đợi                   >**/
+    uint32_t           nacks;           //**< Số lần NACK mong đợi                      >**/
+    uint32_t           recoveries;      //**< Số lần giải phóng bus mong đợi            >**/
+} Sim_Case;
+
+/**
+ * @brief   Trạng thái của HAL giả lập
+ **/
+typedef struct {
+    const Sim_Case *script;             //**< Kịch bản đang chạy                        >**/
+    uint8_t         attempt;            //**< Số lần đã gọi Transmit_IT                 >**/
+    uint8_t         active;             //**< Đang truyền                               >**/
+    uint32_t        busyLeft;           //**< Số us bận còn lại                         >**/
+} Sim_Hal;
+
+static const Sim_Case cases[] = {
+    { "ok",                     200,      { HAL_I2C_ERROR_NONE },                                   HAL_OK,   0, I2C_BUS_OK,      0, 0, 0 },
+    { "nack then ok",           100,      { HAL_I2C_ERROR_AF, HAL_I2C_ERROR_NONE },                 HAL_OK,   0, I2C_BUS_OK,      1, 1, 0 },
+    { "nack every retry",       100,      { HAL_I2C_ERROR_AF, HAL_I2C_ERROR_AF, HAL_I2C_ERROR_AF }, HAL_OK,   0, I2C_BUS_NACK,    2, 3, 0 },
+    { "nack retries to deadline", 400,    { HAL_I2C_ERROR_AF, HAL_I2C_ERROR_AF, HAL_I2C_ERROR_AF }, HAL_OK,   0, I2C_BUS_TIMEOUT, 2, 2, 1 },
+    { "hang",                   SIM_HANG, { HAL_I2C_ERROR_NONE },                                   HAL_OK,   0, I2C_BUS_TIMEOUT, 0, 0, 1 },
+    { "arbitration lost",       50,       { HAL_I2C_ERROR_ARLO },                                   HAL_OK,   0, I2C_BUS_ERROR,   0, 0, 1 },
+    { "start refused",          0,        { HAL_I2C_ERROR_NONE },                                   HAL_BUSY, 0, I2C_BUS_ERROR,   0, 0, 1 },
+    { "hang, SDA held",         SIM_HANG, { HAL_I2C_ERROR_NONE },                                   HAL_OK,   1, I2C_BUS_TIMEOUT, 0, 0, 1 },
+};
+
+static Sim_Hal sim;                     //**< HAL giả lập >**/
+static I2C_TypeDef simI2c;              //**< Thanh ghi I2C giả lập >**/
+
+I2C_HandleTypeDef hi2c1 = { &simI2c, NULL, NULL };
+GPIO_TypeDef hostGpioB, hostGpioC, hostGpioE;
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/* HAL giả lập */
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init) { (void)port; (void)init; }
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state) { (void)port; (void)pin; (void)state; }
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin)
+{
+    if (port == I2C_BUS_SDA_PORT && pin == I2C_BUS_SDA_PIN && sim.script && sim.script->sdaStuck)
+        return GPIO_PIN_RESET;
+    return GPIO_PIN_SET;
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)   { (void)hi2c; return HAL_OK; }
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c) { (void)hi2c; sim.active = 0; return HAL_OK; }
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t address, uint8_t *data, uint16_t size)
+{
+    (void)hi2c; (void)address; (void)data; (void)size;
+    if (sim.script->start != HAL_OK)
+        return sim.script->start;
+    sim.attempt++;
+    sim.active   = 1;
+    sim.busyLeft = sim.script->busyUs;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef *hi2c, uint16_t address)
+{
+    (void)hi2c; (void)address;
+    sim.active = 0;
+    return HAL_OK;
+}
+
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+    if (!sim.active)
+        return HAL_I2C_STATE_READY;
+    if (sim.script->busyUs == SIM_HANG)
+        return HAL_I2C_STATE_BUSY_TX;
+    if (sim.busyLeft > 0) {
+        sim.busyLeft--;                 //**< I2C_Bus_Transmit tăng đồng hồ ảo 1 us mỗi vòng chờ >**/
+        return HAL_I2C_STATE_BUSY_TX;
+    }
+    sim.active = 0;
+    return HAL_I2C_STATE_READY;
+}
+
+uint32_t HAL_I2C_GetError(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+    return sim.attempt ? sim.script->errors[sim.attempt - 1] : HAL_I2C_ERROR_NONE;
+}
+
+
+/**
+ * @brief   Hàm so sánh một bộ đếm với giá trị mong đợi
+ * @return  int     1 nếu khác, 0 nếu giống
+ **/
+static int simExpect(const char *name, uint32_t value, uint32_t expected)
+{
+    if (value == expected)
+        return 0;
+    printf("    %s %lu, expected %lu\n", name, (unsigned long)value, (unsigned long)expected);
+    return 1;
+}
+
+
+/**
+ * @brief   Hàm chạy 1 giao dịch theo kịch bản
+ * @return  I2C_Bus_Status  Kết quả truyền
+ **/
+static I2C_Bus_Status simTransmit(const Sim_Case *script)
+{
+    static uint8_t payload[4] = { 0x01, 0x02, 0x03, 0x04 };
+
+    sim.script  = script;
+    sim.attempt = 0;
+    sim.active  = 0;
+    return I2C_Bus_Transmit(SIM_ADDRESS, payload, sizeof(payload), SIM_DEADLINE_US);
+}
+
+
+int main(void)
+{
+    int failed = 0;
+    const I2C_Bus_Stats *stats = I2C_Bus_GetStats();
+    uint32_t maxBlockUs = 0;
+
+    Timebase_Init();
+    for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const Sim_Case *testCase = &cases[i];
+        uint32_t limitUs = SIM_DEADLINE_US + (testCase->recoveries ? SIM_RECOVER_MAX_US : 0);
+        I2C_Bus_Status status;
+        int failures = 0;
+
+        I2C_Bus_ResetStats();
+        status = simTransmit(testCase);
+
+        failures += simExpect("status", status, testCase->status);
+        failures += simExpect("retries", stats->retries, testCase->retries);
+        failures += simExpect("nacks", stats->nacks, testCase->nacks);
+        failures += simExpect("recoveries", stats->recoveries, testCase->recoveries);
+        if (stats->maxBlockUs > limitUs) {
+            printf("    blocked %lu us, limit %lu us\n", (unsigned long)stats->maxBlockUs, (unsigned long)limitUs);
+            failures++;
+        }
+        if (stats->maxBlockUs > maxBlockUs)
+            maxBlockUs = stats->maxBlockUs;
+
+        printf("%s  %-26s blocked %4lu us\n", failures ? "FAIL" : "ok  ", testCase->title,
+               (unsigned long)stats->maxBlockUs);
+        failed += (failures != 0);
+    }
+
+    /* Sau khi giải phóng thất bại: bus tạm ngưng, giao dịch bị bỏ qua mà không chặn, rồi dùng lại được */
+    {
+        static const Sim_Case okCase = { "ok", 200, { HAL_I2C_ERROR_NONE }, HAL_OK, 0, I2C_BUS_OK, 0, 0, 0 };
+        int failures = 0;
+        uint32_t before;
+
+        I2C_Bus_ResetStats();
+        before = Timebase_Micros();
+        failures += simExpect("suspended status", simTransmit(&okCase), I2C_BUS_DROPPED);
+        failures += simExpect("suspended block", TIMEBASE_ELAPSED(Timebase_Micros(), before), 0);
+        failures += simExpect("dropped", stats->dropped, 1);
+        Timebase_SimAdvance(I2C_BUS_BACKOFF_US);
+        failures += simExpect("after backoff", simTransmit(&okCase), I2C_BUS_OK);
+        printf("%s  %-26s\n", failures ? "FAIL" : "ok  ", "backoff after stuck bus");
+        failed += (failures != 0);
+    }
+
+    printf("worst block %lu us (deadline %u us + recovery %u us)\n",
+           (unsigned long)maxBlockUs, SIM_DEADLINE_US, SIM_RECOVER_MAX_US);
+    printf("%d failed\n", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+/*********************************************************************************************************************
+ * @file    latency_probe_test.c
+ * @brief   Kiểm tra histogram độ trễ tay cầm - động cơ trên máy tính với đồng hồ ảo
+ * @details Mỗi mẫu được tạo bằng cách gọi các giai đoạn của đường điều khiển theo thứ tự
+ *          (RESPONSE -> DECODE -> MOTION -> COMMIT) và tăng đồng hồ ảo bằng Timebase_SimAdvance giữa 2 giai đoạn,
+ *          rồi so ô histogram, min / max và khoảng lớn nhất giữa 2 giai đoạn với giá trị đã biết.
+ *          Kiểm tra thêm phân loại theo chế độ, ảnh chụp cũ, tắt đo và mẫu chồng nhau / quá thời gian.
+ *          Biên dịch và chạy:
+ *          gcc -std=gnu99 -Wall -DHOST_SIM -Ilib/inc -o latency_probe_test lib/test/latency_probe_test.c lib/src/latency_probe.c lib/src/timebase.c && ./latency_probe_test
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "latency_probe.h"              //**< Thư viện đo độ trễ >**/
+#include <stdio.h>                      //**< Thư viện sử dụng hàm printf >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define SIM_MODE_CONTROL        0       //**< Mode CONTROL (interrrupt.h) >**/
+#define SIM_MODE_LINE           1       //**< Mode LINE (interrrupt.h)    >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+static uint32_t simFrame = 0;           //**< Số khung của ảnh chụp mô phỏng >**/
+static int      failed = 0;             //**< Số kiểm tra thất bại           >**/
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm so sánh một giá trị với giá trị mong đợi
+ * @return  void
+ **/
+static void simExpect(const char *name, uint32_t value, uint32_t expected)
+{
+    printf("%s  %-40s %lu\n", (value == expected) ? "ok  " : "FAIL", name, (unsigned long)value);
+    if (value != expected) {
+        printf("    expected %lu\n", (unsigned long)expected);
+        failed++;
+    }
+}
+
+
+/**
+ * @brief   Hàm tạo 1 mẫu với thời gian từng giai đoạn đã biết
+ * @param   decodeUs    RESPONSE -> DECODE (us)
+ * @param   motionUs    DECODE -> MOTION (us)
+ * @param   commitUs    MOTION -> COMMIT (us)
+ * @return  void
+ **/
+static void simSample(uint32_t decodeUs, uint32_t motionUs, uint32_t commitUs)
+{
+    simFrame++;
+    Latency_Probe_Start(Timebase_Cycles(), simFrame);
+    Timebase_SimAdvance(decodeUs);
+    Latency_Probe_Stamp(LATENCY_STAGE_DECODE);
+    Timebase_SimAdvance(motionUs);
+    Latency_Probe_Motion(simFrame);
+    Timebase_SimAdvance(commitUs);
+    Latency_Probe_Stamp(LATENCY_STAGE_COMMIT);
+    Timebase_SimAdvance(10000);                                 //**< Khoảng nghỉ giữa 2 thay đổi >**/
+}
+
+
+int main(void)
+{
+    const Latency_ModeStats *control = Latency_Probe_GetStats(SIM_MODE_CONTROL);
+    const Latency_ModeStats *line    = Latency_Probe_GetStats(SIM_MODE_LINE);
+
+    Timebase_Init();
+    Latency_Probe_Reset();
+    Latency_Probe_Enable(1);
+
+    /* Ô histogram theo độ trễ tổng, ô cuối chứa mọi giá trị lớn hơn */
+    Latency_Probe_SetMode(SIM_MODE_CONTROL);
+    simSample(100, 200, 100);                                   //**<   400 us: ô 0  >**/
+    simSample(300, 1000, 200);                                  //**<  1500 us: ô 1  >**/
+    simSample(999, 1000, 1000);                                 //**<  2999 us: ô 2  >**/
+    simSample(1000, 1000, 1000);                                //**<  3000 us: ô 3  >**/
+    simSample(100, 19800, 100);                                 //**< 20000 us: ô 15 >**/
+    simExpect("control count", control->count, 5);
+    simExpect("control bin 0", control->bins[0], 1);
+    simExpect("control bin 1", control->bins[1], 1);
+    simExpect("control bin 2", control->bins[2], 1);
+    simExpect("control bin 3", control->bins[3], 1);
+    simExpect("control bin 4", control->bins[4], 0);
+    simExpect("control overflow bin", control->bins[LATENCY_HIST_BINS - 1], 1);
+    simExpect("control min us", control->minUs, 400);
+    simExpect("control max us", control->maxUs, 20000);
+    simExpect("control sum us", (uint32_t)control->sumUs, 400 + 1500 + 2999 + 3000 + 20000);
+    simExpect("control max response-decode us", control->stageMaxUs[0], 1000);
+    simExpect("control max decode-motion us", control->stageMaxUs[1], 19800);
+    simExpect("control max motion-commit us", control->stageMaxUs[2], 1000);
+
+    /* Mẫu được đưa vào histogram của chế độ hiện tại */
+    Latency_Probe_SetMode(SIM_MODE_LINE);
+    simSample(200, 5000, 0);                                    //**<  5200 us: ô 5  >**/
+    simExpect("line bin 5", line->bins[5], 1);
+    simExpect("control count after line sample", control->count, 5);
+
+    /* Ảnh chụp cũ hơn khung của mẫu không ghi MOTION, COMMIT bị bỏ qua */
+    Latency_Probe_SetMode(SIM_MODE_CONTROL);
+    simFrame++;
+    Latency_Probe_Start(Timebase_Cycles(), simFrame);
+    Latency_Probe_Stamp(LATENCY_STAGE_DECODE);
+    Timebase_SimAdvance(500);
+    Latency_Probe_Motion(simFrame - 1);
+    Latency_Probe_Stamp(LATENCY_STAGE_COMMIT);
+    simExpect("stale snapshot not recorded", control->count, 5);
+    Timebase_SimAdvance(1500);
+    Latency_Probe_Motion(simFrame);
+    Latency_Probe_Stamp(LATENCY_STAGE_COMMIT);
+    simExpect("current snapshot recorded in bin 2", control->bins[2], 2);
+    Timebase_SimAdvance(10000);
+
+    /* Tắt đo: không bắt đầu mẫu */
+    Latency_Probe_Enable(0);
+    simSample(100, 100, 100);
+    simExpect("disabled probe records nothing", control->count, 6);
+    Latency_Probe_Enable(1);
+
+    /* Mẫu chồng nhau bị bỏ qua, mẫu không kết thúc bị hủy sau LATENCY_SAMPLE_TIMEOUT_US */
+    simFrame++;
+    Latency_Probe_Start(Timebase_Cycles(), simFrame);
+    Timebase_SimAdvance(100);
+    Latency_Probe_Start(Timebase_Cycles(), simFrame + 1);
+    simExpect("overlapping sample missed", Latency_Probe_Missed(), 1);
+    Timebase_SimAdvance(LATENCY_SAMPLE_TIMEOUT_US);
+    simSample(100, 100, 100);
+    simExpect("stuck sample dropped after timeout", Latency_Probe_Missed(), 2);
+    simExpect("new sample recorded after timeout", control->count, 7);
+
+    printf("%d failed\n", failed);
+    return failed ? 1 : 0;
+}
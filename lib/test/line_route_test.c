@@ -0,0 +1,256 @@
+/*********************************************************************************************************************
+ * @file    line_route_test.c
+ * @brief   Kiểm tra lõi lộ trình dò line trên máy tính với bản đồ đường mô phỏng
+ * @details Mỗi bản đồ là danh sách giao lộ xe lần lượt gặp: các nhánh có ở giao lộ và thời gian quay
+ *          (tính từ lúc bắt đầu quay) đến khi cảm biến giữa nằm trên nhánh mới, 0 nếu không có nhánh để bắt.
+ *          Bộ mô phỏng gọi Route_OnJunction khi đến giao lộ, gọi Route_Update mỗi chu kỳ điều khiển
+ *          và ghi lại chuỗi trạng thái (cùng ký hiệu với LCD: -FATDE) để so với chuỗi mong đợi,
+ *          gồm cả các trường hợp lỗi (thiếu nhánh, quay quá lâu, ký tự không hợp lệ).
+ *          Biên dịch và chạy:
+ *          gcc -std=gnu99 -Wall -Ilib/inc -o line_route_test lib/test/line_route_test.c lib/src/line_route.c && ./line_route_test
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include "line_route.h"                 //**< Thư viện lộ trình >**/
+#include <stdio.h>                      //**< Thư viện sử dụng hàm printf >**/
+#include <string.h>                     //**< Thư viện sử dụng hàm strcmp >**/
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define SIM_PERIOD_MS           10      //**< Chu kỳ điều khiển mô phỏng (ms)           >**/
+#define SIM_SEGMENT_MS          400     //**< Thời gian dò line giữa 2 giao lộ (ms)     >**/
+#define SIM_LEAVE_MS            100     //**< Cảm biến giữa rời line cũ sau khi quay (ms) >**/
+#define SIM_LIMIT_MS            20000   //**< Thời gian mô phỏng tối đa (ms)            >**/
+#define SIM_TRACE_MAX           64      //**< Độ dài chuỗi trạng thái tối đa            >**/
+
+#define ARMS_ALL    (ROUTE_ARM_LEFT | ROUTE_ARM_STRAIGHT | ROUTE_ARM_RIGHT)
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+/**
+ * @brief   1 giao lộ của bản đồ mô phỏng
+ **/
+typedef struct {
+    uint8_t  arms;                      //**< Các nhánh của giao lộ (ROUTE_ARM_...)     >**/
+    uint16_t catchMs;                   //**< Thời gian quay đến nhánh mới, 0: không có >**/
+} Sim_Junction;
+
+/**
+ * @brief   Kết quả chạy 1 lộ trình
+ **/
+typedef struct {
+    char     trace[SIM_TRACE_MAX];      //**< Chuỗi trạng thái, mỗi lần đổi 1 ký tự     >**/
+    uint8_t  finalState;                //**< Trạng thái cuối                           >**/
+    uint8_t  finalStep;                 //**< Số giao lộ đã xử lý                       >**/
+    uint8_t  reverses;                  //**< Số lần báo đổi chiều đi                   >**/
+    int8_t   turnSign[8];               //**< Chiều quay của từng lần quay              >**/
+    uint32_t turnMs[8];                 //**< Thời gian của từng lần quay (ms)          >**/
+    uint8_t  turns;                     //**< Số lần quay                               >**/
+    uint8_t  badCommand;                //**< Lệnh không hợp với trạng thái             >**/
+} Sim_Result;
+
+/**
+ * @brief   1 trường hợp kiểm tra
+ **/
+typedef struct {
+    const char         *title;          //**< Tên trường hợp                            >**/
+    const char         *steps;          //**< Chuỗi hành động                           >**/
+    const Sim_Junction *map;            //**< Bản đồ                                    >**/
+    uint8_t             junctions;      //**< Số giao lộ của bản đồ                     >**/
+    const char         *trace;          //**< Chuỗi trạng thái mong đợi                 >**/
+    uint8_t             step;           //**< Số giao lộ đã xử lý mong đợi              >**/
+    uint8_t             reverses;       //**< Số lần đổi chiều mong đợi                 >**/
+} Sim_Case;
+
+static const char stateText[] = "-FATDE";   //**< IDLE, FOLLOW, ADVANCE, TURN, DONE, FAILED >**/
+
+/* Bản đồ: các ngã tư đủ nhánh, nhánh trái / phải bắt được sau 450 ms */
+static const Sim_Junction mapCross[] = {
+    { ARMS_ALL, 450 }, { ARMS_ALL, 0 }, { ARMS_ALL, 450 }, { ARMS_ALL, 0 }
+};
+/* Nhánh trái nằm ngay cạnh line cũ: cảm biến giữa thấy line trước ROUTE_TURN_MIN_MS */
+static const Sim_Junction mapTight[] = {
+    { ARMS_ALL, 120 }, { ARMS_ALL, 0 }
+};
+/* Quay đầu: line cũ phía sau bắt được sau 900 ms */
+static const Sim_Junction mapUTurn[] = {
+    { ARMS_ALL, 0 }, { ARMS_ALL, 900 }, { ARMS_ALL, 0 }
+};
+/* Ngã ba chữ T chỉ có nhánh trái và đi thẳng */
+static const Sim_Junction mapNoRight[] = {
+    { ROUTE_ARM_LEFT | ROUTE_ARM_STRAIGHT, 450 }, { ARMS_ALL, 0 }
+};
+/* Nhánh rẽ bị mất line: quay mãi không bắt được */
+static const Sim_Junction mapLostBranch[] = {
+    { ARMS_ALL, 0 }, { ARMS_ALL, 0 }
+};
+
+static const Sim_Case cases[] = {
+    { "left, straight, right, stop",    "LSRX", mapCross,      4, "FATFATFAD", 4, 0 },
+    { "end of route without X",         "SS",   mapCross,      4, "F-",        2, 0 },
+    { "turn waits ROUTE_TURN_MIN_MS",   "LX",   mapTight,      2, "FATFAD",    2, 0 },
+    { "u-turn",                         "SUX",  mapUTurn,      3, "FATFAD",    3, 0 },
+    { "reverse in place",               "SBX",  mapCross,      3, "FAD",       3, 1 },
+    { "FAILED: missing right arm",      "RX",   mapNoRight,    2, "FE",        1, 0 },
+    { "FAILED: turn timeout",           "SL",   mapLostBranch, 2, "FATE",      2, 0 },
+    { "FAILED: unknown action",         "SQX",  mapCross,      3, "FE",        2, 0 },
+    { "map shorter than route",         "SSSSS", mapCross,     4, "F",         4, 0 }
+};
+
+/* ========================================[ FUNCTION INPLEMENTATION ]======================================*/
+/**
+ * @brief   Hàm chạy 1 lộ trình trên bản đồ mô phỏng
+ * @param   testCase    Trường hợp kiểm tra
+ * @param   result      Nơi lưu kết quả
+ * @return  void
+ **/
+static void simRun(const Sim_Case *testCase, Sim_Result *result)
+{
+    Route_Program program = { testCase->title, testCase->steps };
+    Route_Progress progress;
+    Route_Command command;
+    uint8_t  junction = 0, lastState = 0xFF, len = 0;
+    uint32_t segmentStartMs = 0, turnStartMs = 0;
+    uint8_t  turning = 0;
+
+    memset(result, 0, sizeof(*result));
+    Route_Start(&program);
+    for (uint32_t nowMs = 0; nowMs < SIM_LIMIT_MS; nowMs += SIM_PERIOD_MS) {
+        uint8_t onLine = ROUTE_MASK_MIDDLE;                     //**< Dò line: cảm biến giữa trên line >**/
+        uint8_t driving;
+
+        Route_GetProgress(&progress);
+        if (progress.state == ROUTE_FOLLOW && junction < testCase->junctions &&
+            nowMs - segmentStartMs >= SIM_SEGMENT_MS) {
+            Route_OnJunction(testCase->map[junction].arms, nowMs);
+            junction++;
+            segmentStartMs = nowMs;
+        }
+
+        if (turning) {
+            uint32_t t = nowMs - turnStartMs;
+            uint16_t catchMs = testCase->map[junction - 1].catchMs;
+            onLine = (t < SIM_LEAVE_MS || (catchMs != 0 && t >= catchMs)) ? ROUTE_MASK_MIDDLE : 0;
+        }
+
+        driving = Route_Update(onLine, nowMs, &command);
+        Route_GetProgress(&progress);
+        result->reverses += command.reverse;
+
+        if (progress.state != lastState && len < SIM_TRACE_MAX - 1) {
+            result->trace[len++] = stateText[progress.state];
+            if (turning && progress.state != ROUTE_TURN && result->turns < 8)
+                result->turnMs[result->turns++] = nowMs - turnStartMs;
+            turning = (progress.state == ROUTE_TURN);
+            if (turning) {
+                turnStartMs = nowMs;
+                if (result->turns < 8)
+                    result->turnSign[result->turns] = (command.omega > 0) ? 1 : -1;
+            }
+            if (progress.state == ROUTE_FOLLOW)
+                segmentStartMs = nowMs;
+            lastState = progress.state;
+        }
+
+        switch (progress.state) {                               //**< Lệnh phải hợp với trạng thái >**/
+        case ROUTE_ADVANCE:
+            if (!driving || command.vy <= 0 || command.omega != 0)
+                result->badCommand = 1;
+            break;
+        case ROUTE_TURN:
+            if (!driving || command.omega == 0 || command.vy != 0)
+                result->badCommand = 1;
+            break;
+        case ROUTE_DONE:
+        case ROUTE_FAILED:
+            if (!driving || command.vx || command.vy || command.omega)
+                result->badCommand = 1;
+            break;
+        default:
+            if (driving)
+                result->badCommand = 1;
+            break;
+        }
+
+        if (progress.state == ROUTE_DONE || progress.state == ROUTE_FAILED || progress.state == ROUTE_IDLE)
+            break;
+        if (progress.state == ROUTE_FOLLOW && junction >= testCase->junctions &&
+            nowMs - segmentStartMs >= SIM_SEGMENT_MS)
+            break;                                              //**< Hết bản đồ mà lộ trình chưa xong >**/
+    }
+    Route_GetProgress(&progress);
+    result->trace[len]  = '\0';
+    result->finalState  = progress.state;
+    result->finalStep   = progress.step;
+}
+
+
+/**
+ * @brief   Hàm kiểm tra thêm thời gian và chiều quay của các trường hợp có quay
+ * @param   testCase    Trường hợp kiểm tra
+ * @param   result      Kết quả
+ * @return  int     Số lỗi
+ **/
+static int simCheckTurns(const Sim_Case *testCase, const Sim_Result *result)
+{
+    int failures = 0;
+    uint8_t turn = 0;
+
+    for (const char *step = testCase->steps; *step != '\0' && turn < result->turns; step++) {
+        int8_t   sign  = 0;
+        uint32_t minMs = 0;
+
+        if (*step == 'L')      { sign =  1; minMs = ROUTE_TURN_MIN_MS; }
+        else if (*step == 'R') { sign = -1; minMs = ROUTE_TURN_MIN_MS; }
+        else if (*step == 'U') { sign =  1; minMs = ROUTE_UTURN_MIN_MS; }
+        else continue;
+
+        if (result->turnSign[turn] != sign) {
+            printf("    turn %u: sign %d, expected %d\n", turn, result->turnSign[turn], sign);
+            failures++;
+        }
+        if (result->turnMs[turn] < minMs) {
+            printf("    turn %u: %lu ms, shorter than %lu ms\n", turn,
+                   (unsigned long)result->turnMs[turn], (unsigned long)minMs);
+            failures++;
+        }
+        turn++;
+    }
+    return failures;
+}
+
+
+int main(void)
+{
+    int failed = 0;
+
+    for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const Sim_Case *testCase = &cases[i];
+        Sim_Result result;
+        int failures;
+
+        simRun(testCase, &result);
+        failures = simCheckTurns(testCase, &result);
+        if (strcmp(result.trace, testCase->trace) != 0) {
+            printf("    trace %s, expected %s\n", result.trace, testCase->trace);
+            failures++;
+        }
+        if (result.finalStep != testCase->step) {
+            printf("    step %u, expected %u\n", result.finalStep, testCase->step);
+            failures++;
+        }
+        if (result.reverses != testCase->reverses) {
+            printf("    reverses %u, expected %u\n", result.reverses, testCase->reverses);
+            failures++;
+        }
+        if (result.badCommand) {
+            printf("    command does not match state\n");
+            failures++;
+        }
+        printf("%s  %-32s %-10s step %u/%u\n", failures ? "FAIL" : "ok  ", testCase->title,
+               result.trace, result.finalStep, (unsigned)strlen(testCase->steps));
+        failed += (failures != 0);
+    }
+    printf("%d failed\n", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,81 @@
+/*********************************************************************************************************************
+ * @file    main.h
+ * @brief   Bản thay thế main.h (CubeMX) khi biên dịch kiểm tra trên máy tính
+ * @details Chỉ khai báo các kiểu, hằng số và hàm HAL mà thư viện cần để biên dịch với HOST_SIM.
+ *          Các hàm HAL được chương trình kiểm tra tự định nghĩa để mô phỏng phần cứng.
+ * @version 1.0
+ * @date    2026-10-19
+ * @author  LongTruong
+ *********************************************************************************************************************/
+/* =====================================================[ Guard ]====================================================*/
+#ifndef __MAIN_H
+#define __MAIN_H
+
+/* ============================================[ INCLUDE FILE ]============================================*/
+#include <stdint.h>                     //**< Thư viện sử dụng kiểu dữ liệu uint >**/
+#include <stddef.h>                     //**< Thư viện sử dụng NULL >**/
+
+/* =============================================[ TYPE DEFINITIONS ]==========================================*/
+typedef enum { HAL_OK = 0, HAL_ERROR = 1, HAL_BUSY = 2, HAL_TIMEOUT = 3 } HAL_StatusTypeDef;
+
+/* GPIO */
+typedef struct { volatile uint32_t IDR; volatile uint32_t ODR; } GPIO_TypeDef;
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+typedef struct { uint32_t Pin; uint32_t Mode; uint32_t Pull; uint32_t Speed; } GPIO_InitTypeDef;
+
+extern GPIO_TypeDef hostGpioB, hostGpioC, hostGpioE;    //**< Port giả lập, định nghĩa trong chương trình kiểm tra >**/
+
+/* I2C */
+typedef struct { volatile uint32_t CR1; } I2C_TypeDef;
+typedef enum { HAL_I2C_STATE_READY = 0x20, HAL_I2C_STATE_BUSY_TX = 0x21 } HAL_I2C_StateTypeDef;
+typedef struct { I2C_TypeDef *Instance; void *hdmatx; void *hdmarx; } I2C_HandleTypeDef;
+
+/* ============================================[ MACRO DEFINITIONS ]==========================================*/
+#define GPIOB                   (&hostGpioB)
+#define GPIOC                   (&hostGpioC)
+#define GPIOE                   (&hostGpioE)
+
+#define GPIO_PIN_0              ((uint16_t)0x0001)
+#define GPIO_PIN_1              ((uint16_t)0x0002)
+#define GPIO_PIN_2              ((uint16_t)0x0004)
+#define GPIO_PIN_3              ((uint16_t)0x0008)
+#define GPIO_PIN_4              ((uint16_t)0x0010)
+#define GPIO_PIN_5              ((uint16_t)0x0020)
+#define GPIO_PIN_6              ((uint16_t)0x0040)
+#define GPIO_PIN_7              ((uint16_t)0x0080)
+#define GPIO_PIN_8              ((uint16_t)0x0100)
+#define GPIO_PIN_9              ((uint16_t)0x0200)
+#define GPIO_PIN_10             ((uint16_t)0x0400)
+#define GPIO_PIN_11             ((uint16_t)0x0800)
+#define GPIO_PIN_12             ((uint16_t)0x1000)
+#define GPIO_PIN_13             ((uint16_t)0x2000)
+#define GPIO_PIN_14             ((uint16_t)0x4000)
+#define GPIO_PIN_15             ((uint16_t)0x8000)
+
+#define GPIO_MODE_INPUT         0x00000000U
+#define GPIO_MODE_OUTPUT_OD     0x00000011U
+#define GPIO_NOPULL             0x00000000U
+#define GPIO_SPEED_FREQ_HIGH    0x00000002U
+
+#define I2C_CR1_SWRST           (1U << 15)
+#define HAL_I2C_ERROR_NONE      0x00000000U
+#define HAL_I2C_ERROR_BERR      0x00000001U
+#define HAL_I2C_ERROR_ARLO      0x00000002U
+#define HAL_I2C_ERROR_AF        0x00000004U
+#define HAL_I2C_ERROR_OVR       0x00000008U
+#define HAL_I2C_ERROR_TIMEOUT   0x00000020U
+
+/* ============================================[ FUNCTION PROTOTYPES ]========================================*/
+void          HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init);
+void          HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin);
+
+HAL_StatusTypeDef    HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef    HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef    HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t address, uint8_t *data, uint16_t size);
+HAL_StatusTypeDef    HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef *hi2c, uint16_t address);
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef *hi2c);
+uint32_t             HAL_I2C_GetError(I2C_HandleTypeDef *hi2c);
+
+/* =====================================================[ Guard ]====================================================*/
+#endif